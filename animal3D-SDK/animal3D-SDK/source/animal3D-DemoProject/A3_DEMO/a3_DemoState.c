@@ -78,6 +78,35 @@ inline void a3demo_applyScale_internal(a3_DemoSceneObject *sceneObject, a3real4x
 	}
 }
 
+// test whether a sphere may be in a camera's view (radius 0 for 
+//	something never out of view)
+//	- conservative: the side plane (x - w = 0) has a view-space normal 
+//		of length sqrt(P00^2 + 1), so the center's clip-space distance 
+//		to it is compared against the radius scaled by that length; 
+//		likewise sqrt(P11^2 + 1) for the top and bottom planes
+inline int a3demo_isVisible_internal(const a3_DemoCamera *camera, const a3real3p center, const a3real radius)
+{
+	a3vec4 clip;
+	a3real rx, ry;
+	if (radius <= a3realZero)
+		return 1;
+	a3real4Set(clip.v, center[0], center[1], center[2], a3realOne);
+	a3real4Real4x4MulR(camera->viewProjectionMat.m, clip.v);
+	rx = radius * a3sqrtf(camera->projectionMat.m00 * camera->projectionMat.m00 + a3realOne);
+	ry = radius * a3sqrtf(camera->projectionMat.m11 * camera->projectionMat.m11 + a3realOne);
+	return clip.w > -radius &&
+		clip.x <= clip.w + rx && -clip.x <= clip.w + rx &&
+		clip.y <= clip.w + ry && -clip.y <= clip.w + ry;
+}
+
+// job: update scene objects [begin, end)
+void a3demo_updateSceneObjects_internal(a3_DemoSceneObject *sceneObject, const unsigned int begin, const unsigned int end)
+{
+	unsigned int i;
+	for (i = begin; i < end; ++i)
+		a3demo_updateSceneObject(sceneObject + i);
+}
+
 
 //-----------------------------------------------------------------------------
 // SETUP AND TERMINATION UTILITIES
@@ -643,6 +672,16 @@ void a3demo_initScene(a3_DemoState *demoState)
 	demoState->displaySkybox = 0;
 	demoState->displayPhysicsText = 0;
 
+	// optional physics modes
+	demoState->enableParticles = 0;
+	demoState->enableFluid = 0;
+	demoState->enableCloth = 0;
+	demoState->enablePositionBased = 0;
+	demoState->enableOrbits = 0;
+	demoState->enableAdaptive = 0;
+	demoState->enablePipelined = 0;
+	demoState->enableSnapshots = 0;
+
 
 	// demo modes
 	demoState->demoMode = 0;
@@ -664,6 +703,13 @@ void a3demo_initScene(a3_DemoState *demoState)
 	demoState->rbDrawable[9] = demoState->draw_sphere;
 	demoState->rbDrawable[10] = demoState->draw_sphere;
 
+	demoState->rbDrawable[11] = demoState->draw_sphere;
+	demoState->rbDrawable[12] = demoState->draw_sphere;
+	demoState->rbDrawable[13] = demoState->draw_sphere;
+	demoState->rbDrawable[14] = demoState->draw_sphere;
+	demoState->rbDrawable[15] = demoState->draw_sphere;
+	demoState->rbDrawable[16] = demoState->draw_sphere;
+
 
 	// reset
 	demoState->hitIndex = -1;
@@ -824,9 +870,9 @@ void a3demo_update(a3_DemoState *demoState, double dt)
 	//a3_ConvexHullCollision testCollision[1];
 
 
-	// update scene objects
-	for (i = 0; i < graphicsObjectCount; ++i)
-		a3demo_updateSceneObject(demoState->graphicsObjects + i);
+	// update scene objects (spread over the job system once there 
+	//	are enough of them to be worth it)
+	a3jobParallelFor(demoState->jobSystem, (a3_JobFunc)a3demo_updateSceneObjects_internal, demoState->graphicsObjects, graphicsObjectCount, 64);
 
 	// update cameras
 	for (i = 0; i < demoStateMaxCount_camera; ++i)
@@ -837,38 +883,74 @@ void a3demo_update(a3_DemoState *demoState, double dt)
 	// lock world
 	if (a3physicsLockWorld(demoState->physicsWorld) > 0)
 	{
-		// copy state
-		const a3_PhysicsWorldState worldState[1] = { *(demoState->physicsWorld->state) };
+		// bring the copies of the last two published states up to date
+		const a3_PhysicsWorldState *const worldState0 = demoState->physicsState + 0;
+		const a3_PhysicsWorldState *const worldState1 = demoState->physicsState + 1;
+		a3_PhysicsWorldState worldState[1];
+		const a3real *particlePosition = demoState->physicsWorld->particlePosition;
+		const unsigned int particleStride = demoState->physicsWorld->particlePool->capacity;
+
+		a3physicsWorldStateSync(demoState->physicsState + 0, demoState->physicsWorld->statePrev);
+		a3physicsWorldStateSync(demoState->physicsState + 1, demoState->physicsWorld->state);
+
+		// bodies far from the camera step less often
+		demoState->physicsWorld->observer = demoState->cameraObject->modelMat.v3.xyz;
+
+		// ditto: particles are published in bulk, so only copy the 
+		//	ones there are objects for while the buffer is stable
+		for (i = 0; i < worldState1->count_p && i < particleObjectCount; ++i)
+		{
+			//	- convert particle state to graphics object state
+			//	- apply graphics scale later (see below)
+
+			demoState->physicsParticles[i].modelMat = a3identityMat4;
+			a3real3Set(demoState->physicsParticles[i].modelMat.v3.v, particlePosition[i], particlePosition[i + particleStride], particlePosition[i + particleStride * 2]);
+		}
+		demoState->particleObjects = i;
 
 		// unlock
 		a3physicsUnlockWorld(demoState->physicsWorld);
 
-
-		// copy from physics world to demo state here
-		for (i = 0; i < worldState->count_rb; ++i)
+		// physics steps at a fixed rate unrelated to rendering, so 
+		//	draw on a clock that runs one step behind the newest state, 
+		//	blended from the two around it; the clock advances with 
+		//	frame time and is eased back toward that target, or reset 
+		//	onto it if it falls more than a step away
 		{
-			//	- convert rigid body state to graphics object state
-			//	- apply graphics scale later (see below)
-
-			demoState->physicsRigidbodies[i].modelMat = worldState->transform_rb[i];
+			const double step = worldState1->t - worldState0->t;
+			const double target = worldState1->t - step;
+			demoState->physicsTime += dt;
+			if (demoState->physicsTime < target - step || demoState->physicsTime > worldState1->t)
+				demoState->physicsTime = target;
+			else
+				demoState->physicsTime += (target - demoState->physicsTime) * 0.125;
 		}
-		demoState->rigidbodyObjects = a3minimum(i, rigidBodyObjectCount);
+		a3physicsWorldStateInterpolate(worldState, worldState0, worldState1, demoState->physicsTime);
+
+
+		// expand transforms in bulk, only for bodies in view
+		demoState->rigidbodyObjects = a3minimum(worldState->count_rb, rigidBodyObjectCount);
+		demoState->rigidbodyVisible = 0;
+		for (i = 0; i < demoState->rigidbodyObjects; ++i)
+			if (a3demo_isVisible_internal(demoState->camera, worldState->pose_rb[i].position.v, demoState->rbRadius[i]))
+				demoState->rigidbodyVisible |= 1u << i;
+		a3physicsWorldStateExpand(demoState->physicsTransforms, worldState, demoState->rigidbodyVisible);
 
-		// ditto
-		for (i = 0; i < worldState->count_p; ++i)
+		// copy from physics world to demo state here
+		for (i = 0; i < demoState->rigidbodyObjects; ++i)
 		{
-			//	- convert particle state to graphics object state
+			//	- convert rigid body state to graphics object state
 			//	- apply graphics scale later (see below)
 
-			demoState->physicsParticles[i].modelMat = a3identityMat4;
-			demoState->physicsParticles[i].modelMat.v3 = worldState->position_p[i];
+			if (demoState->rigidbodyVisible >> i & 1u)
+				demoState->physicsRigidbodies[i].modelMat = demoState->physicsTransforms->transform_rb[i];
 		}
-		demoState->particleObjects = a3minimum(i, particleObjectCount);
 	}
 
 	// apply scales
 	for (i = 0, tmpObject = demoState->physicsRigidbodies + i; i < demoState->rigidbodyObjects; ++i, ++tmpObject)
-		a3demo_applyScale_internal(demoState->physicsRigidbodies + i, tmpScale.m, 1);
+		if (demoState->rigidbodyVisible >> i & 1u)
+			a3demo_applyScale_internal(demoState->physicsRigidbodies + i, tmpScale.m, 1);
 	//for (i = 0, tmpObject = demoState->physicsParticles + i; i < demoState->particleObjects; ++i, ++tmpObject)
 	//	a3demo_applyScale_internal(demoState->physicsParticles + i, tmpScale.m, 1);
 }
@@ -1017,6 +1099,8 @@ void a3demo_render(const a3_DemoState *demoState)
 	// rigid body shapes
 	for (i = 0; i < demoState->rigidbodyObjects; ++i)
 	{
+		if (!(demoState->rigidbodyVisible >> i & 1u))
+			continue;
 		currentSceneObject = demoState->physicsRigidbodies + i;
 		modelMat = currentSceneObject->modelMat;
 		currentDrawable = demoState->rbDrawable[i];
@@ -1155,6 +1239,9 @@ void a3demo_render(const a3_DemoState *demoState)
 		glDisable(GL_DEPTH_TEST);
 		for (i = 0; i < demoState->rigidbodyObjects; ++i)
 		{
+			if (!(demoState->rigidbodyVisible >> i & 1u))
+				continue;
+
 			// transform world position to clip space
 			pos_model = demoState->physicsRigidbodies[i].modelMat.v3;
 			a3real4Real4x4Product(pos_ndc.v, demoState->camera->viewProjectionMat.m, pos_model.v);
@@ -1191,6 +1278,7 @@ void a3demo_render(const a3_DemoState *demoState)
 		};
 
 		const float col[3] = { 0.1f, 0.3f, 0.5f };
+		const char *onOff[] = { "(off)", "(ON) " };
 
 		glDisable(GL_DEPTH_TEST);
 
@@ -1209,6 +1297,16 @@ void a3demo_render(const a3_DemoState *demoState)
 		a3textDraw(demoState->text, -0.98f, +0.50f, -1.0f, col[0], col[1], col[2], 1.0f,
 			"Toggle CAPTIONS: 'c' | Toggle SKYBOX:   'b'");
 
+		// optional physics modes (each reloads physics)
+		a3textDraw(demoState->text, -0.98f, +0.40f, -1.0f, col[0], col[1], col[2], 1.0f,
+			"PARTICLES: '1' %s | FLUID:     '2' %s", onOff[demoState->enableParticles], onOff[demoState->enableFluid]);
+		a3textDraw(demoState->text, -0.98f, +0.30f, -1.0f, col[0], col[1], col[2], 1.0f,
+			"CLOTH:     '3' %s | XPBD:      '4' %s", onOff[demoState->enableCloth], onOff[demoState->enablePositionBased]);
+		a3textDraw(demoState->text, -0.98f, +0.20f, -1.0f, col[0], col[1], col[2], 1.0f,
+			"ORBITS:    '5' %s | ADAPTIVE:  '6' %s", onOff[demoState->enableOrbits], onOff[demoState->enableAdaptive]);
+		a3textDraw(demoState->text, -0.98f, +0.10f, -1.0f, col[0], col[1], col[2], 1.0f,
+			"PIPELINED: '7' %s | SNAPSHOTS: '8' %s", onOff[demoState->enablePipelined], onOff[demoState->enableSnapshots]);
+
 
 		// display controls
 		if (a3XboxControlIsConnected(demoState->xcontrol))
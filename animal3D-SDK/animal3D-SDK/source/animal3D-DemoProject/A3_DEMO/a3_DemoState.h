@@ -62,6 +62,7 @@ project on its database.
 // physics includes
 
 #include "physics/a3_PhysicsWorld.h"
+#include "physics/a3_PhysicsSnapshot.h"
 
 
 //-----------------------------------------------------------------------------
@@ -139,8 +140,22 @@ extern "C"
 		unsigned int demoMode, demoModeCount;
 
 
-		// physics world embedded in demo
+		// physics world embedded in demo, and the ring it shares 
+		//	snapshots with other processes through
 		a3_PhysicsWorld physicsWorld[1];
+		a3_PhysicsSnapshotRing physicsSnapshot[1];
+
+		// simulation time being drawn (between the last two states), 
+		//	and copies of the last two states kept up to date with 
+		//	only what changed in them
+		double physicsTime;
+		a3_PhysicsWorldState physicsState[2];
+
+		// transforms expanded from the drawn state, only for bodies 
+		//	in view (bit i of rigidbodyVisible for body i; the 
+		//	physics state header checks every body has a bit)
+		a3_PhysicsWorldTransforms physicsTransforms[1];
+		unsigned int rigidbodyVisible;
 
 		// object counts
 		unsigned int rigidbodyObjects, particleObjects;
@@ -150,6 +165,17 @@ extern "C"
 		int displayGrid, displayAxes, displaySkybox;
 		int displayPhysicsText;
 
+		// optional physics modes, off until toggled so each can be 
+		//	compared on its own (toggling one restarts the thread)
+		int enableParticles;
+		int enableFluid;
+		int enableCloth;
+		int enablePositionBased;
+		int enableOrbits;
+		int enableAdaptive;
+		int enablePipelined;
+		int enableSnapshots;
+
 
 		// ray and prevailing hit
 		a3_Ray ray[1];
@@ -163,8 +189,10 @@ extern "C"
 		// dummy drawable for rays
 		a3_VertexDrawable dummyDrawable[1];
 
-		// pointer to drawable attached to each physics object
+		// pointer to drawable attached to each physics object, and 
+		//	the radius bounding it (0 if it is never out of view)
 		const a3_VertexDrawable *rbDrawable[physicsMaxCount_rigidbody];
+		a3real rbRadius[physicsMaxCount_rigidbody];
 
 
 		//---------------------------------------------------------------------
@@ -193,6 +221,7 @@ extern "C"
 				// rigid body objects
 				a3_DemoSceneObject groundObject[6];
 				a3_DemoSceneObject sphereObject[5];
+				a3_DemoSceneObject linkObject[6];
 
 				// no named particles here
 			};
@@ -225,6 +254,9 @@ extern "C"
 			};
 		};
 
+		// worker pool for work off the render thread, shared with physics
+		a3_JobSystem jobSystem[1];
+
 
 		// textures
 		union {
@@ -70,6 +70,46 @@ inline void a3demo_initializePhysicsThread(a3_DemoState *demoState)
 	demoState->physicsWorld->lock = 0;
 	demoState->physicsWorld->init = 0;
 	demoState->physicsWorld->rate = 100.0;
+	demoState->physicsWorld->substeps = 1;
+	demoState->physicsWorld->sleepTime = 0.5f;
+	demoState->physicsWorld->sleepSpeed = 0.05f;
+	demoState->physicsWorld->sleepAngularSpeed = 0.05f;
+	demoState->physicsWorld->speculativeMargin = 0.5f;
+	demoState->physicsWorld->adaptive = demoState->enableAdaptive;
+	demoState->physicsWorld->stepTolerance = 0.001f;
+	demoState->physicsWorld->stepMin = 0.25 / demoState->physicsWorld->rate;
+	demoState->physicsWorld->stepMax = 4.0 / demoState->physicsWorld->rate;
+	demoState->physicsWorld->tierDistance[0] = 40.0f;
+	demoState->physicsWorld->tierDistance[1] = 60.0f;
+	demoState->physicsWorld->particleCapacity = demoState->enableParticles ? 1u << 20 : 0;
+	demoState->physicsWorld->particleRestitution = 0.5f;
+	demoState->physicsWorld->windSize = 16;
+	demoState->physicsWorld->particleDrag = 0.5f;
+	demoState->physicsWorld->fluidCapacity = demoState->enableFluid ? 100000 : 0;
+	demoState->physicsWorld->clothSize = demoState->enableCloth ? 32 : 0;
+	demoState->physicsWorld->clothIntegrator = a3clothIntegrator_implicit;
+	demoState->physicsWorld->positionBasedCapacity = demoState->enablePositionBased ? 2048 : 0;
+	demoState->physicsWorld->orbitCapacity = demoState->enableOrbits ? 16384 : 0;
+	demoState->physicsWorld->pipelined = demoState->enablePipelined;
+	demoState->physicsWorld->keyframeInterval = 100;
+	demoState->physicsWorld->compactPose = 1;
+
+	// a new run numbers its publications from 1 again, so forget
+	//	the transforms and state copies taken from the last one
+	//	(a matching version would otherwise keep a stale matrix)
+	memset(demoState->physicsTransforms, 0, sizeof(demoState->physicsTransforms));
+	memset(demoState->physicsState, 0, sizeof(demoState->physicsState));
+
+	// one worker per spare core, shared by physics and the demo
+	a3jobSystemCreate(demoState->jobSystem, a3jobCoreCount() - 1);
+	demoState->physicsWorld->jobs = demoState->jobSystem;
+
+	// snapshots for tools running alongside, if enabled (none if 
+	//	shared memory is unavailable)
+	demoState->physicsWorld->snapshot = 0;
+	if (demoState->enableSnapshots && a3physicsSnapshotCreate(demoState->physicsSnapshot, "/animal3D-physics", 64) > 0)
+		demoState->physicsWorld->snapshot = demoState->physicsSnapshot;
+
 	a3threadLaunch(demoState->physicsThread, (a3_threadfunc)a3physicsThread, demoState->physicsWorld, "a3physicsThread");
 
 	// wait for thread to initialize
@@ -94,6 +134,18 @@ inline void a3demo_initializePhysicsThread(a3_DemoState *demoState)
 		tmp0 = demoState->physicsWorld->hull_sphere[i].prop[a3hullProperty_radius];
 		a3real3Set(demoState->sphereObject[i].scale.v, tmp0, tmp0, tmp0);
 		demoState->sphereObject[i].scaleMode = +1;
+
+		// bounds for culling (planes are never culled)
+		demoState->rbRadius[6 + i] = tmp0;
+	}
+
+	// ditto for the chain's links
+	for (i = 0; i < 6; ++i)
+	{
+		tmp0 = demoState->physicsWorld->hull_link[i].prop[a3hullProperty_radius];
+		a3real3Set(demoState->linkObject[i].scale.v, tmp0, tmp0, tmp0);
+		demoState->linkObject[i].scaleMode = +1;
+		demoState->rbRadius[11 + i] = tmp0;
 	}
 }
 
@@ -101,12 +153,22 @@ inline void a3demo_terminatePhysicsThread(a3_DemoState *demoState)
 {
 	demoState->physicsWorld->lock = -1;
 	a3threadWait(demoState->physicsThread);
+	a3physicsSnapshotRelease(demoState->physicsSnapshot);
+	a3jobSystemRelease(demoState->jobSystem);
 }
 
 
 //-----------------------------------------------------------------------------
 // event handling
 
+// toggle an optional physics mode, restarting the thread with it
+inline void a3demo_togglePhysicsMode_internal(a3_DemoState *demoState, int *mode)
+{
+	*mode = 1 - *mode;
+	a3demo_terminatePhysicsThread(demoState);
+	a3demo_initializePhysicsThread(demoState);
+}
+
 // raypick test
 inline void a3demo_raypickTest_internal(a3_DemoState *demoState)
 {
@@ -521,6 +583,33 @@ A3API void a3test_keyCharPress(a3_DemoState *demoState, int asciiKey)
 	case 'c':
 		demoState->displayPhysicsText = 1 - demoState->displayPhysicsText;
 		break;
+
+
+		// optional physics modes
+	case '1':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enableParticles);
+		break;
+	case '2':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enableFluid);
+		break;
+	case '3':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enableCloth);
+		break;
+	case '4':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enablePositionBased);
+		break;
+	case '5':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enableOrbits);
+		break;
+	case '6':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enableAdaptive);
+		break;
+	case '7':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enablePipelined);
+		break;
+	case '8':
+		a3demo_togglePhysicsMode_internal(demoState, &demoState->enableSnapshots);
+		break;
 	}
 }
 
@@ -0,0 +1,483 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_BarnesHut.c/.cpp
+	Implementation of Barnes-Hut octree.
+*/
+
+#include "a3_BarnesHut.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// the force walk uses sqrtf: a3sqrt is an out-of-line double call, 
+//	which keeps the pair loops from vectorizing
+#include <math.h>
+
+
+//-----------------------------------------------------------------------------
+
+// passes split into jobs
+enum a3_BarnesHutPass
+{
+	a3barnesHutPass_key,		// points: Morton keys
+	a3barnesHutPass_gather,		// sorted points: copy positions and masses
+	a3barnesHutPass_count,		// subtrees: count nodes
+	a3barnesHutPass_fill,		// subtrees: write nodes
+	a3barnesHutPass_force,		// groups: walk the tree
+};
+
+
+// internal helper: spread the low 10 bits of a value to every third bit
+inline unsigned int a3barnesHutSpread_internal(unsigned int v)
+{
+	v &= 0x000003ff;
+	v = (v | v << 16) & 0x030000ff;
+	v = (v | v << 8) & 0x0300f00f;
+	v = (v | v << 4) & 0x030c30c3;
+	v = (v | v << 2) & 0x09249249;
+	return v;
+}
+
+// internal helper: octant of a key at a level (0 splits the root)
+inline unsigned int a3barnesHutOctant_internal(const unsigned int key, const unsigned int level)
+{
+	return (key >> (3 * (a3barnesHutMaxCount_level - 1 - level))) & 7u;
+}
+
+// internal helper: end of the run of keys sharing an octant at a level
+inline unsigned int a3barnesHutRun_internal(const unsigned int *key, const unsigned int begin, const unsigned int end, const unsigned int level)
+{
+	const unsigned int octant = a3barnesHutOctant_internal(key[begin], level);
+	unsigned int i;
+	for (i = begin + 1; i < end && a3barnesHutOctant_internal(key[i], level) == octant; ++i);
+	return i;
+}
+
+// internal helper: edge length of a cell at a depth
+inline a3real a3barnesHutSize_internal(const a3_BarnesHutTree *tree, const unsigned int depth)
+{
+	return tree->boundsSize / (a3real)(1u << depth);
+}
+
+
+//-----------------------------------------------------------------------------
+
+// internal recursive count of the nodes over sorted points [begin, end) 
+//	at a depth (the same splits fill makes)
+unsigned int a3barnesHutCount_internal(const a3_BarnesHutTree *tree, const unsigned int begin, const unsigned int end, const unsigned int depth)
+{
+	unsigned int count = 1, i, j;
+	if (end - begin > a3barnesHutMaxCount_leaf && depth < a3barnesHutMaxCount_level)
+		for (i = begin; i < end; i = j)
+		{
+			j = a3barnesHutRun_internal(tree->key, i, end, depth);
+			count += a3barnesHutCount_internal(tree, i, j, depth + 1);
+		}
+	return count;
+}
+
+// internal recursive fill of the nodes over sorted points [begin, end) 
+//	at a depth, starting at node 'at'; returns the node after them
+unsigned int a3barnesHutFill_internal(a3_BarnesHutTree *tree, const unsigned int begin, const unsigned int end, const unsigned int depth, const unsigned int at)
+{
+	a3_BarnesHutNode *const node = tree->node + at;
+	const a3_BarnesHutNode *child;
+	unsigned int next = at + 1, i, j, c;
+
+	node->begin = begin;
+	node->end = end;
+	node->size = a3barnesHutSize_internal(tree, depth);
+	node->mass = node->centerMass[0] = node->centerMass[1] = node->centerMass[2] = a3realZero;
+
+	if (end - begin > a3barnesHutMaxCount_leaf && depth < a3barnesHutMaxCount_level)
+	{
+		for (i = begin; i < end; i = j)
+		{
+			j = a3barnesHutRun_internal(tree->key, i, end, depth);
+			child = tree->node + next;
+			next = a3barnesHutFill_internal(tree, i, j, depth + 1, next);
+			for (c = 0; c < 3; ++c)
+				node->centerMass[c] += child->centerMass[c] * child->mass;
+			node->mass += child->mass;
+		}
+	}
+	else
+	{
+		for (i = begin; i < end; ++i)
+		{
+			for (c = 0; c < 3; ++c)
+				node->centerMass[c] += tree->sorted[c][i] * tree->sorted[3][i];
+			node->mass += tree->sorted[3][i];
+		}
+	}
+
+	// massless nodes sit at their first point
+	if (node->mass > a3realZero)
+		for (c = 0; c < 3; ++c)
+			node->centerMass[c] /= node->mass;
+	else
+		for (c = 0; c < 3; ++c)
+			node->centerMass[c] = tree->sorted[c][begin];
+	node->next = next;
+	return next;
+}
+
+// internal recursive layout of the nodes above the split level, 
+//	placing each subtree (in sorted order) by its node count; returns 
+//	the node after them
+unsigned int a3barnesHutLayout_internal(a3_BarnesHutTree *tree, const unsigned int begin, const unsigned int end, const unsigned int depth, const unsigned int at, unsigned int *subtree_inout)
+{
+	a3_BarnesHutNode *node;
+	unsigned int next, i, j;
+	if (depth == a3barnesHutSplitLevel)
+	{
+		tree->subtreeNode[*subtree_inout] = at;
+		return at + tree->subtreeCount[(*subtree_inout)++];
+	}
+
+	node = tree->node + at;
+	node->begin = begin;
+	node->end = end;
+	node->size = a3barnesHutSize_internal(tree, depth);
+	tree->top[tree->topCount++] = at;
+	for (i = begin, next = at + 1; i < end; i = j)
+	{
+		j = a3barnesHutRun_internal(tree->key, i, end, depth);
+		next = a3barnesHutLayout_internal(tree, i, j, depth + 1, next, subtree_inout);
+	}
+	node->next = next;
+	return next;
+}
+
+// internal tree walk for a group of sorted points [begin, end)
+//	- the opening test uses the group's bounding sphere, so a node is 
+//		only accepted when it is far enough from every point in it
+void a3barnesHutForce_internal(a3_BarnesHutTree *tree, const unsigned int begin, const unsigned int end)
+{
+	const a3real softeningSq = a3maximum(tree->softening * tree->softening, (a3real)(1.0e-20)), thetaSq = tree->theta * tree->theta;
+	const a3real *const x = tree->sorted[0], *const y = tree->sorted[1], *const z = tree->sorted[2], *const m = tree->sorted[3];
+	const unsigned int count = end - begin;
+	const a3_BarnesHutNode *node;
+	a3real a[3][a3barnesHutMaxCount_group] = { { a3realZero } }, lo[3], hi[3], center[3], radius;
+	a3real d[3], distanceSq, distance, scale;
+	unsigned int i = 0, j, k, c;
+
+	// bounding sphere of the group
+	for (c = 0; c < 3; ++c)
+	{
+		lo[c] = hi[c] = tree->sorted[c][begin];
+		for (k = begin + 1; k < end; ++k)
+		{
+			lo[c] = a3minimum(lo[c], tree->sorted[c][k]);
+			hi[c] = a3maximum(hi[c], tree->sorted[c][k]);
+		}
+		center[c] = (lo[c] + hi[c]) * a3realHalf;
+		d[c] = hi[c] - lo[c];
+	}
+	radius = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) * a3realHalf;
+
+	while (i < tree->nodeCount)
+	{
+		node = tree->node + i;
+		if (node->next == i + 1)
+		{
+			// leaf: every pair exactly (a point's own term has zero 
+			//	offset, and softening keeps its scale finite)
+			for (j = node->begin; j < node->end; ++j)
+				for (k = 0; k < count; ++k)
+				{
+					d[0] = x[j] - x[begin + k];
+					d[1] = y[j] - y[begin + k];
+					d[2] = z[j] - z[begin + k];
+					distanceSq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + softeningSq;
+					scale = m[j] / (distanceSq * sqrtf(distanceSq));
+					a[0][k] += d[0] * scale;
+					a[1][k] += d[1] * scale;
+					a[2][k] += d[2] * scale;
+				}
+			i = node->next;
+			continue;
+		}
+
+		d[0] = node->centerMass[0] - center[0];
+		d[1] = node->centerMass[1] - center[1];
+		d[2] = node->centerMass[2] - center[2];
+		distance = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) - radius;
+		if (distance > a3realZero && node->size * node->size < thetaSq * distance * distance)
+		{
+			// far enough from the whole group: node at its center of mass
+			for (k = 0; k < count; ++k)
+			{
+				d[0] = node->centerMass[0] - x[begin + k];
+				d[1] = node->centerMass[1] - y[begin + k];
+				d[2] = node->centerMass[2] - z[begin + k];
+				distanceSq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + softeningSq;
+				scale = node->mass / (distanceSq * sqrtf(distanceSq));
+				a[0][k] += d[0] * scale;
+				a[1][k] += d[1] * scale;
+				a[2][k] += d[2] * scale;
+			}
+			i = node->next;
+		}
+		else
+			++i;
+	}
+
+	for (k = 0; k < count; ++k)
+	{
+		j = tree->order[begin + k];
+		for (c = 0; c < 3; ++c)
+			tree->acceleration[j + tree->stride * c] = a[c][k] * tree->gravitationalConstant;
+	}
+}
+
+// internal job: run a pass over [begin, end)
+void a3barnesHutWork_internal(const a3_BarnesHutTask *task, const unsigned int begin, const unsigned int end)
+{
+	a3_BarnesHutTree *const tree = task->tree;
+	const a3real quantize = (a3real)(1023.99) / tree->boundsSize;
+	unsigned int i, c, q[3];
+
+	switch (task->pass)
+	{
+	case a3barnesHutPass_key:
+		for (i = begin; i < end; ++i)
+		{
+			for (c = 0; c < 3; ++c)
+				q[c] = (unsigned int)((tree->position[i + tree->stride * c] - tree->boundsMin[c]) * quantize);
+			tree->key[i] = a3barnesHutSpread_internal(q[0]) | a3barnesHutSpread_internal(q[1]) << 1 | a3barnesHutSpread_internal(q[2]) << 2;
+			tree->order[i] = i;
+		}
+		break;
+	case a3barnesHutPass_gather:
+		for (i = begin; i < end; ++i)
+		{
+			for (c = 0; c < 3; ++c)
+				tree->sorted[c][i] = tree->position[tree->order[i] + tree->stride * c];
+			tree->sorted[3][i] = tree->mass[tree->order[i]];
+		}
+		break;
+	case a3barnesHutPass_count:
+		for (i = begin; i < end; ++i)
+			tree->subtreeCount[i] = a3barnesHutCount_internal(tree, tree->subtreeBegin[i], tree->subtreeEnd[i], a3barnesHutSplitLevel);
+		break;
+	case a3barnesHutPass_fill:
+		for (i = begin; i < end; ++i)
+			a3barnesHutFill_internal(tree, tree->subtreeBegin[i], tree->subtreeEnd[i], a3barnesHutSplitLevel, tree->subtreeNode[i]);
+		break;
+	case a3barnesHutPass_force:
+		// leaves at the deepest level can hold more than a group
+		for (i = begin; i < end; ++i)
+			for (c = tree->node[tree->group[i]].begin; c < tree->node[tree->group[i]].end; c += a3barnesHutMaxCount_group)
+				a3barnesHutForce_internal(tree, c, a3minimum(c + a3barnesHutMaxCount_group, tree->node[tree->group[i]].end));
+		break;
+	}
+}
+
+// internal utility to split a pass over [0, count) into jobs of at 
+//	least grain items and wait
+void a3barnesHutRunPass_internal(a3_BarnesHutTree *tree, const int pass, const unsigned int count, const unsigned int grain)
+{
+	a3_BarnesHutTask task[1];
+	task->tree = tree;
+	task->pass = pass;
+	a3jobParallelFor(tree->jobs, (a3_JobFunc)a3barnesHutWork_internal, task, count, grain);
+}
+
+// internal utility: radix sort keys with their order, a byte at a time
+void a3barnesHutSort_internal(a3_BarnesHutTree *tree)
+{
+	unsigned int count[256], *key = tree->key, *order = tree->order, *keyOut = tree->keyScratch, *orderOut = tree->orderScratch, *swap;
+	unsigned int shift, i, b, sum, t;
+	for (shift = 0; shift < 32; shift += 8)
+	{
+		memset(count, 0, sizeof(count));
+		for (i = 0; i < tree->count; ++i)
+			++count[(key[i] >> shift) & 0xff];
+		for (b = 0, sum = 0; b < 256; ++b)
+		{
+			t = count[b];
+			count[b] = sum;
+			sum += t;
+		}
+		for (i = 0; i < tree->count; ++i)
+		{
+			b = (key[i] >> shift) & 0xff;
+			keyOut[count[b]] = key[i];
+			orderOut[count[b]++] = order[i];
+		}
+		swap = key, key = keyOut, keyOut = swap;
+		swap = order, order = orderOut, orderOut = swap;
+	}
+	// four passes: sorted keys are back in the first arrays
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3barnesHutCreate(a3_BarnesHutTree *tree_out, const unsigned int capacity, a3_JobSystem *jobs)
+{
+	if (tree_out && !tree_out->memory && capacity)
+	{
+		// internal nodes hold more than a leaf's worth of points, so 
+		//	each level below the split has fewer than capacity / 9, 
+		//	and leaves are disjoint: fewer than 2 nodes per point
+		const unsigned int nodeCapacity = capacity * 2 + a3barnesHutMaxCount_subtree;
+		const size_t size = (sizeof(unsigned int) * 5 + sizeof(a3real) * 4) * capacity + sizeof(a3_BarnesHutNode) * nodeCapacity;
+		unsigned int c;
+		tree_out->memory = malloc(size);
+		if (tree_out->memory)
+		{
+			memset(tree_out->memory, 0, size);
+			tree_out->node = (a3_BarnesHutNode *)tree_out->memory;
+			tree_out->key = (unsigned int *)(tree_out->node + nodeCapacity);
+			tree_out->order = tree_out->key + capacity;
+			tree_out->keyScratch = tree_out->order + capacity;
+			tree_out->orderScratch = tree_out->keyScratch + capacity;
+			tree_out->group = tree_out->orderScratch + capacity;
+			tree_out->sorted[0] = (a3real *)(tree_out->group + capacity);
+			for (c = 1; c < 4; ++c)
+				tree_out->sorted[c] = tree_out->sorted[c - 1] + capacity;
+			tree_out->capacity = capacity;
+			tree_out->nodeCapacity = nodeCapacity;
+			tree_out->count = tree_out->nodeCount = 0;
+			tree_out->theta = a3realHalf;
+			tree_out->gravitationalConstant = a3realOne;
+			tree_out->softening = (a3real)(0.1);
+			tree_out->jobs = jobs;
+			return capacity;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3barnesHutRelease(a3_BarnesHutTree *tree)
+{
+	if (tree && tree->memory)
+	{
+		free(tree->memory);
+		tree->memory = 0;
+		tree->count = tree->nodeCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3barnesHutBuild(a3_BarnesHutTree *tree, const a3real *position, const a3real *mass, const unsigned int count, const unsigned int stride)
+{
+	a3real lo, hi;
+	unsigned int i, j, c, subtree;
+	if (tree && tree->memory && position && mass && count <= tree->capacity && stride >= count)
+	{
+		tree->position = position;
+		tree->mass = mass;
+		tree->stride = stride;
+		tree->count = count;
+		tree->nodeCount = tree->groupCount = tree->subtrees = tree->topCount = 0;
+		if (!count)
+			return 0;
+
+		// cube around the points, a little larger so the far faces 
+		//	quantize inside it
+		for (c = 0, tree->boundsSize = a3realZero; c < 3; ++c)
+		{
+			lo = hi = position[stride * c];
+			for (i = 1; i < count; ++i)
+			{
+				lo = a3minimum(lo, position[i + stride * c]);
+				hi = a3maximum(hi, position[i + stride * c]);
+			}
+			tree->boundsMin[c] = lo;
+			tree->boundsSize = a3maximum(tree->boundsSize, hi - lo);
+		}
+		tree->boundsSize = tree->boundsSize * (a3real)(1.001) + (a3real)(1.0e-6);
+
+		// key, sort, gather
+		a3barnesHutRunPass_internal(tree, a3barnesHutPass_key, count, a3barnesHutMinCount_share);
+		a3barnesHutSort_internal(tree);
+		a3barnesHutRunPass_internal(tree, a3barnesHutPass_gather, count, a3barnesHutMinCount_share);
+
+		// subtrees are runs of keys sharing their top levels
+		for (i = 0; i < count; i = j)
+		{
+			c = tree->key[i] >> (3 * (a3barnesHutMaxCount_level - a3barnesHutSplitLevel));
+			for (j = i + 1; j < count && tree->key[j] >> (3 * (a3barnesHutMaxCount_level - a3barnesHutSplitLevel)) == c; ++j);
+			tree->subtreeBegin[tree->subtrees] = i;
+			tree->subtreeEnd[tree->subtrees++] = j;
+		}
+
+		// count, lay out, fill, then total the nodes above the split 
+		//	(children follow their parent, so in reverse)
+		a3barnesHutRunPass_internal(tree, a3barnesHutPass_count, tree->subtrees, 1);
+		subtree = 0;
+		tree->nodeCount = a3barnesHutLayout_internal(tree, 0, count, 0, 0, &subtree);
+		if (tree->nodeCount > tree->nodeCapacity)
+		{
+			tree->nodeCount = 0;
+			return -1;
+		}
+		a3barnesHutRunPass_internal(tree, a3barnesHutPass_fill, tree->subtrees, 1);
+		for (i = tree->topCount; i > 0; --i)
+		{
+			a3_BarnesHutNode *const node = tree->node + tree->top[i - 1];
+			node->mass = node->centerMass[0] = node->centerMass[1] = node->centerMass[2] = a3realZero;
+			for (j = tree->top[i - 1] + 1; j < node->next; j = tree->node[j].next)
+			{
+				for (c = 0; c < 3; ++c)
+					node->centerMass[c] += tree->node[j].centerMass[c] * tree->node[j].mass;
+				node->mass += tree->node[j].mass;
+			}
+			for (c = 0; c < 3; ++c)
+				node->centerMass[c] = node->mass > a3realZero ? node->centerMass[c] / node->mass : tree->sorted[c][node->begin];
+		}
+
+		// groups: the highest nodes small enough (or leaves), in 
+		//	sorted order
+		for (i = 0, tree->groupCount = 0; i < tree->nodeCount; )
+		{
+			if (tree->node[i].next == i + 1 || tree->node[i].end - tree->node[i].begin <= a3barnesHutMaxCount_group)
+			{
+				tree->group[tree->groupCount++] = i;
+				i = tree->node[i].next;
+			}
+			else
+				++i;
+		}
+		return tree->nodeCount;
+	}
+	return -1;
+}
+
+extern inline int a3barnesHutSolve(a3_BarnesHutTree *tree, a3real *acceleration_out)
+{
+	if (tree && tree->memory && acceleration_out)
+	{
+		tree->acceleration = acceleration_out;
+		if (tree->nodeCount)
+			a3barnesHutRunPass_internal(tree, a3barnesHutPass_force, tree->groupCount, 1);
+		return tree->count;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,184 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_BarnesHut.h
+	Barnes-Hut octree for N-body gravity over point sets.
+*/
+
+#ifndef __ANIMAL3D_BARNESHUT_H
+#define __ANIMAL3D_BARNESHUT_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "animal3D/a3math/A3DM.h"
+
+#include "a3_JobSystem.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_BarnesHutNode				a3_BarnesHutNode;
+	typedef struct a3_BarnesHutTask				a3_BarnesHutTask;
+	typedef struct a3_BarnesHutTree				a3_BarnesHutTree;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_BarnesHutLimits
+	{
+		// fewest points worth handing to another thread when keying 
+		//	and gathering
+		a3barnesHutMinCount_share = 1024,
+
+		// most points a leaf holds before it is split
+		a3barnesHutMaxCount_leaf = 8,
+
+		// most points that walk the tree together
+		a3barnesHutMaxCount_group = 32,
+
+		// levels below the root (10 bits of position per axis)
+		a3barnesHutMaxCount_level = 10,
+
+		// level whose cells are built as independent subtrees, and 
+		//	how many cells it has
+		a3barnesHutSplitLevel = 2,
+		a3barnesHutMaxCount_subtree = 1 << (3 * a3barnesHutSplitLevel),
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// octree node, stored in depth-first order
+	//	- next is the node after this one's subtree, so a traversal 
+	//		that accepts a node skips to next and one that opens it 
+	//		steps to the following node; leaves have next one past 
+	//		themselves
+	//	- a node covers the sorted points [begin, end)
+	struct a3_BarnesHutNode
+	{
+		a3real centerMass[3];
+		a3real mass;
+		a3real size;
+		unsigned int begin, end, next;
+	};
+
+	// pass handed to the job system
+	struct a3_BarnesHutTask
+	{
+		a3_BarnesHutTree *tree;
+		int pass;
+	};
+
+	// Barnes-Hut tree
+	//	- build: points are keyed by Morton code in a cube around 
+	//		them and radix sorted; the cells at the split level are 
+	//		independent subtrees, so jobs first count each one's 
+	//		nodes, the few nodes above them are laid out from the 
+	//		counts, and then jobs fill the subtrees in place
+	//	- solve: points walk the tree in groups (the highest nodes 
+	//		holding few enough) as jobs, taking a node's total mass at its center of mass 
+	//		when the node's size over its distance from the group is 
+	//		below the opening angle, and summing a leaf's points 
+	//		exactly otherwise
+	//	- gravity is softened: a = G m d / (|d|^2 + e^2)^(3/2)
+	struct a3_BarnesHutTree
+	{
+		// opening angle (0 is exact, about 0.5 is typical), 
+		//	gravitational constant and softening length (kept above 
+		//	zero so a point's own term vanishes instead of dividing 
+		//	by zero)
+		a3real theta;
+		a3real gravitationalConstant;
+		a3real softening;
+
+		// point count and capacity
+		unsigned int count, capacity;
+
+		// per point: key, sorted order (sorted index to input index), 
+		//	sort scratch, and sorted positions and masses
+		unsigned int *key, *order, *keyScratch, *orderScratch;
+		a3real *sorted[4];
+
+		// nodes, and the groups solve walks for (fewer than points)
+		a3_BarnesHutNode *node;
+		unsigned int nodeCount, nodeCapacity;
+		unsigned int *group;
+		unsigned int groupCount;
+
+		// cube the keys quantize
+		a3real boundsMin[3], boundsSize;
+
+		// subtrees at the split level: sorted range, node count and 
+		//	first node, and the nodes above them
+		unsigned int subtreeBegin[a3barnesHutMaxCount_subtree], subtreeEnd[a3barnesHutMaxCount_subtree];
+		unsigned int subtreeCount[a3barnesHutMaxCount_subtree], subtreeNode[a3barnesHutMaxCount_subtree];
+		unsigned int subtrees;
+		unsigned int top[a3barnesHutMaxCount_subtree];
+		unsigned int topCount;
+
+		// input being solved (blocks of x, y, z at stride) and output
+		const a3real *position, *mass;
+		a3real *acceleration;
+		unsigned int stride;
+
+		// job system passes run on (null to run them here)
+		a3_JobSystem *jobs;
+
+		// allocation holding per-point arrays and nodes
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create tree for up to capacity points (allocates; call once at 
+	//	startup)
+	inline int a3barnesHutCreate(a3_BarnesHutTree *tree_out, const unsigned int capacity, a3_JobSystem *jobs);
+
+	// release tree memory
+	inline int a3barnesHutRelease(a3_BarnesHutTree *tree);
+
+	// build the tree over count points with positions in three blocks 
+	//	at stride (the particle pool's layout) and masses
+	//	- returns node count
+	inline int a3barnesHutBuild(a3_BarnesHutTree *tree, const a3real *position, const a3real *mass, const unsigned int count, const unsigned int stride);
+
+	// write each point's gravitational acceleration from the last 
+	//	build (same layout as the positions)
+	inline int a3barnesHutSolve(a3_BarnesHutTree *tree, a3real *acceleration_out);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_BARNESHUT_H
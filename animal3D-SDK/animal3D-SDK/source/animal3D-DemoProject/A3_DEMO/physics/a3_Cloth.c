@@ -0,0 +1,490 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_Cloth.c/.cpp
+	Implementation of mass-spring networks.
+*/
+
+#include "a3_Cloth.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// spring kernels
+//	- each gathers a batch of springs' endpoint data into flat 
+//		arrays, runs a branch-free loop over them, then scatters 
+//		results back to both endpoints (endpoints repeat across 
+//		springs, so the scatter stays serial)
+
+// forces: Hooke's law plus damping along the spring; also stores 
+//	each spring's direction and jacobian stiffnesses for the solver
+void a3clothSpringForce_internal(a3_Cloth *cloth)
+{
+	const unsigned int pc = cloth->particleCapacity, sc = cloth->springCapacity;
+	const a3real *const x = cloth->position, *const v = cloth->velocity;
+	a3real *const f = cloth->force;
+	a3real dx[3][a3clothBatchSize], dv[3][a3clothBatchSize], fs[3][a3clothBatchSize];
+	a3real length, lengthInv, stretch, speed, tension, lateral, *u;
+	unsigned int first, n, s, a, b, c;
+
+	for (first = 0; first < cloth->springCount; first += n)
+	{
+		n = a3minimum(cloth->springCount - first, (unsigned int)a3clothBatchSize);
+
+		// gather separation and relative velocity
+		for (c = 0; c < 3; ++c)
+			for (s = 0; s < n; ++s)
+			{
+				a = cloth->springA[first + s] + pc * c;
+				b = cloth->springB[first + s] + pc * c;
+				dx[c][s] = x[a] - x[b];
+				dv[c][s] = v[a] - v[b];
+			}
+
+		// kernel: tension along the spring; compressed springs drop 
+		//	their lateral stiffness (it would be negative)
+		for (s = 0; s < n; ++s)
+		{
+			length = (a3real)a3sqrt(dx[0][s] * dx[0][s] + dx[1][s] * dx[1][s] + dx[2][s] * dx[2][s]);
+			lengthInv = length > a3realZero ? a3recip(length) : a3realZero;
+			u = cloth->direction + first + s;
+			u[0] = dx[0][s] * lengthInv;
+			u[sc] = dx[1][s] * lengthInv;
+			u[sc * 2] = dx[2][s] * lengthInv;
+			stretch = length - cloth->restLength[first + s];
+			speed = dv[0][s] * u[0] + dv[1][s] * u[sc] + dv[2][s] * u[sc * 2];
+			tension = -cloth->stiffness[first + s] * stretch - cloth->damping[first + s] * speed;
+			fs[0][s] = tension * u[0];
+			fs[1][s] = tension * u[sc];
+			fs[2][s] = tension * u[sc * 2];
+
+			lateral = a3realOne - cloth->restLength[first + s] * lengthInv;
+			lateral = lateral > a3realZero ? lateral : a3realZero;
+			cloth->stiffnessLateral[first + s] = cloth->stiffness[first + s] * lateral;
+			cloth->stiffnessAxial[first + s] = cloth->stiffness[first + s] - cloth->stiffnessLateral[first + s];
+		}
+
+		// scatter: equal and opposite
+		for (c = 0; c < 3; ++c)
+			for (s = 0; s < n; ++s)
+			{
+				f[cloth->springA[first + s] + pc * c] += fs[c][s];
+				f[cloth->springB[first + s] + pc * c] -= fs[c][s];
+			}
+	}
+}
+
+// product: out += J p for the spring part of the system, where each 
+//	spring contributes (scaleStiffness * axial + scaleDamping * damping) 
+//	uu' + scaleStiffness * lateral I to the difference of its endpoints
+void a3clothSpringProduct_internal(const a3_Cloth *cloth, a3real *out, const a3real *p, const a3real scaleStiffness, const a3real scaleDamping)
+{
+	const unsigned int pc = cloth->particleCapacity, sc = cloth->springCapacity;
+	const a3real *const u = cloth->direction;
+	a3real dp[3][a3clothBatchSize], ys[3][a3clothBatchSize];
+	a3real along, weightAxial, weightLateral;
+	unsigned int first, n, s, c;
+
+	for (first = 0; first < cloth->springCount; first += n)
+	{
+		n = a3minimum(cloth->springCount - first, (unsigned int)a3clothBatchSize);
+
+		for (c = 0; c < 3; ++c)
+			for (s = 0; s < n; ++s)
+				dp[c][s] = p[cloth->springA[first + s] + pc * c] - p[cloth->springB[first + s] + pc * c];
+
+		for (s = 0; s < n; ++s)
+		{
+			weightAxial = scaleStiffness * cloth->stiffnessAxial[first + s] + scaleDamping * cloth->damping[first + s];
+			weightLateral = scaleStiffness * cloth->stiffnessLateral[first + s];
+			along = weightAxial * (dp[0][s] * u[first + s] + dp[1][s] * u[first + s + sc] + dp[2][s] * u[first + s + sc * 2]);
+			ys[0][s] = along * u[first + s] + weightLateral * dp[0][s];
+			ys[1][s] = along * u[first + s + sc] + weightLateral * dp[1][s];
+			ys[2][s] = along * u[first + s + sc * 2] + weightLateral * dp[2][s];
+		}
+
+		for (c = 0; c < 3; ++c)
+			for (s = 0; s < n; ++s)
+			{
+				out[cloth->springA[first + s] + pc * c] += ys[c][s];
+				out[cloth->springB[first + s] + pc * c] -= ys[c][s];
+			}
+	}
+}
+
+// diagonal of the spring part of the system (same weights as the 
+//	product), added to both endpoints
+void a3clothSpringDiagonal_internal(const a3_Cloth *cloth, a3real *out, const a3real scaleStiffness, const a3real scaleDamping)
+{
+	const unsigned int pc = cloth->particleCapacity, sc = cloth->springCapacity;
+	const a3real *const u = cloth->direction;
+	a3real weightAxial, weightLateral, d;
+	unsigned int s, c;
+
+	for (s = 0; s < cloth->springCount; ++s)
+	{
+		weightAxial = scaleStiffness * cloth->stiffnessAxial[s] + scaleDamping * cloth->damping[s];
+		weightLateral = scaleStiffness * cloth->stiffnessLateral[s];
+		for (c = 0; c < 3; ++c)
+		{
+			d = weightAxial * u[s + sc * c] * u[s + sc * c] + weightLateral;
+			out[cloth->springA[s] + pc * c] += d;
+			out[cloth->springB[s] + pc * c] += d;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper: dot product over the three blocks of two vectors
+a3real a3clothDot_internal(const a3_Cloth *cloth, const a3real *a, const a3real *b)
+{
+	const unsigned int pc = cloth->particleCapacity;
+	a3real sum = a3realZero;
+	unsigned int c, i;
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < cloth->particleCount; ++i)
+			sum += a[i + pc * c] * b[i + pc * c];
+	return sum;
+}
+
+// internal helper: zero the entries of pinned particles
+void a3clothFilter_internal(const a3_Cloth *cloth, a3real *a)
+{
+	const unsigned int pc = cloth->particleCapacity;
+	unsigned int c, i;
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < cloth->particleCount; ++i)
+			a[i + pc * c] = cloth->massInv[i] > a3realZero ? a[i + pc * c] : a3realZero;
+}
+
+// internal helper: system product out = (M + h c) p + J p, filtered
+//	(pinned particles use unit mass; their rows are filtered anyway)
+void a3clothSystemProduct_internal(const a3_Cloth *cloth, a3real *out, const a3real *p, const a3real dt)
+{
+	const unsigned int pc = cloth->particleCapacity;
+	a3real mass;
+	unsigned int c, i;
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < cloth->particleCount; ++i)
+		{
+			mass = cloth->massInv[i] > a3realZero ? a3recip(cloth->massInv[i]) : a3realOne;
+			out[i + pc * c] = (mass + dt * cloth->airDamping) * p[i + pc * c];
+		}
+	a3clothSpringProduct_internal(cloth, out, p, dt * dt, dt);
+	a3clothFilter_internal(cloth, out);
+}
+
+// internal utility: gravity and air damping on free particles, 
+//	then springs
+void a3clothForce_internal(a3_Cloth *cloth)
+{
+	const unsigned int pc = cloth->particleCapacity;
+	a3real mass;
+	unsigned int c, i;
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < cloth->particleCount; ++i)
+		{
+			mass = cloth->massInv[i] > a3realZero ? a3recip(cloth->massInv[i]) : a3realZero;
+			cloth->force[i + pc * c] = mass * cloth->gravity.v[c] - cloth->airDamping * cloth->velocity[i + pc * c];
+		}
+	a3clothSpringForce_internal(cloth);
+}
+
+// internal utility: backward Euler velocity change by preconditioned 
+//	conjugate gradient; returns iterations taken
+unsigned int a3clothSolveImplicit_internal(a3_Cloth *cloth, const a3real dt)
+{
+	const unsigned int pc = cloth->particleCapacity, count = cloth->particleCount;
+	a3real *const dv = cloth->deltaVelocity, *const r = cloth->residual, *const p = cloth->search;
+	a3real *const q = cloth->product, *const d = cloth->diagonal;
+	a3real mass, rz, rzNext, rr, bb, alpha, beta;
+	unsigned int c, i, j, k;
+
+	// right side: h f - h^2 K v (K is the stiffness part of J)
+	memset(q, 0, sizeof(a3real) * pc * 3);
+	a3clothSpringProduct_internal(cloth, q, cloth->velocity, dt * dt, a3realZero);
+	for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+		for (i = 0; i < count; ++i, ++j)
+			r[j] = dt * cloth->force[j] - q[j];
+	a3clothFilter_internal(cloth, r);
+
+	// preconditioner: inverse of the system's diagonal
+	for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+		for (i = 0; i < count; ++i, ++j)
+		{
+			mass = cloth->massInv[i] > a3realZero ? a3recip(cloth->massInv[i]) : a3realOne;
+			d[j] = mass + dt * cloth->airDamping;
+		}
+	a3clothSpringDiagonal_internal(cloth, d, dt * dt, dt);
+	for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+		for (i = 0; i < count; ++i, ++j)
+			d[j] = a3recip(d[j]);
+
+	// start from the last step's change (velocity changes smoothly 
+	//	between steps, so this saves iterations): r = b - A dv
+	bb = a3clothDot_internal(cloth, r, r);
+	a3clothFilter_internal(cloth, dv);
+	a3clothSystemProduct_internal(cloth, q, dv, dt);
+	for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+		for (i = 0; i < count; ++i, ++j)
+		{
+			r[j] -= q[j];
+			p[j] = d[j] * r[j];
+		}
+	rz = a3clothDot_internal(cloth, r, p);
+
+	for (k = 0; k < cloth->iterationsMax && bb > a3realZero; ++k)
+	{
+		a3clothSystemProduct_internal(cloth, q, p, dt);
+		alpha = a3clothDot_internal(cloth, p, q);
+		if (alpha <= a3realZero)
+			break;
+		alpha = rz / alpha;
+		for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+			for (i = 0; i < count; ++i, ++j)
+			{
+				dv[j] += alpha * p[j];
+				r[j] -= alpha * q[j];
+			}
+
+		rr = a3clothDot_internal(cloth, r, r);
+		if (rr <= cloth->tolerance * cloth->tolerance * bb)
+		{
+			++k;
+			break;
+		}
+
+		rzNext = a3realZero;
+		for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+			for (i = 0; i < count; ++i, ++j)
+				rzNext += r[j] * r[j] * d[j];
+		beta = rzNext / rz;
+		rz = rzNext;
+		for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+			for (i = 0; i < count; ++i, ++j)
+				p[j] = d[j] * r[j] + beta * p[j];
+	}
+	return k;
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3clothCreate(a3_Cloth *cloth_out, const unsigned int particleCapacity, const unsigned int springCapacity)
+{
+	if (cloth_out && !cloth_out->memory && particleCapacity && springCapacity)
+	{
+		// 25 particle blocks, 8 spring blocks of reals and 2 of indices
+		const unsigned int pc = (particleCapacity + 7) & ~7u, sc = (springCapacity + 7) & ~7u;
+		const size_t size = sizeof(a3real) * (pc * 25 + sc * 8) + sizeof(unsigned int) * sc * 2;
+		void *const memory = malloc(size);
+		a3real *base;
+		if (memory)
+		{
+			memset(memory, 0, size);
+			base = (a3real *)memory;
+			cloth_out->memory = memory;
+			cloth_out->position = base;
+			cloth_out->velocity = base + pc * 3;
+			cloth_out->force = base + pc * 6;
+			cloth_out->massInv = base + pc * 9;
+			cloth_out->deltaVelocity = base + pc * 10;
+			cloth_out->residual = base + pc * 13;
+			cloth_out->search = base + pc * 16;
+			cloth_out->product = base + pc * 19;
+			cloth_out->diagonal = base + pc * 22;
+			base += pc * 25;
+			cloth_out->restLength = base;
+			cloth_out->stiffness = base + sc;
+			cloth_out->damping = base + sc * 2;
+			cloth_out->direction = base + sc * 3;
+			cloth_out->stiffnessAxial = base + sc * 6;
+			cloth_out->stiffnessLateral = base + sc * 7;
+			cloth_out->springA = (unsigned int *)(base + sc * 8);
+			cloth_out->springB = cloth_out->springA + sc;
+			cloth_out->particleCount = cloth_out->springCount = 0;
+			cloth_out->particleCapacity = pc;
+			cloth_out->springCapacity = sc;
+
+			a3real3Set(cloth_out->gravity.v, a3realZero, a3realZero, (a3real)(-9.80665));
+			cloth_out->airDamping = a3realZero;
+			cloth_out->integrator = a3clothIntegrator_implicit;
+			cloth_out->iterationsMax = 50;
+			cloth_out->tolerance = (a3real)(0.01);
+			cloth_out->iterations = 0;
+			return pc;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3clothRelease(a3_Cloth *cloth)
+{
+	if (cloth && cloth->memory)
+	{
+		free(cloth->memory);
+		memset(cloth, 0, sizeof(a3_Cloth));
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3clothAddParticle(a3_Cloth *cloth, const a3real3p position, const a3real mass)
+{
+	if (cloth && cloth->memory && position && cloth->particleCount < cloth->particleCapacity)
+	{
+		const unsigned int i = cloth->particleCount++, pc = cloth->particleCapacity;
+		cloth->position[i] = position[0];
+		cloth->position[i + pc] = position[1];
+		cloth->position[i + pc * 2] = position[2];
+		cloth->velocity[i] = cloth->velocity[i + pc] = cloth->velocity[i + pc * 2] = a3realZero;
+		cloth->massInv[i] = mass > a3realZero ? a3recip(mass) : a3realZero;
+		return i;
+	}
+	return -1;
+}
+
+extern inline int a3clothAddSpring(a3_Cloth *cloth, const unsigned int a, const unsigned int b, const a3real stiffness, const a3real damping)
+{
+	if (cloth && cloth->memory && a < cloth->particleCount && b < cloth->particleCount && a != b && cloth->springCount < cloth->springCapacity)
+	{
+		const unsigned int s = cloth->springCount++, pc = cloth->particleCapacity;
+		const a3real dx = cloth->position[a] - cloth->position[b];
+		const a3real dy = cloth->position[a + pc] - cloth->position[b + pc];
+		const a3real dz = cloth->position[a + pc * 2] - cloth->position[b + pc * 2];
+		cloth->springA[s] = a;
+		cloth->springB[s] = b;
+		cloth->restLength[s] = (a3real)a3sqrt(dx * dx + dy * dy + dz * dz);
+		cloth->stiffness[s] = stiffness;
+		cloth->damping[s] = damping;
+		return s;
+	}
+	return -1;
+}
+
+extern inline int a3clothAddSheet(a3_Cloth *cloth, const a3real3p corner, const a3real3p edgeU, const a3real3p edgeV, const unsigned int countU, const unsigned int countV, const a3real mass, const a3real stiffness, const a3real damping)
+{
+	const a3real bend = (a3real)(0.1);
+	a3vec3 position;
+	unsigned int i, j, first, c;
+	if (cloth && cloth->memory && corner && edgeU && edgeV && countU > 1 && countV > 1 &&
+		cloth->particleCount + countU * countV <= cloth->particleCapacity &&
+		cloth->springCount + (countU - 1) * countV + countU * (countV - 1) + (countU - 1) * (countV - 1) * 2 +
+			(countU - 2) * countV + countU * (countV - 2) <= cloth->springCapacity)
+	{
+		first = cloth->particleCount;
+		for (j = 0; j < countV; ++j)
+			for (i = 0; i < countU; ++i)
+			{
+				for (c = 0; c < 3; ++c)
+					position.v[c] = corner[c] + edgeU[c] * (a3real)(i) / (a3real)(countU - 1) + edgeV[c] * (a3real)(j) / (a3real)(countV - 1);
+				a3clothAddParticle(cloth, position.v, mass);
+			}
+
+		// structural and shear springs, then bend springs skipping one
+		for (j = 0; j < countV; ++j)
+			for (i = 0; i < countU; ++i)
+			{
+				c = first + j * countU + i;
+				if (i + 1 < countU)
+					a3clothAddSpring(cloth, c, c + 1, stiffness, damping);
+				if (j + 1 < countV)
+					a3clothAddSpring(cloth, c, c + countU, stiffness, damping);
+				if (i + 1 < countU && j + 1 < countV)
+				{
+					a3clothAddSpring(cloth, c, c + countU + 1, stiffness, damping);
+					a3clothAddSpring(cloth, c + 1, c + countU, stiffness, damping);
+				}
+				if (i + 2 < countU)
+					a3clothAddSpring(cloth, c, c + 2, stiffness * bend, damping * bend);
+				if (j + 2 < countV)
+					a3clothAddSpring(cloth, c, c + countU * 2, stiffness * bend, damping * bend);
+			}
+		return first;
+	}
+	return -1;
+}
+
+extern inline int a3clothSetMass(a3_Cloth *cloth, const unsigned int index, const a3real mass)
+{
+	const unsigned int pc = cloth ? cloth->particleCapacity : 0;
+	if (cloth && cloth->memory && index < cloth->particleCount)
+	{
+		cloth->massInv[index] = mass > a3realZero ? a3recip(mass) : a3realZero;
+		if (mass <= a3realZero)
+			cloth->velocity[index] = cloth->velocity[index + pc] = cloth->velocity[index + pc * 2] = a3realZero;
+		return index;
+	}
+	return -1;
+}
+
+extern inline int a3clothStep(a3_Cloth *cloth, const a3real dt)
+{
+	const unsigned int pc = cloth ? cloth->particleCapacity : 0;
+	unsigned int c, i, j;
+	if (cloth && cloth->memory)
+	{
+		a3clothForce_internal(cloth);
+		if (cloth->integrator == a3clothIntegrator_implicit)
+		{
+			// v += dv (pinned entries are zero)
+			cloth->iterations = a3clothSolveImplicit_internal(cloth, dt);
+			for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+				for (i = 0; i < cloth->particleCount; ++i, ++j)
+					cloth->velocity[j] += cloth->deltaVelocity[j];
+		}
+		else
+		{
+			// v += a dt
+			for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+				for (i = 0; i < cloth->particleCount; ++i, ++j)
+					cloth->velocity[j] += cloth->force[j] * cloth->massInv[i] * dt;
+			cloth->iterations = 0;
+		}
+
+		// x += v dt with the new velocity
+		for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+			for (i = 0; i < cloth->particleCount; ++i, ++j)
+				cloth->position[j] += cloth->velocity[j] * dt;
+		return cloth->particleCount;
+	}
+	return -1;
+}
+
+extern inline int a3clothCopyPositions(a3real *position_out, const a3_Cloth *cloth)
+{
+	unsigned int c;
+	if (position_out && cloth && cloth->memory)
+	{
+		for (c = 0; c < 3; ++c)
+			memcpy(position_out + cloth->particleCapacity * c, cloth->position + cloth->particleCapacity * c, sizeof(a3real) * cloth->particleCount);
+		return cloth->particleCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
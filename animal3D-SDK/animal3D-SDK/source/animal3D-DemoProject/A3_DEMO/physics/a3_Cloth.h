@@ -0,0 +1,171 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_Cloth.h
+	Mass-spring networks (cloth and soft bodies) with batched spring 
+		forces and explicit or implicit integration.
+*/
+
+#ifndef __ANIMAL3D_CLOTH_H
+#define __ANIMAL3D_CLOTH_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_Integration.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_Cloth				a3_Cloth;
+	typedef enum a3_ClothIntegrator		a3_ClothIntegrator;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_ClothLimits
+	{
+		// springs gathered per kernel call
+		a3clothBatchSize = 256,
+	};
+
+	// integrators
+	enum a3_ClothIntegrator
+	{
+		// semi-implicit Euler: cheap, but stiff springs need steps 
+		//	shorter than about 2 * sqrt(mass / stiffness)
+		a3clothIntegrator_explicit,
+
+		// backward Euler: solves for the velocity at the end of the 
+		//	step with conjugate gradient; stable at any step, at the 
+		//	cost of some damping
+		a3clothIntegrator_implicit,
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// mass-spring network
+	//	- particles are structure-of-arrays like the particle pool: 
+	//		each vector attribute is three blocks of particleCapacity
+	//	- springs are index pairs with per-spring rest length, 
+	//		stiffness and damping (along the spring); forces are 
+	//		evaluated in batches: gather endpoints, run a branch-free 
+	//		kernel over flat arrays, scatter-add results
+	//	- a particle with zero inverse mass is pinned
+	//	- implicit mode (Baraff & Witkin 1998) solves
+	//		(M - h df/dv - h^2 df/dx) dv = h (f + h df/dx v)
+	//		matrix-free: each spring's force jacobian is rebuilt from 
+	//		its direction every step (the compressed part is dropped 
+	//		so the system stays positive definite) and multiplied 
+	//		in the same batched form; pinned particles are filtered 
+	//		out, the diagonal preconditions the solve, and each solve 
+	//		starts from the last step's velocity change
+	struct a3_Cloth
+	{
+		// particles
+		a3real *position;			// x
+		a3real *velocity;			// v
+		a3real *force;				// f
+		a3real *massInv;			// 1/m (one block; 0 pins)
+		unsigned int particleCount, particleCapacity;
+
+		// springs
+		unsigned int *springA, *springB;
+		a3real *restLength, *stiffness, *damping;
+		unsigned int springCount, springCapacity;
+
+		// uniform acceleration (e.g. gravity) and air damping (-cv)
+		a3vec3 gravity;
+		a3real airDamping;
+
+		// integrator, and conjugate gradient limits (implicit): stop 
+		//	when the residual falls to tolerance times its start
+		a3_ClothIntegrator integrator;
+		unsigned int iterationsMax;
+		a3real tolerance;
+
+		// iterations the last implicit step took
+		unsigned int iterations;
+
+		// solver scratch: per spring unit direction (three blocks) and 
+		//	stiffness along it and across it (the jacobian is 
+		//	axial * uu' + lateral * I); per particle velocity change, 
+		//	residual, search direction, product and preconditioner 
+		//	(three blocks each)
+		a3real *direction, *stiffnessAxial, *stiffnessLateral;
+		a3real *deltaVelocity, *residual, *search, *product, *diagonal;
+
+		// single allocation holding every array
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create network with room for the given particles and springs
+	//	(allocates; call once at startup)
+	inline int a3clothCreate(a3_Cloth *cloth_out, const unsigned int particleCapacity, const unsigned int springCapacity);
+
+	// release network memory
+	inline int a3clothRelease(a3_Cloth *cloth);
+
+	// add particle at rest (mass <= 0 pins it)
+	//	- returns its index or -1 if full
+	inline int a3clothAddParticle(a3_Cloth *cloth, const a3real3p position, const a3real mass);
+
+	// add spring between two particles, resting at their current 
+	//	distance; damping acts on speed along the spring
+	//	- returns its index or -1 if full
+	inline int a3clothAddSpring(a3_Cloth *cloth, const unsigned int a, const unsigned int b, const a3real stiffness, const a3real damping);
+
+	// add a sheet of countU x countV particles spanning edgeU and 
+	//	edgeV from corner, with structural, shear and bend springs
+	//	- bend springs are a tenth as stiff as the others
+	//	- returns the index of the first particle or -1 if full
+	inline int a3clothAddSheet(a3_Cloth *cloth, const a3real3p corner, const a3real3p edgeU, const a3real3p edgeV, const unsigned int countU, const unsigned int countV, const a3real mass, const a3real stiffness, const a3real damping);
+
+	// pin or unpin a particle (mass <= 0 pins)
+	inline int a3clothSetMass(a3_Cloth *cloth, const unsigned int index, const a3real mass);
+
+	// advance the network by dt with its integrator
+	inline int a3clothStep(a3_Cloth *cloth, const a3real dt);
+
+	// copy positions in bulk to a buffer with the network's layout 
+	//	(three blocks of particleCapacity reals)
+	inline int a3clothCopyPositions(a3real *position_out, const a3_Cloth *cloth);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_CLOTH_H
@@ -138,6 +138,7 @@ inline int a3collisionTestSpheres(a3_ConvexHullCollision *collision_out,
 	if (a3real3LengthSquared(diff_tmp) <= sumRadii * sumRadii)
 	{
 		// generate contacts
+		collision_out->penetration[0] = sumRadii - a3real3Length(diff_tmp);
 		a3real3Normalize(diff_tmp);
 		a3real3Set(collision_out->normal_a[0].v, diff_tmp[0], diff_tmp[1], diff_tmp[2]);
 		
@@ -173,6 +174,7 @@ inline int a3collisionTestSphereAABB(a3_ConvexHullCollision *collision_out,
 		// box is b
 		collision_out->contactCount_a = collision_out->contactCount_b = 1;
 		collision_out->contact_a[0] = collision_out->contact_b[0] = tmp;
+		collision_out->penetration[0] = sphereRadius - a3real3Length(diff_tmp);
 		a3real3Normalize(diff_tmp);
 
 		a3real3Set(collision_out->normal_b[0].v, diff_tmp[0], diff_tmp[1], diff_tmp[2]);
@@ -212,6 +214,11 @@ inline int a3collisionTestAABBs(a3_ConvexHullCollision *collision_out,
 		collision_out->contact_b[0] = collision_out->contact_a[0];
 		collision_out->contactCount_a = collision_out->contactCount_b = 1;
 
+		// shallowest overlap on any axis
+		collision_out->penetration[0] = a3minimum(aabbMaxExtents_a[0], aabbMaxExtents_b[0]) - a3maximum(aabbMinExtents_a[0], aabbMinExtents_b[0]);
+		collision_out->penetration[0] = a3minimum(collision_out->penetration[0], a3minimum(aabbMaxExtents_a[1], aabbMaxExtents_b[1]) - a3maximum(aabbMinExtents_a[1], aabbMinExtents_b[1]));
+		collision_out->penetration[0] = a3minimum(collision_out->penetration[0], a3minimum(aabbMaxExtents_a[2], aabbMaxExtents_b[2]) - a3maximum(aabbMinExtents_a[2], aabbMinExtents_b[2]));
+
 		a3real3Diff(collision_out->normal_a[0].v, aabbMinExtents_b, aabbMinExtents_a);
 		a3real3Normalize(collision_out->normal_a[0].v);
 		collision_out->normal_b[0] = collision_out->normal_a[0];
@@ -223,6 +230,43 @@ inline int a3collisionTestAABBs(a3_ConvexHullCollision *collision_out,
 	return 0;
 }
 
+// signed distance from a sphere to a plane or box hull
+//	- normal points from the hull toward the sphere
+//	- planes are bounded and two-sided, boxes use world extents
+inline a3real a3collisionDistanceSphereHull_internal(a3real3p normal_out, const a3real3p sphereCenter, const a3real sphereRadius, const a3_ConvexHull *hull)
+{
+	a3real3 diff, closest, tmp;
+	a3real dist, u, v;
+	unsigned int a, b, c;
+
+	a3real3Diff(diff, sphereCenter, hull->transform->v3.v);
+	switch (hull->type)
+	{
+	case a3hullType_plane:
+		// clamp into the rectangle spanned by the tangent axes
+		c = hull->axis;
+		a = (c + 1) % 3;
+		b = (c + 2) % 3;
+		u = a3clamp(-hull->prop[a3hullProperty_halfwidth], hull->prop[a3hullProperty_halfwidth], a3real3Dot(diff, hull->transform->m[a]));
+		v = a3clamp(-hull->prop[a3hullProperty_halfheight], hull->prop[a3hullProperty_halfheight], a3real3Dot(diff, hull->transform->m[b]));
+		a3real3Sum(closest, a3real3ProductS(closest, hull->transform->m[a], u), a3real3ProductS(tmp, hull->transform->m[b], v));
+		break;
+	case a3hullType_box:
+		closest[0] = a3clamp(-hull->prop[a3hullProperty_halfwidth], hull->prop[a3hullProperty_halfwidth], diff[0]);
+		closest[1] = a3clamp(-hull->prop[a3hullProperty_halfheight], hull->prop[a3hullProperty_halfheight], diff[1]);
+		closest[2] = a3clamp(-hull->prop[a3hullProperty_halfdepth], hull->prop[a3hullProperty_halfdepth], diff[2]);
+		break;
+	default:
+		return a3realZero;
+	}
+
+	a3real3Diff(normal_out, diff, closest);
+	dist = a3real3Length(normal_out);
+	if (dist > a3realZero)
+		a3real3MulS(normal_out, a3recip(dist));
+	return (dist - sphereRadius);
+}
+
 
 //-----------------------------------------------------------------------------
 
@@ -375,11 +419,13 @@ a3vec3 rotatePosition(a3vec3 n, a3real angle, a3vec3 p)
 	return p;
 }
 
-// high-level collision test
-extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_out, const a3_ConvexHull *hull_a, const a3_ConvexHull *hull_b)
+// high-level collision test with speculative margin
+extern inline int a3collisionTestConvexHullsSpeculative(a3_ConvexHullCollision *collision_out, const a3_ConvexHull *hull_a, const a3_ConvexHull *hull_b, const a3real margin)
 {
 	if (collision_out && hull_a && hull_b)
 	{
+		// the first hull is grown by the margin; depth is corrected after
+		a3real prop_a[a3hullProperty_maxCount_preset];
 		//Perform collision tests
 		//****NOTE:
 		//Charlie did AABB/OBB, Plane/OBB
@@ -388,6 +434,17 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 		int status = 0;
 		a3real3 tmp;
 
+		if (hull_a->type == a3hullType_sphere)
+		{
+			prop_a[a3hullProperty_radius] = hull_a->prop[a3hullProperty_radius] + margin;
+		}
+		else
+		{
+			prop_a[a3hullProperty_halfwidth] = hull_a->prop[a3hullProperty_halfwidth] + margin;
+			prop_a[a3hullProperty_halfheight] = hull_a->prop[a3hullProperty_halfheight] + margin;
+			prop_a[a3hullProperty_halfdepth] = hull_a->prop[a3hullProperty_halfdepth] + margin;
+		}
+
 		switch (hull_a->type)
 		{
 		case a3hullType_sphere:
@@ -398,7 +455,7 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 			{
 				collision_out->hull_a = hull_a;
 				collision_out->hull_b = hull_b;
-				status = a3collisionTestSpheres(collision_out, hull_a->transform->v3.v, hull_a->prop[a3hullProperty_radius],
+				status = a3collisionTestSpheres(collision_out, hull_a->transform->v3.v, prop_a[a3hullProperty_radius],
 					hull_b->transform->v3.v, hull_b->prop[a3hullProperty_radius], tmp);
 			}
 			break;
@@ -419,7 +476,7 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					minB.z = hull_b->transform->v3.z - hull_b->prop[a3hullProperty_halfdepth];
 					maxB.z = hull_b->transform->v3.z + hull_b->prop[a3hullProperty_halfdepth];
 					
-					status = a3collisionTestSphereAABB(collision_out, hull_a->transform->v3.v, hull_a->prop[a3hullProperty_radius], minB.v, maxB.v, diff.v);
+					status = a3collisionTestSphereAABB(collision_out, hull_a->transform->v3.v, prop_a[a3hullProperty_radius], minB.v, maxB.v, diff.v);
 				}
 				else
 				{
@@ -437,7 +494,7 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					minB.z = hull_b->transform->v3.z - hull_b->prop[a3hullProperty_halfdepth];
 					maxB.z = hull_b->transform->v3.z + hull_b->prop[a3hullProperty_halfdepth];
 
-					status = a3collisionTestSphereAABB(collision_out, temp.v, hull_a->prop[a3hullProperty_radius], minB.v, maxB.v, diff.v);
+					status = a3collisionTestSphereAABB(collision_out, temp.v, prop_a[a3hullProperty_radius], minB.v, maxB.v, diff.v);
 				}
 			}
 			break;
@@ -455,7 +512,7 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 
 					minB.z = hull_b->transform->v3.z;
 					maxB.z = hull_b->transform->v3.z;
-					status = a3collisionTestSphereAABB(collision_out, hull_a->transform->v3.v, hull_a->prop[a3hullProperty_radius], minB.v, maxB.v, diff.v);
+					status = a3collisionTestSphereAABB(collision_out, hull_a->transform->v3.v, prop_a[a3hullProperty_radius], minB.v, maxB.v, diff.v);
 				}
 				else
 				{
@@ -473,7 +530,7 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					minB.z = hull_b->transform->v3.z;
 					maxB.z = hull_b->transform->v3.z;
 
-					status = a3collisionTestSphereAABB(collision_out, temp.v, hull_a->prop[a3hullProperty_radius], minB.v, maxB.v, diff.v);
+					status = a3collisionTestSphereAABB(collision_out, temp.v, prop_a[a3hullProperty_radius], minB.v, maxB.v, diff.v);
 				}
 			}
 			break;
@@ -494,14 +551,14 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 				collision_out->hull_b = hull_a;
 				if (hull_b->prop[a3hullFlag_isAxisAligned] == 2)
 				{
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
 
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
 
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 					status = a3collisionTestSphereAABB(collision_out, hull_b->transform->v3.v, hull_b->prop[a3hullProperty_radius], minA.v, maxA.v, diff.v);
 				}
 				else
@@ -511,12 +568,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(temp.v, temp.v, hull_b->transform->m);
 					a3real3Add(temp.v, hull_a->transform->v3.v);
 
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 
 					status = a3collisionTestSphereAABB(collision_out, temp.v, hull_b->prop[a3hullProperty_radius], minA.v, maxA.v, diff.v);
 				}
@@ -528,12 +585,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 				a3vec3 minA, maxA, minB, maxB;
 				if (hull_a->prop[a3hullFlag_isAxisAligned] == 2 && hull_b->prop[a3hullFlag_isAxisAligned] == 2)
 				{
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = hull_b->transform->v3.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = hull_b->transform->v3.x + hull_b->prop[a3hullProperty_halfwidth];			
 					minB.y = hull_b->transform->v3.y - hull_b->prop[a3hullProperty_halfheight];
@@ -550,12 +607,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransA.v, newTransA.v, hull_b->transformInv->m);
 					a3real3Add(newTransA.v, hull_a->transform->v3.v);
 
-					minA.x = newTransA.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = newTransA.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = newTransA.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = newTransA.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = newTransA.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = newTransA.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = newTransA.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = newTransA.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = newTransA.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = newTransA.y + prop_a[a3hullProperty_halfheight];
+					minA.z = newTransA.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = newTransA.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = hull_b->transform->v3.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = hull_b->transform->v3.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = hull_b->transform->v3.y - hull_b->prop[a3hullProperty_halfheight];
@@ -572,12 +629,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransB.v, newTransB.v, hull_a->transformInv->m);
 					a3real3Add(newTransB.v, hull_b->transform->v3.v);
 
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = newTransB.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = newTransB.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = newTransB.y - hull_b->prop[a3hullProperty_halfheight];
@@ -595,12 +652,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransA.v, newTransA.v, hull_b->transformInv->m);
 					a3real3Add(newTransA.v, hull_a->transform->v3.v);
 
-					minA.x = newTransA.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = newTransA.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = newTransA.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = newTransA.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = newTransA.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = newTransA.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = newTransA.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = newTransA.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = newTransA.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = newTransA.y + prop_a[a3hullProperty_halfheight];
+					minA.z = newTransA.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = newTransA.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = hull_b->transform->v3.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = hull_b->transform->v3.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = hull_b->transform->v3.y - hull_b->prop[a3hullProperty_halfheight];
@@ -616,12 +673,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransB.v, newTransB.v, hull_a->transformInv->m);
 					a3real3Add(newTransB.v, hull_b->transform->v3.v);
 
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = newTransB.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = newTransB.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = newTransB.y - hull_b->prop[a3hullProperty_halfheight];
@@ -639,12 +696,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 				a3vec3 minA, maxA, minB, maxB;
 				if (hull_a->prop[a3hullFlag_isAxisAligned] == 2 && hull_b->prop[a3hullFlag_isAxisAligned] == 2)
 				{
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = hull_b->transform->v3.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = hull_b->transform->v3.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = hull_b->transform->v3.y - hull_b->prop[a3hullProperty_halfheight];
@@ -660,12 +717,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransA.v, newTransA.v, hull_b->transformInv->m);
 					a3real3Add(newTransA.v, hull_a->transform->v3.v);
 
-					minA.x = newTransA.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = newTransA.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = newTransA.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = newTransA.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = newTransA.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = newTransA.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = newTransA.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = newTransA.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = newTransA.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = newTransA.y + prop_a[a3hullProperty_halfheight];
+					minA.z = newTransA.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = newTransA.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = hull_b->transform->v3.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = hull_b->transform->v3.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = hull_b->transform->v3.y - hull_b->prop[a3hullProperty_halfheight];
@@ -682,12 +739,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransB.v, newTransB.v, hull_a->transformInv->m);
 					a3real3Add(newTransB.v, hull_b->transform->v3.v);
 
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = newTransB.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = newTransB.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = newTransB.y - hull_b->prop[a3hullProperty_halfheight];
@@ -705,12 +762,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransA.v, newTransA.v, hull_b->transformInv->m);
 					a3real3Add(newTransA.v, hull_a->transform->v3.v);
 
-					minA.x = newTransA.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = newTransA.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = newTransA.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = newTransA.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = newTransA.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = newTransA.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = newTransA.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = newTransA.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = newTransA.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = newTransA.y + prop_a[a3hullProperty_halfheight];
+					minA.z = newTransA.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = newTransA.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = hull_b->transform->v3.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = hull_b->transform->v3.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = hull_b->transform->v3.y - hull_b->prop[a3hullProperty_halfheight];
@@ -726,12 +783,12 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 					a3real4ProductTransform(newTransB.v, newTransB.v, hull_a->transformInv->m);
 					a3real3Add(newTransB.v, hull_b->transform->v3.v);
 
-					minA.x = hull_a->transform->v3.x - hull_a->prop[a3hullProperty_halfwidth];
-					maxA.x = hull_a->transform->v3.x + hull_a->prop[a3hullProperty_halfwidth];
-					minA.y = hull_a->transform->v3.y - hull_a->prop[a3hullProperty_halfheight];
-					maxA.y = hull_a->transform->v3.y + hull_a->prop[a3hullProperty_halfheight];
-					minA.z = hull_a->transform->v3.z - hull_a->prop[a3hullProperty_halfdepth];
-					maxA.z = hull_a->transform->v3.z + hull_a->prop[a3hullProperty_halfdepth];
+					minA.x = hull_a->transform->v3.x - prop_a[a3hullProperty_halfwidth];
+					maxA.x = hull_a->transform->v3.x + prop_a[a3hullProperty_halfwidth];
+					minA.y = hull_a->transform->v3.y - prop_a[a3hullProperty_halfheight];
+					maxA.y = hull_a->transform->v3.y + prop_a[a3hullProperty_halfheight];
+					minA.z = hull_a->transform->v3.z - prop_a[a3hullProperty_halfdepth];
+					maxA.z = hull_a->transform->v3.z + prop_a[a3hullProperty_halfdepth];
 					minB.x = newTransB.x - hull_b->prop[a3hullProperty_halfwidth];
 					maxB.x = newTransB.x + hull_b->prop[a3hullProperty_halfwidth];
 					minB.y = newTransB.y - hull_b->prop[a3hullProperty_halfheight];
@@ -756,6 +813,9 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 		{
 			collision_out->hull_a = hull_a;
 			collision_out->hull_b = hull_b;
+
+			// negative depth is separation within the margin
+			collision_out->penetration[0] -= margin;
 		}
 
 		return status;
@@ -763,5 +823,81 @@ extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_o
 	return -1;
 }
 
+// high-level collision test
+extern inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_out, const a3_ConvexHull *hull_a, const a3_ConvexHull *hull_b)
+{
+	return a3collisionTestConvexHullsSpeculative(collision_out, hull_a, hull_b, a3realZero);
+}
+
+// continuous collision: sweep a moving sphere against a hull
+extern inline int a3collisionSweepSphere(a3real *toi_out, a3real3p normal_out, const a3real3p sphereStart, const a3real3p sphereEnd, const a3real sphereRadius, const a3_ConvexHull *hull)
+{
+	if (toi_out && normal_out && sphereStart && sphereEnd && hull)
+	{
+		a3real3 motion, diff, p;
+		a3real a, b, c, disc, t, dist, speed;
+		unsigned int i;
+
+		a3real3Diff(motion, sphereEnd, sphereStart);
+		a = a3real3LengthSquared(motion);
+		if (a <= a3realZero)
+			return 0;
+
+		switch (hull->type)
+		{
+		case a3hullType_sphere:
+		{
+			// solve |d + m t| = r_a + r_b for the first root
+			const a3real sumRadii = sphereRadius + hull->prop[a3hullProperty_radius];
+			a3real3Diff(diff, sphereStart, hull->transform->v3.v);
+			b = a3real3Dot(diff, motion);
+			c = a3real3LengthSquared(diff) - sumRadii * sumRadii;
+			disc = b * b - a * c;
+			if (c <= a3realZero || b >= a3realZero || disc < a3realZero)
+				return 0;
+			t = (-b - (a3real)a3sqrt(disc)) / a;
+			if (t > a3realOne)
+				return 0;
+			a3real3Add(a3real3ProductS(normal_out, motion, t), diff);
+			a3real3Normalize(normal_out);
+			*toi_out = t;
+			return 1;
+		}
+		case a3hullType_plane:
+		case a3hullType_box:
+		{
+			// conservative advancement: the sphere cannot close more 
+			//	than its speed, so step by distance over speed until 
+			//	within tolerance
+			const a3real tolerance = sphereRadius * (a3real)(0.01);
+			speed = (a3real)a3sqrt(a);
+			t = a3realZero;
+			for (i = 0; i < a3hullSweep_maxIterations; ++i)
+			{
+				a3real3Add(a3real3ProductS(p, motion, t), sphereStart);
+				dist = a3collisionDistanceSphereHull_internal(normal_out, p, sphereRadius, hull);
+				if (dist <= tolerance)
+				{
+					// overlapping at the start is left to discrete tests, 
+					//	and touching while separating is no impact
+					if ((i == 0 && dist <= a3realZero) || a3real3Dot(motion, normal_out) >= a3realZero)
+						return 0;
+					*toi_out = t;
+					return 1;
+				}
+				t += dist / speed;
+				if (t > a3realOne)
+					return 0;
+			}
+			return 0;
+		}
+		default:
+			break;
+		}
+		return 0;
+	}
+	return -1;
+}
+
 
 //-----------------------------------------------------------------------------
@@ -60,6 +60,8 @@ extern "C"
 		a3hullProperty_maxCount_user = 0,
 
 		a3hullContact_maxCount = 8,
+
+		a3hullSweep_maxIterations = 32,
 	};
 
 	// generic convex hull types
@@ -134,6 +136,10 @@ extern "C"
 		a3vec3 contact_a[a3hullContact_maxCount], contact_b[a3hullContact_maxCount];
 		a3vec3 normal_a[a3hullContact_maxCount], normal_b[a3hullContact_maxCount];
 		unsigned int contactCount_a, contactCount_b;
+
+		// penetration depth per contact (positive when overlapping, 
+		//	negative for speculative contacts that are still apart)
+		a3real penetration[a3hullContact_maxCount];
 	};
 
 
@@ -162,6 +168,19 @@ extern "C"
 
 	// high-level collision test
 	inline int a3collisionTestConvexHulls(a3_ConvexHullCollision *collision_out, const a3_ConvexHull *hull_a, const a3_ConvexHull *hull_b);
+
+	// high-level collision test with speculative margin
+	//	- hulls closer than the margin also collide, reporting negative 
+	//		penetration (separation) so a solver can limit approach speed
+	inline int a3collisionTestConvexHullsSpeculative(a3_ConvexHullCollision *collision_out, const a3_ConvexHull *hull_a, const a3_ConvexHull *hull_b, const a3real margin);
+
+	// continuous collision: sweep a moving sphere against a hull
+	//	- returns 1 with time of impact (fraction of the motion) and 
+	//		hull normal at impact, 0 if the motion is clear or the 
+	//		sphere already overlaps at the start (discrete tests cover it)
+	//	- spheres are solved analytically, planes and boxes by 
+	//		conservative advancement
+	inline int a3collisionSweepSphere(a3real *toi_out, a3real3p normal_out, const a3real3p sphereStart, const a3real3p sphereEnd, const a3real sphereRadius, const a3_ConvexHull *hull);
 	
 
 //-----------------------------------------------------------------------------
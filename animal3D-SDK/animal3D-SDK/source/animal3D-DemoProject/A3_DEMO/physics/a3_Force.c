@@ -130,6 +130,13 @@ extern inline a3real3r a3forceSpring(a3real3p f_out, const a3real3p particlePosi
 	//	- calculate displacement (vector from anchor to position)
 	//	- calculate tension using Hooke's law: F = -k(L - L0)
 	//	- apply tension in direction of anchor
+	a3real length;
+	a3real3Diff(f_out, particlePosition, anchorPosition);
+	length = a3real3Length(f_out);
+	if (length > a3realZero)
+		a3real3MulS(f_out, -springCoeff * (length - restingLength) / length);
+	else
+		a3real3Set(f_out, a3realZero, a3realZero, a3realZero);
 
 	return f_out;
 }
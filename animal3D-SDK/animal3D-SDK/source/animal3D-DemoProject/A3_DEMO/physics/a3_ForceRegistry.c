@@ -0,0 +1,297 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ForceRegistry.c/.cpp
+	Implementation of force registry.
+*/
+
+#include "a3_ForceRegistry.h"
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper to claim a generator slot
+a3_ForceGenerator *a3forceRegistryAdd_internal(a3_ForceRegistry *registry, const a3_ForceGeneratorType type)
+{
+	a3_ForceGenerator *generator;
+	if (registry && registry->generatorCount < a3forceMaxCount_generator)
+	{
+		generator = registry->generator + registry->generatorCount++;
+		generator->type = type;
+		a3real3Set(generator->vector.v, a3realZero, a3realZero, a3realZero);
+		generator->field = 0;
+		generator->coeff[0] = generator->coeff[1] = generator->coeff[2] = a3realZero;
+		generator->enabled = 1;
+		generator->bodyCount = 0;
+		return generator;
+	}
+	return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// batched kernels: n gathered bodies at a time, flat loops over arrays
+
+// F = m g
+void a3forceBatchGravity_internal(a3_ForceRegistry *registry, const a3_ForceGenerator *generator, const unsigned int n)
+{
+	unsigned int c, i;
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < n; ++i)
+			registry->force[c][i] = registry->mass[i] * generator->vector.v[c];
+}
+
+// F = (p |u| u A C) / 2, u = flow - v
+void a3forceBatchDrag_internal(a3_ForceRegistry *registry, const a3_ForceGenerator *generator, const unsigned int n)
+{
+	const a3real halfDensity = a3realHalf * generator->coeff[0];
+	a3real u[3][a3forceMaxCount_body], speed[a3forceMaxCount_body];
+	unsigned int c, i;
+
+	// flow: sampled from the field in one pass, or uniform
+	if (generator->field)
+		a3windFieldSampleBatch(generator->field, *registry->flow, a3forceMaxCount_body, *registry->position, a3forceMaxCount_body, n);
+	else
+		for (c = 0; c < 3; ++c)
+			for (i = 0; i < n; ++i)
+				registry->flow[c][i] = generator->vector.v[c];
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < n; ++i)
+			u[c][i] = registry->flow[c][i] - registry->velocity[c][i];
+	for (i = 0; i < n; ++i)
+		speed[i] = (a3real)a3sqrt(u[0][i] * u[0][i] + u[1][i] * u[1][i] + u[2][i] * u[2][i]) * halfDensity * registry->coeff[i];
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < n; ++i)
+			registry->force[c][i] = u[c][i] * speed[i];
+}
+
+// F = -(k (L - L0) + c (v . d)) d, d = unit(x - anchor)
+void a3forceBatchSpring_internal(a3_ForceRegistry *registry, const a3_ForceGenerator *generator, const unsigned int n)
+{
+	a3real d[3][a3forceMaxCount_body], length, lengthInv[a3forceMaxCount_body], tension[a3forceMaxCount_body];
+	unsigned int c, i;
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < n; ++i)
+			d[c][i] = registry->position[c][i] - generator->vector.v[c];
+	for (i = 0; i < n; ++i)
+	{
+		length = (a3real)a3sqrt(d[0][i] * d[0][i] + d[1][i] * d[1][i] + d[2][i] * d[2][i]);
+		lengthInv[i] = length > a3realZero ? a3recip(length) : a3realZero;
+		tension[i] = generator->coeff[1] * (length - generator->coeff[0]);
+		tension[i] += generator->coeff[2] * (d[0][i] * registry->velocity[0][i] + d[1][i] * registry->velocity[1][i] + d[2][i] * registry->velocity[2][i]) * lengthInv[i];
+		tension[i] *= lengthInv[i] * registry->coeff[i];
+	}
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < n; ++i)
+			registry->force[c][i] = -d[c][i] * tension[i];
+}
+
+// F = G M m d / (|d|^2 + e^2)^(3/2), d = center - x (softened so 
+//	it stays finite at the center)
+void a3forceBatchAttractor_internal(a3_ForceRegistry *registry, const a3_ForceGenerator *generator, const unsigned int n)
+{
+	const a3real softeningSq = generator->coeff[1] * generator->coeff[1];
+	a3real d[3][a3forceMaxCount_body], scale[a3forceMaxCount_body];
+	unsigned int c, i;
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < n; ++i)
+			d[c][i] = generator->vector.v[c] - registry->position[c][i];
+	for (i = 0; i < n; ++i)
+	{
+		scale[i] = d[0][i] * d[0][i] + d[1][i] * d[1][i] + d[2][i] * d[2][i] + softeningSq;
+		scale[i] = scale[i] > a3realZero ? a3recip(scale[i] * (a3real)a3sqrt(scale[i])) : a3realZero;
+		scale[i] *= generator->coeff[0] * registry->mass[i] * registry->coeff[i];
+	}
+	for (c = 0; c < 3; ++c)
+		for (i = 0; i < n; ++i)
+			registry->force[c][i] = d[c][i] * scale[i];
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3forceRegistryReset(a3_ForceRegistry *registry)
+{
+	if (registry)
+	{
+		registry->generatorCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryAddGravity(a3_ForceRegistry *registry, const a3real3p acceleration)
+{
+	a3_ForceGenerator *generator = acceleration ? a3forceRegistryAdd_internal(registry, a3forceGenerator_gravity) : 0;
+	if (generator)
+	{
+		a3real3SetReal3(generator->vector.v, acceleration);
+		return (int)(generator - registry->generator);
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryAddDrag(a3_ForceRegistry *registry, const a3real fluidDensity)
+{
+	a3_ForceGenerator *generator = a3forceRegistryAdd_internal(registry, a3forceGenerator_drag);
+	if (generator)
+	{
+		generator->coeff[0] = fluidDensity;
+		return (int)(generator - registry->generator);
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryAddWind(a3_ForceRegistry *registry, const a3real3p flowVelocity, const a3real fluidDensity)
+{
+	a3_ForceGenerator *generator = flowVelocity ? a3forceRegistryAdd_internal(registry, a3forceGenerator_wind) : 0;
+	if (generator)
+	{
+		a3real3SetReal3(generator->vector.v, flowVelocity);
+		generator->coeff[0] = fluidDensity;
+		return (int)(generator - registry->generator);
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryAddWindField(a3_ForceRegistry *registry, const a3_WindField *field, const a3real fluidDensity)
+{
+	a3_ForceGenerator *generator = field ? a3forceRegistryAdd_internal(registry, a3forceGenerator_wind) : 0;
+	if (generator)
+	{
+		generator->field = field;
+		generator->coeff[0] = fluidDensity;
+		return (int)(generator - registry->generator);
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryAddSpring(a3_ForceRegistry *registry, const a3real3p anchor, const a3real restingLength, const a3real springCoeff, const a3real dampingCoeff)
+{
+	a3_ForceGenerator *generator = anchor ? a3forceRegistryAdd_internal(registry, a3forceGenerator_spring) : 0;
+	if (generator)
+	{
+		a3real3SetReal3(generator->vector.v, anchor);
+		generator->coeff[0] = restingLength;
+		generator->coeff[1] = springCoeff;
+		generator->coeff[2] = dampingCoeff;
+		return (int)(generator - registry->generator);
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryAddAttractor(a3_ForceRegistry *registry, const a3real3p center, const a3real strength, const a3real softening)
+{
+	a3_ForceGenerator *generator = center ? a3forceRegistryAdd_internal(registry, a3forceGenerator_attractor) : 0;
+	if (generator)
+	{
+		a3real3SetReal3(generator->vector.v, center);
+		generator->coeff[0] = strength;
+		generator->coeff[1] = softening;
+		return (int)(generator - registry->generator);
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryAttach(a3_ForceRegistry *registry, const unsigned int generator, const unsigned int body, const a3real bodyCoeff)
+{
+	a3_ForceGenerator *g;
+	if (registry && generator < registry->generatorCount)
+	{
+		g = registry->generator + generator;
+		if (g->bodyCount < a3forceMaxCount_body)
+		{
+			g->body[g->bodyCount] = body;
+			g->bodyCoeff[g->bodyCount] = bodyCoeff;
+			return g->bodyCount++;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3forceRegistryApply(a3_ForceRegistry *registry, a3_RigidBody *bodies, const unsigned int bodyCount)
+{
+	const a3_ForceGenerator *generator;
+	a3_RigidBody *rb;
+	unsigned int g, i, n, c;
+	if (registry && bodies)
+	{
+		for (g = 0, generator = registry->generator; g < registry->generatorCount; ++g, ++generator)
+		{
+			if (!generator->enabled)
+				continue;
+
+			// gather
+			for (i = 0, n = 0; i < generator->bodyCount; ++i)
+			{
+				if (generator->body[i] >= bodyCount)
+					continue;
+				rb = bodies + generator->body[i];
+				if (rb->sleeping || rb->massInv <= a3realZero)
+					continue;
+				registry->index[n] = generator->body[i];
+				for (c = 0; c < 3; ++c)
+				{
+					registry->position[c][n] = rb->position.v[c];
+					registry->velocity[c][n] = rb->velocity.v[c];
+				}
+				registry->mass[n] = rb->mass;
+				registry->coeff[n] = generator->bodyCoeff[i];
+				++n;
+			}
+			if (!n)
+				continue;
+
+			// evaluate
+			switch (generator->type)
+			{
+			case a3forceGenerator_gravity:
+				a3forceBatchGravity_internal(registry, generator, n);
+				break;
+			case a3forceGenerator_drag:
+			case a3forceGenerator_wind:
+				a3forceBatchDrag_internal(registry, generator, n);
+				break;
+			case a3forceGenerator_spring:
+				a3forceBatchSpring_internal(registry, generator, n);
+				break;
+			case a3forceGenerator_attractor:
+				a3forceBatchAttractor_internal(registry, generator, n);
+				break;
+			default:
+				continue;
+			}
+
+			// scatter
+			for (i = 0; i < n; ++i)
+			{
+				rb = bodies + registry->index[i];
+				for (c = 0; c < 3; ++c)
+					rb->force.v[c] += registry->force[c][i];
+			}
+		}
+		return registry->generatorCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
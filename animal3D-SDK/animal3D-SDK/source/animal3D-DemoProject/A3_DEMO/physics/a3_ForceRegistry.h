@@ -0,0 +1,141 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ForceRegistry.h
+	Registry of force generators applied to rigid bodies in batches.
+*/
+
+#ifndef __ANIMAL3D_FORCEREGISTRY_H
+#define __ANIMAL3D_FORCEREGISTRY_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_RigidBody.h"
+#include "a3_WindField.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_ForceGenerator		a3_ForceGenerator;
+	typedef struct a3_ForceRegistry			a3_ForceRegistry;
+	typedef enum a3_ForceGeneratorType		a3_ForceGeneratorType;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// counters
+	enum a3_ForceRegistryMaxCount
+	{
+		a3forceMaxCount_generator = 16,
+		a3forceMaxCount_body = 32,
+	};
+
+	// generator types and what their parameters mean
+	enum a3_ForceGeneratorType
+	{
+		a3forceGenerator_gravity,	// vector: acceleration
+		a3forceGenerator_drag,		// coeff[0]: fluid density (still fluid)
+		a3forceGenerator_wind,		// vector (or field): flow velocity; coeff[0]: fluid density
+		a3forceGenerator_spring,	// vector: anchor; coeff: rest length, stiffness, damping
+		a3forceGenerator_attractor,	// vector: center; coeff: strength (G M), softening length
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// force generator and the bodies it affects
+	//	- bodyCoeff scales the force per body: area times drag 
+	//		coefficient for drag and wind, 1 otherwise
+	//	- wind with a field samples its flow at each body instead of 
+	//		using vector
+	struct a3_ForceGenerator
+	{
+		a3_ForceGeneratorType type;
+		a3vec3 vector;
+		const a3_WindField *field;
+		a3real coeff[3];
+		int enabled;
+
+		unsigned int body[a3forceMaxCount_body];
+		a3real bodyCoeff[a3forceMaxCount_body];
+		unsigned int bodyCount;
+	};
+
+	// registry of generators
+	//	- each generator gathers its awake bodies' state into flat 
+	//		arrays, evaluates the force for all of them in one pass 
+	//		and scatters the results into the bodies' accumulators, 
+	//		so adding a force never touches the update loop and a 
+	//		body costs no call of its own
+	struct a3_ForceRegistry
+	{
+		a3_ForceGenerator generator[a3forceMaxCount_generator];
+		unsigned int generatorCount;
+
+		// gathered state (structure of arrays) and forces
+		unsigned int index[a3forceMaxCount_body];
+		a3real position[3][a3forceMaxCount_body];
+		a3real velocity[3][a3forceMaxCount_body];
+		a3real mass[a3forceMaxCount_body];
+		a3real coeff[a3forceMaxCount_body];
+		a3real flow[3][a3forceMaxCount_body];
+		a3real force[3][a3forceMaxCount_body];
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// remove all generators
+	inline int a3forceRegistryReset(a3_ForceRegistry *registry);
+
+	// add generators; each returns its index or -1 if full
+	inline int a3forceRegistryAddGravity(a3_ForceRegistry *registry, const a3real3p acceleration);
+	inline int a3forceRegistryAddDrag(a3_ForceRegistry *registry, const a3real fluidDensity);
+	inline int a3forceRegistryAddWind(a3_ForceRegistry *registry, const a3real3p flowVelocity, const a3real fluidDensity);
+	inline int a3forceRegistryAddWindField(a3_ForceRegistry *registry, const a3_WindField *field, const a3real fluidDensity);
+	inline int a3forceRegistryAddSpring(a3_ForceRegistry *registry, const a3real3p anchor, const a3real restingLength, const a3real springCoeff, const a3real dampingCoeff);
+	inline int a3forceRegistryAddAttractor(a3_ForceRegistry *registry, const a3real3p center, const a3real strength, const a3real softening);
+
+	// add a body (by index into the array given to apply) to a 
+	//	generator with its coefficient; returns its slot or -1 if full
+	inline int a3forceRegistryAttach(a3_ForceRegistry *registry, const unsigned int generator, const unsigned int body, const a3real bodyCoeff);
+
+	// add every enabled generator's force to its bodies' force 
+	//	accumulators (sleeping and static bodies are skipped, so 
+	//	resting weight does not wake a body)
+	inline int a3forceRegistryApply(a3_ForceRegistry *registry, a3_RigidBody *bodies, const unsigned int bodyCount);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_FORCEREGISTRY_H
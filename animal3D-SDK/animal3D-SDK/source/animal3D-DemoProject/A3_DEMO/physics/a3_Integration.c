@@ -24,8 +24,200 @@
 
 #include "a3_Integration.h"
 
+// AVX2 kernels for single-precision reals
+#if (defined __AVX2__ && !defined A3_REAL_F64)
+#include <immintrin.h>
+#define A3_INTEGRATION_AVX2
+#endif	// __AVX2__
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper: y_out = y + dy * s
+inline void a3functionStep_internal(a3real *y_out, const a3real *y, const a3real *dy, const a3real s, const unsigned int count)
+{
+	unsigned int i;
+	for (i = 0; i < count; ++i)
+		y_out[i] = y[i] + dy[i] * s;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// bulk Euler kernels
+//	- plain loops over flat arrays so the compiler can vectorize them
+
+extern inline void a3integrateEulerExplicit(a3real *x, a3real *v, const a3real *a, const unsigned int count, const a3real dt)
+{
+	unsigned int i;
+	for (i = 0; i < count; ++i)
+	{
+		//	x(t+dt) = x(t) + v(t)dt
+		x[i] += v[i] * dt;
+
+		//	v(t+dt) = v(t) + a(t)dt
+		v[i] += a[i] * dt;
+	}
+}
+
+extern inline void a3integrateEulerSemiImplicit(a3real *x, a3real *v, const a3real *a, const unsigned int count, const a3real dt)
+{
+	unsigned int i = 0;
+#ifdef A3_INTEGRATION_AVX2
+	// eight at a time; the scalar loop finishes the remainder
+	const __m256 dt8 = _mm256_set1_ps(dt);
+	__m256 x8, v8;
+	for (; i + 8 <= count; i += 8)
+	{
+		v8 = _mm256_add_ps(_mm256_loadu_ps(v + i), _mm256_mul_ps(_mm256_loadu_ps(a + i), dt8));
+		x8 = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(v8, dt8));
+		_mm256_storeu_ps(v + i, v8);
+		_mm256_storeu_ps(x + i, x8);
+	}
+#endif	// A3_INTEGRATION_AVX2
+	for (; i < count; ++i)
+	{
+		//	v(t+dt) = v(t) + a(t)dt
+		v[i] += a[i] * dt;
+
+		//	x(t+dt) = x(t) + v(t+dt)dt
+		x[i] += v[i] * dt;
+	}
+}
+
+extern inline void a3integrateEulerKinematic(a3real *x, a3real *v, const a3real *a, const unsigned int count, const a3real dt)
+{
+	const a3real dt2 = a3realHalf * dt * dt;
+	unsigned int i;
+	for (i = 0; i < count; ++i)
+	{
+		//	x(t+dt) = x(t) + v(t)dt + a(t)dt2 / 2
+		x[i] += v[i] * dt + a[i] * dt2;
+
+		//	v(t+dt) = v(t) + a(t)dt
+		v[i] += a[i] * dt;
+	}
+}
+
 
 //-----------------------------------------------------------------------------
 
+// create function
+extern inline int a3functionCreate(a3_Function *f_out, a3real *value, const unsigned int count, a3_FunctionDerivative derivative, void *user, a3real *scratch, const unsigned int scratchCount)
+{
+	if (f_out && value && count && derivative)
+	{
+		f_out->value = value;
+		f_out->count = count;
+		f_out->derivative = derivative;
+		f_out->user = user;
+		f_out->scratch = scratch;
+		f_out->scratchCount = scratch ? scratchCount : 0;
+		f_out->t = a3realZero;
+		return count;
+	}
+	return -1;
+}
+
+// evaluate derivative
+extern inline int a3functionEvaluate(const a3_Function *f, a3real *dvalue_out, const a3real *value, const a3real t)
+{
+	if (f && dvalue_out && value)
+	{
+		f->derivative(dvalue_out, value, t, f->count, f->user);
+		return f->count;
+	}
+	return -1;
+}
+
+// explicit Euler
+extern inline int a3functionIntegrateEulerExplicit(a3_Function *f, const a3real dt)
+{
+	if (f && f->scratchCount >= a3functionScratch_euler)
+	{
+		//	y(t+dt) = y(t) + f(t, y)dt
+		a3real *const k = f->scratch;
+		f->derivative(k, f->value, f->t, f->count, f->user);
+		a3functionStep_internal(f->value, f->value, k, dt, f->count);
+		f->t += dt;
+		return f->count;
+	}
+	return -1;
+}
+
+// classic RK4
+extern inline int a3functionIntegrateRK4(a3_Function *f, const a3real dt)
+{
+	if (f && f->scratchCount >= a3functionScratch_rk4)
+	{
+		const unsigned int n = f->count;
+		const a3real dtHalf = a3realHalf * dt, dtSixth = dt / (a3real)(6);
+		a3real *const k1 = f->scratch, *const k2 = k1 + n, *const k3 = k2 + n, *const k4 = k3 + n, *const y = k4 + n;
+		unsigned int i;
+
+		//	k1 = f(t, y)
+		//	k2 = f(t + dt/2, y + k1 dt/2)
+		//	k3 = f(t + dt/2, y + k2 dt/2)
+		//	k4 = f(t + dt, y + k3 dt)
+		f->derivative(k1, f->value, f->t, n, f->user);
+		a3functionStep_internal(y, f->value, k1, dtHalf, n);
+		f->derivative(k2, y, f->t + dtHalf, n, f->user);
+		a3functionStep_internal(y, f->value, k2, dtHalf, n);
+		f->derivative(k3, y, f->t + dtHalf, n, f->user);
+		a3functionStep_internal(y, f->value, k3, dt, n);
+		f->derivative(k4, y, f->t + dt, n, f->user);
+
+		//	y(t+dt) = y(t) + (k1 + 2k2 + 2k3 + k4)dt/6
+		for (i = 0; i < n; ++i)
+			f->value[i] += (k1[i] + (k2[i] + k3[i]) * a3realTwo + k4[i]) * dtSixth;
+		f->t += dt;
+		return n;
+	}
+	return -1;
+}
+
+// semi-implicit Euler
+extern inline int a3functionIntegrateEulerSemiImplicit(a3_Function *f, const a3real dt)
+{
+	if (f && f->scratchCount >= a3functionScratch_euler && !(f->count & 1))
+	{
+		const unsigned int n = f->count / 2;
+		a3real *const k = f->scratch;
+
+		// [v | a] from current state
+		f->derivative(k, f->value, f->t, f->count, f->user);
+		a3integrateEulerSemiImplicit(f->value, f->value + n, k + n, n, dt);
+		f->t += dt;
+		return f->count;
+	}
+	return -1;
+}
+
+// velocity Verlet
+extern inline int a3functionIntegrateVelocityVerlet(a3_Function *f, const a3real dt)
+{
+	if (f && f->scratchCount >= a3functionScratch_verlet && !(f->count & 1))
+	{
+		const unsigned int n = f->count / 2;
+		a3real *const k0 = f->scratch, *const k1 = k0 + f->count;
+		a3real *const x = f->value, *const v = f->value + n;
+		const a3real *const a0 = k0 + n, *const a1 = k1 + n;
+		unsigned int i;
+
+		//	x(t+dt) = x(t) + v(t)dt + a(t)dt2 / 2
+		f->derivative(k0, f->value, f->t, f->count, f->user);
+		for (i = 0; i < n; ++i)
+			x[i] += (v[i] + a0[i] * a3realHalf * dt) * dt;
+
+		//	v(t+dt) = v(t) + (a(t) + a(t+dt))dt / 2
+		f->derivative(k1, f->value, f->t + dt, f->count, f->user);
+		for (i = 0; i < n; ++i)
+			v[i] += (a0[i] + a1[i]) * a3realHalf * dt;
+		f->t += dt;
+		return f->count;
+	}
+	return -1;
+}
+
 
 //-----------------------------------------------------------------------------
@@ -39,32 +39,82 @@ extern "C"
 {
 #else	// !__cplusplus
 	typedef struct a3_Function		a3_Function;
+	typedef enum a3_FunctionScratch	a3_FunctionScratch;
 #endif	// __cplusplus
 	
 	
 //-----------------------------------------------------------------------------
 
+	// derivative callback: evaluate dy/dt for the whole state at once
+	//	- dvalue_out and value hold 'count' reals each
+	typedef void (*a3_FunctionDerivative)(a3real *dvalue_out, const a3real *value, const a3real t, const unsigned int count, void *user);
+
+	// scratch needed by each integrator, in multiples of the state count
+	enum a3_FunctionScratch
+	{
+		a3functionScratch_euler = 1,
+		a3functionScratch_verlet = 2,
+		a3functionScratch_rk4 = 5,
+	};
+
 
 //-----------------------------------------------------------------------------
 
 	// function
+	//	- state is a flat array of reals (structure of arrays); 
+	//		second-order integrators treat the first half as positions 
+	//		and the second half as velocities, so the derivative of a 
+	//		second-order system is [velocities | accelerations]
 	struct a3_Function
 	{
-		// ****TO-DO: 
-		//	- add value, derivative function and integrator
-		//	- add other utilities
-
 		// y(t): value
 		a3real *value;
+		unsigned int count;
+
+		// dy/dt: derivative callback and its user data
+		a3_FunctionDerivative derivative;
+		void *user;
+
+		// caller-owned scratch: scratchCount multiples of count
+		a3real *scratch;
+		unsigned int scratchCount;
+
+		// current time
+		a3real t;
 	};
 
 
 //-----------------------------------------------------------------------------
 
 	// integration evaluators and helpers
-	// ****TO-DO: 
-	//	- implement some basic example integration methods
-	//	- implement utilities to help with more advanced methods
+
+	// bulk Euler kernels over arrays of 'count' reals 
+	//	(pass 3 * n for n vectors)
+	//	explicit: integrate current velocity
+	inline void a3integrateEulerExplicit(a3real *x, a3real *v, const a3real *a, const unsigned int count, const a3real dt);
+	//	semi-implicit: integrate next velocity
+	inline void a3integrateEulerSemiImplicit(a3real *x, a3real *v, const a3real *a, const unsigned int count, const a3real dt);
+	//	kinematic: integrate average of current and next velocities
+	inline void a3integrateEulerKinematic(a3real *x, a3real *v, const a3real *a, const unsigned int count, const a3real dt);
+
+
+	// create function over caller-owned value and scratch arrays
+	inline int a3functionCreate(a3_Function *f_out, a3real *value, const unsigned int count, a3_FunctionDerivative derivative, void *user, a3real *scratch, const unsigned int scratchCount);
+
+	// evaluate derivative into out (count reals)
+	inline int a3functionEvaluate(const a3_Function *f, a3real *dvalue_out, const a3real *value, const a3real t);
+
+	// first-order integrators: y' = f(t, y)
+	//	explicit Euler
+	inline int a3functionIntegrateEulerExplicit(a3_Function *f, const a3real dt);
+	//	classic fourth-order Runge-Kutta
+	inline int a3functionIntegrateRK4(a3_Function *f, const a3real dt);
+
+	// second-order integrators: state is [x | v], derivative is [v | a]
+	//	semi-implicit (symplectic) Euler
+	inline int a3functionIntegrateEulerSemiImplicit(a3_Function *f, const a3real dt);
+	//	velocity Verlet
+	inline int a3functionIntegrateVelocityVerlet(a3_Function *f, const a3real dt);
 
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,513 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_JobSystem.c/.cpp
+	Implementation of job system.
+*/
+
+#include "a3_JobSystem.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+// platform: atomics, pausing and the semaphore sleeping workers wait on
+
+#ifdef _WIN32
+#include <Windows.h>
+
+// worker running on this thread (null off the pool)
+__declspec(thread) a3_JobWorker *a3jobWorkerCurrent_internal;
+
+long a3jobIncrement_internal(volatile long *value)
+{
+	return InterlockedIncrement(value);
+}
+
+long a3jobDecrement_internal(volatile long *value)
+{
+	return InterlockedDecrement(value);
+}
+
+long a3jobCompareExchange_internal(volatile long *value, const long exchange, const long comparand)
+{
+	return InterlockedCompareExchange(value, exchange, comparand);
+}
+
+void a3jobBarrier_internal()
+{
+	MemoryBarrier();
+}
+
+void a3jobPause_internal()
+{
+	YieldProcessor();
+}
+
+void a3jobYield_internal()
+{
+	SwitchToThread();
+}
+
+void *a3jobWakeCreate_internal()
+{
+	return CreateSemaphore(0, 0, 0x7fffffff, 0);
+}
+
+void a3jobWakeRelease_internal(void *wake)
+{
+	CloseHandle(wake);
+}
+
+void a3jobWakeSignal_internal(void *wake, const long count)
+{
+	ReleaseSemaphore(wake, count, 0);
+}
+
+void a3jobWakeWait_internal(void *wake)
+{
+	WaitForSingleObject(wake, INFINITE);
+}
+
+unsigned int a3jobCoreCount_internal()
+{
+	SYSTEM_INFO info[1];
+	GetSystemInfo(info);
+	return info->dwNumberOfProcessors;
+}
+
+#else	// !_WIN32
+#include <errno.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+// worker running on this thread (null off the pool)
+__thread a3_JobWorker *a3jobWorkerCurrent_internal;
+
+long a3jobIncrement_internal(volatile long *value)
+{
+	return __sync_add_and_fetch(value, 1);
+}
+
+long a3jobDecrement_internal(volatile long *value)
+{
+	return __sync_sub_and_fetch(value, 1);
+}
+
+long a3jobCompareExchange_internal(volatile long *value, const long exchange, const long comparand)
+{
+	return __sync_val_compare_and_swap(value, comparand, exchange);
+}
+
+void a3jobBarrier_internal()
+{
+	__sync_synchronize();
+}
+
+void a3jobPause_internal()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#endif	// x86
+}
+
+void a3jobYield_internal()
+{
+	sched_yield();
+}
+
+void *a3jobWakeCreate_internal()
+{
+	sem_t *wake = (sem_t *)malloc(sizeof(sem_t));
+	if (wake && sem_init(wake, 0, 0))
+	{
+		free(wake);
+		wake = 0;
+	}
+	return wake;
+}
+
+void a3jobWakeRelease_internal(void *wake)
+{
+	sem_destroy((sem_t *)wake);
+	free(wake);
+}
+
+void a3jobWakeSignal_internal(void *wake, const long count)
+{
+	long i;
+	for (i = 0; i < count; ++i)
+		sem_post((sem_t *)wake);
+}
+
+void a3jobWakeWait_internal(void *wake)
+{
+	while (sem_wait((sem_t *)wake) && errno == EINTR);
+}
+
+unsigned int a3jobCoreCount_internal()
+{
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (unsigned int)count : 1;
+}
+
+#endif	// _WIN32
+
+
+//-----------------------------------------------------------------------------
+
+// idle worker: pause this many times, then yield this many, then sleep
+enum a3_JobIdle
+{
+	a3jobIdle_spin = 256,
+	a3jobIdle_yield = 64,
+};
+
+
+// internal utility to push onto the bottom of the worker's own queue
+//	- the job is written before bottom moves past it, so a thief 
+//		that sees the new bottom sees the job
+int a3jobQueuePush_internal(a3_JobQueue *queue, const a3_Job *job)
+{
+	const long bottom = queue->bottom, top = queue->top;
+	if (bottom - top < a3jobMaxCount_queue)
+	{
+		queue->job[bottom & (a3jobMaxCount_queue - 1)] = *job;
+		a3jobBarrier_internal();
+		queue->bottom = bottom + 1;
+		return 1;
+	}
+	return 0;
+}
+
+// internal utility to pop from the bottom of the worker's own queue
+//	- bottom is claimed before top is read; only the last job can 
+//		also be wanted by a thief, so only it is raced for on top
+int a3jobQueuePop_internal(a3_JobQueue *queue, a3_Job *job_out)
+{
+	const long bottom = queue->bottom - 1;
+	long top;
+	int taken = 1;
+	queue->bottom = bottom;
+	a3jobBarrier_internal();
+	top = queue->top;
+	if (top <= bottom)
+	{
+		*job_out = queue->job[bottom & (a3jobMaxCount_queue - 1)];
+		if (top == bottom)
+		{
+			taken = a3jobCompareExchange_internal(&queue->top, top + 1, top) == top;
+			queue->bottom = top + 1;
+		}
+		return taken;
+	}
+	queue->bottom = top;
+	return 0;
+}
+
+// internal utility to steal from the top of another worker's queue
+//	- the job is read before top is claimed; if another thread 
+//		claimed it first, the copy is dropped
+int a3jobQueueSteal_internal(a3_JobQueue *queue, a3_Job *job_out)
+{
+	const long top = queue->top;
+	a3jobBarrier_internal();
+	if (top < queue->bottom)
+	{
+		*job_out = queue->job[top & (a3jobMaxCount_queue - 1)];
+		return a3jobCompareExchange_internal(&queue->top, top + 1, top) == top;
+	}
+	return 0;
+}
+
+// internal utility to push onto the shared queue
+int a3jobSharedPush_internal(a3_JobQueue *queue, const a3_Job *job)
+{
+	int pushed = 0;
+	while (a3jobCompareExchange_internal(&queue->lock, 1, 0))
+		a3jobPause_internal();
+	if (queue->bottom - queue->top < a3jobMaxCount_queue)
+	{
+		queue->job[queue->bottom & (a3jobMaxCount_queue - 1)] = *job;
+		++queue->bottom;
+		pushed = 1;
+	}
+	a3jobBarrier_internal();
+	queue->lock = 0;
+	return pushed;
+}
+
+// internal utility to pop the oldest job from the shared queue
+int a3jobSharedPop_internal(a3_JobQueue *queue, a3_Job *job_out)
+{
+	int popped = 0;
+	if (queue->top == queue->bottom)
+		return 0;
+	while (a3jobCompareExchange_internal(&queue->lock, 1, 0))
+		a3jobPause_internal();
+	if (queue->top < queue->bottom)
+	{
+		*job_out = queue->job[queue->top & (a3jobMaxCount_queue - 1)];
+		++queue->top;
+		popped = 1;
+	}
+	a3jobBarrier_internal();
+	queue->lock = 0;
+	return popped;
+}
+
+// internal utility to find a job: the worker's own newest, then the 
+//	shared queue's oldest, then the oldest of another worker's
+//	- thieves start at different workers so they spread out
+int a3jobNext_internal(a3_JobSystem *system, a3_JobWorker *self, a3_Job *job_out)
+{
+	const unsigned int count = system->workerCount;
+	unsigned int i, k;
+	if (self && a3jobQueuePop_internal(self->queue, job_out))
+		return 1;
+	if (a3jobSharedPop_internal(system->shared, job_out))
+		return 1;
+	for (i = 0, k = self ? self->index + 1 : 0; i < count; ++i, ++k)
+		if (a3jobQueueSteal_internal(system->worker[k % count].queue, job_out))
+			return 1;
+	return 0;
+}
+
+// internal utility to queue a job where the calling thread submits 
+//	to: a worker's own queue, or the shared queue from outside
+int a3jobPush_internal(a3_JobSystem *system, const a3_Job *job)
+{
+	a3_JobWorker *const self = a3jobWorkerCurrent_internal;
+	if (system->running && system->workerCount)
+		return (self && self->system == system) ? a3jobQueuePush_internal(self->queue, job) : a3jobSharedPush_internal(system->shared, job);
+	return 0;
+}
+
+// internal utility to wake up to count sleeping workers
+//	- jobs are queued before sleepers are counted and a worker counts 
+//		itself before looking for jobs the last time, so either the 
+//		worker finds the job or the job finds the worker asleep
+void a3jobWake_internal(a3_JobSystem *system, const long count)
+{
+	long sleeping;
+	a3jobBarrier_internal();
+	sleeping = system->sleeping;
+	if (sleeping > 0)
+		a3jobWakeSignal_internal(system->wake, count < sleeping ? count : sleeping);
+}
+
+// internal utility to run a job and count it done
+void a3jobRun_internal(const a3_Job *job)
+{
+	job->func(job->args, job->begin, job->end);
+	if (job->counter)
+		a3jobDecrement_internal(&job->counter->pending);
+}
+
+// internal worker thread
+long a3jobWorkerThread_internal(a3_JobWorker *worker)
+{
+	a3_JobSystem *const system = worker->system;
+	a3_Job job[1];
+	unsigned int idle = 0;
+
+	a3jobWorkerCurrent_internal = worker;
+	while (system->running)
+	{
+		if (a3jobNext_internal(system, worker, job))
+		{
+			a3jobRun_internal(job);
+			idle = 0;
+		}
+		else if (++idle < a3jobIdle_spin)
+			a3jobPause_internal();
+		else if (idle < a3jobIdle_spin + a3jobIdle_yield)
+			a3jobYield_internal();
+		else
+		{
+			// sleep unless a job came in while counting in
+			a3jobIncrement_internal(&system->sleeping);
+			if (a3jobNext_internal(system, worker, job))
+			{
+				a3jobDecrement_internal(&system->sleeping);
+				a3jobRun_internal(job);
+			}
+			else
+			{
+				if (system->running)
+					a3jobWakeWait_internal(system->wake);
+				a3jobDecrement_internal(&system->sleeping);
+			}
+			idle = 0;
+		}
+	}
+	a3jobWorkerCurrent_internal = 0;
+	return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline unsigned int a3jobCoreCount()
+{
+	return a3jobCoreCount_internal();
+}
+
+extern inline int a3jobSystemCreate(a3_JobSystem *system_out, const unsigned int workerCount)
+{
+	const unsigned int count = workerCount < a3jobMaxCount_worker ? workerCount : a3jobMaxCount_worker;
+	a3_JobWorker *worker;
+	if (system_out && !system_out->running)
+	{
+		memset(system_out, 0, sizeof(a3_JobSystem));
+		system_out->running = 1;
+
+		// workers see the count grow as they launch; each is set up 
+		//	before it is counted
+		if (count)
+			system_out->wake = a3jobWakeCreate_internal();
+		while (system_out->wake && system_out->workerCount < count)
+		{
+			worker = system_out->worker + system_out->workerCount;
+			worker->system = system_out;
+			worker->index = system_out->workerCount;
+			if (a3threadLaunch(worker->thread, (a3_threadfunc)a3jobWorkerThread_internal, worker, "a3jobWorker") <= 0)
+				break;
+			a3jobBarrier_internal();
+			++system_out->workerCount;
+		}
+		return system_out->workerCount;
+	}
+	return -1;
+}
+
+extern inline int a3jobSystemRelease(a3_JobSystem *system)
+{
+	a3_Job job[1];
+	unsigned int i;
+	if (system && system->running)
+	{
+		// every worker waits at most once more after this
+		system->running = 0;
+		a3jobBarrier_internal();
+		if (system->wake)
+			a3jobWakeSignal_internal(system->wake, system->workerCount);
+		for (i = 0; i < system->workerCount; ++i)
+			a3threadWait(system->worker[i].thread);
+
+		// finish anything left behind
+		while (a3jobNext_internal(system, 0, job))
+			a3jobRun_internal(job);
+		if (system->wake)
+			a3jobWakeRelease_internal(system->wake);
+		system->wake = 0;
+		system->workerCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3jobSubmit(a3_JobSystem *system, const a3_JobFunc func, void *args, const unsigned int begin, const unsigned int end, a3_JobCounter *counter)
+{
+	a3_Job job[1];
+	if (func)
+	{
+		job->func = func;
+		job->args = args;
+		job->begin = begin;
+		job->end = end;
+		job->counter = counter;
+		if (counter)
+			a3jobIncrement_internal(&counter->pending);
+		if (system && a3jobPush_internal(system, job))
+		{
+			a3jobWake_internal(system, 1);
+			return 1;
+		}
+		a3jobRun_internal(job);
+		return 0;
+	}
+	return -1;
+}
+
+extern inline int a3jobWait(a3_JobSystem *system, a3_JobCounter *counter)
+{
+	a3_JobWorker *const self = a3jobWorkerCurrent_internal;
+	a3_Job job[1];
+	if (counter)
+	{
+		while (counter->pending > 0)
+		{
+			if (system && a3jobNext_internal(system, (self && self->system == system) ? self : 0, job))
+				a3jobRun_internal(job);
+			else
+				a3jobPause_internal();
+		}
+		a3jobBarrier_internal();
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3jobParallelFor(a3_JobSystem *system, const a3_JobFunc func, void *args, const unsigned int count, const unsigned int grain)
+{
+	a3_JobCounter counter[1] = { 0 };
+	a3_Job job[1];
+	unsigned int threads, chunks, share, i;
+	if (func)
+	{
+		if (!count)
+			return 0;
+
+		// cut into at most a few chunks per thread, each at least 
+		//	grain items, with no empty chunks (one with no workers)
+		threads = system && system->running ? system->workerCount + 1 : 1;
+		chunks = threads > 1 ? count / (grain ? grain : 1) : 1;
+		chunks = chunks < threads * a3jobMaxCount_chunk ? chunks : threads * a3jobMaxCount_chunk;
+		chunks = chunks ? chunks : 1;
+		share = (count + chunks - 1) / chunks;
+		chunks = (count + share - 1) / share;
+
+		// queue the rest, wake workers for them, run the first here
+		job->func = func;
+		job->args = args;
+		job->counter = counter;
+		for (i = 1; i < chunks; ++i)
+		{
+			job->begin = i * share;
+			job->end = i * share + share < count ? i * share + share : count;
+			a3jobIncrement_internal(&counter->pending);
+			if (!a3jobPush_internal(system, job))
+				a3jobRun_internal(job);
+		}
+		if (chunks > 1)
+			a3jobWake_internal(system, chunks - 1);
+		func(args, 0, share < count ? share : count);
+		a3jobWait(system, counter);
+		return chunks;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,168 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_JobSystem.h
+	Persistent worker pool with work-stealing job queues.
+*/
+
+#ifndef __ANIMAL3D_JOBSYSTEM_H
+#define __ANIMAL3D_JOBSYSTEM_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "animal3D/a3utility/a3_Thread.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_Job						a3_Job;
+	typedef struct a3_JobCounter				a3_JobCounter;
+	typedef struct a3_JobQueue					a3_JobQueue;
+	typedef struct a3_JobWorker					a3_JobWorker;
+	typedef struct a3_JobSystem					a3_JobSystem;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_JobSystemLimits
+	{
+		// worker threads a system can run
+		a3jobMaxCount_worker = 32,
+
+		// jobs a queue holds (power of two); a job that does not 
+		//	fit is run by the thread submitting it
+		a3jobMaxCount_queue = 256,
+
+		// most chunks per thread a parallel loop is cut into
+		a3jobMaxCount_chunk = 4,
+	};
+
+	// job function: run over the items [begin, end) of its arguments
+	typedef void(*a3_JobFunc)(void *args, unsigned int begin, unsigned int end);
+
+
+//-----------------------------------------------------------------------------
+
+	// counter of unfinished jobs; waiting on it is how jobs are 
+	//	joined and ordered (zero before first use)
+	struct a3_JobCounter
+	{
+		volatile long pending;
+	};
+
+	// job
+	struct a3_Job
+	{
+		a3_JobFunc func;
+		void *args;
+		unsigned int begin, end;
+		a3_JobCounter *counter;
+	};
+
+	// job queue
+	//	- a worker's own queue is a fixed-size Chase-Lev deque: the 
+	//		owner pushes and pops at the bottom without locking while 
+	//		idle workers steal from the top
+	//	- the shared queue takes jobs from threads outside the pool 
+	//		(physics, demo) in order, under the lock
+	struct a3_JobQueue
+	{
+		volatile long top, bottom;
+		volatile long lock;
+		a3_Job job[a3jobMaxCount_queue];
+	};
+
+	// worker thread and its queue
+	struct a3_JobWorker
+	{
+		a3_JobSystem *system;
+		unsigned int index;
+		a3_Thread thread[1];
+		a3_JobQueue queue[1];
+	};
+
+	// job system
+	//	- workers start once and live until release: each runs jobs 
+	//		from its own queue, then the shared queue, then steals 
+	//		from the others; a worker with nothing to do spins 
+	//		briefly, then yields, then sleeps until jobs arrive
+	//	- a thread waiting on a counter runs jobs instead of idling, 
+	//		so jobs may submit and wait on jobs of their own
+	//	- a system with no workers (or none at all) runs every job 
+	//		on the thread that submits it, so results never depend 
+	//		on the pool
+	struct a3_JobSystem
+	{
+		a3_JobWorker worker[a3jobMaxCount_worker];
+		unsigned int workerCount;
+		a3_JobQueue shared[1];
+
+		// workers asleep and the handle they wait on
+		volatile long sleeping;
+		void *wake;
+
+		// cleared to stop the workers
+		volatile long running;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// number of logical processors
+	inline unsigned int a3jobCoreCount();
+
+	// create system and launch its workers (one per spare core is 
+	//	a3jobCoreCount() - 1; 0 runs every job on its caller)
+	//	- returns the number of workers running
+	inline int a3jobSystemCreate(a3_JobSystem *system_out, const unsigned int workerCount);
+
+	// stop the workers and wait for them (jobs still queued are run)
+	inline int a3jobSystemRelease(a3_JobSystem *system);
+
+	// submit job over [begin, end), counted on the counter
+	//	- returns 1 if queued, 0 if it was run here instead
+	inline int a3jobSubmit(a3_JobSystem *system, const a3_JobFunc func, void *args, const unsigned int begin, const unsigned int end, a3_JobCounter *counter);
+
+	// wait until the counter's jobs are done, running jobs meanwhile
+	inline int a3jobWait(a3_JobSystem *system, a3_JobCounter *counter);
+
+	// run func over [0, count) in chunks of at least grain items 
+	//	spread over the pool, and wait; the caller runs the first chunk
+	//	- returns the number of chunks
+	inline int a3jobParallelFor(a3_JobSystem *system, const a3_JobFunc func, void *args, const unsigned int count, const unsigned int grain);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_JOBSYSTEM_H
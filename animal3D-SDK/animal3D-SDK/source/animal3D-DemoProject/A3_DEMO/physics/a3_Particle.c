@@ -23,6 +23,7 @@
 */
 
 #include "a3_Particle.h"
+#include "a3_Integration.h"
 
 
 //-----------------------------------------------------------------------------
@@ -32,41 +33,30 @@
 // explicit Euler: integrate current velocity
 extern inline void a3particleIntegrateEulerExplicit(a3_Particle *p, const a3real dt)
 {
-	a3vec3 d;
-
 	//	x(t+dt) = x(t) + f(t)dt
 	//					 f(t) = dx/dt = v(t)
 	//	x(t+dt) = x(t) + v(t)dt
-	a3real3Add(p->position.v, a3real3ProductS(d.v, p->velocity.v, dt));
-
 	//	v(t+dt) = v(t) + g(t)dt
 	//					 g(t) = dv/dt = a(t)
 	//	v(t+dt) = v(t) + a(t)dt
-	a3real3Add(p->velocity.v, a3real3ProductS(d.v, p->acceleration.v, dt));
+	//	(same kernel runs in bulk over arrays of particles)
+	a3integrateEulerExplicit(p->position.v, p->velocity.v, p->acceleration.v, 3, dt);
 }
 
 // semi-implicit Euler: integrate next velocity
 extern inline void a3particleIntegrateEulerSemiImplicit(a3_Particle *p, const a3real dt)
 {
-	a3vec3 d;
-
 	//	v(t+dt) = v(t) + a(t)dt
-	a3real3Add(p->velocity.v, a3real3ProductS(d.v, p->acceleration.v, dt));
-
 	//	x(t+dt) = x(t) + v(t+dt)dt
-	a3real3Add(p->position.v, a3real3ProductS(d.v, p->velocity.v, dt));
+	a3integrateEulerSemiImplicit(p->position.v, p->velocity.v, p->acceleration.v, 3, dt);
 }
 
 // kinematic: integrate average of current and next velocities
 extern inline void a3particleIntegrateEulerKinematic(a3_Particle *p, const a3real dt)
 {
-	a3vec3 d;
-
 	//	x(t+dt) = x(t) + v(t)dt + a(t)dt2 / 2
-	a3real3Add(p->position.v, a3real3ProductS(d.v, a3real3Sum(d.v, p->velocity.v, a3real3ProductS(d.v, p->acceleration.v, a3realHalf * dt)), dt));
-
 	//	v(t+dt) = v(t) + a(t)dt
-	a3real3Add(p->velocity.v, a3real3ProductS(d.v, p->acceleration.v, dt));
+	a3integrateEulerKinematic(p->position.v, p->velocity.v, p->acceleration.v, 3, dt);
 }
 
 
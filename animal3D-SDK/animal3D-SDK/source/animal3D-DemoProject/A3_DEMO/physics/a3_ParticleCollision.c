@@ -0,0 +1,330 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleCollision.c/.cpp
+	Implementation of particle collision.
+*/
+
+#include "a3_ParticleCollision.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper to get the cell coordinate containing x
+inline int a3particleCollisionCell_internal(const a3real x, const a3real cellSizeInv)
+{
+	// truncate, then step down for negatives (floor)
+	const a3real s = x * cellSizeInv;
+	const int i = (int)s;
+	return (i - (s < (a3real)i));
+}
+
+// internal helper to hash a cell into the mask table
+inline unsigned int a3particleCollisionKey_internal(const int ix, const int iy, const int iz, const unsigned int tableMask)
+{
+	return (((unsigned int)ix * 73856093u) ^ ((unsigned int)iy * 19349663u) ^ ((unsigned int)iz * 83492791u)) & tableMask;
+}
+
+// internal helper to mark every cell within half a cell of a box
+void a3particleCollisionMark_internal(a3_ParticleCollisionHash *hash, const a3real3p center, const a3real3p extent, const unsigned int bit)
+{
+	const a3real cellSizeInv = a3recip(hash->cellSize), margin = hash->cellSize * a3realHalf;
+	const unsigned int tableMask = hash->cellMaskCount - 1;
+	int lo[3], hi[3], ix, iy, iz;
+	unsigned int c;
+
+	for (c = 0; c < 3; ++c)
+	{
+		lo[c] = a3particleCollisionCell_internal(center[c] - extent[c] - margin, cellSizeInv);
+		hi[c] = a3particleCollisionCell_internal(center[c] + extent[c] + margin, cellSizeInv);
+	}
+	for (iz = lo[2]; iz <= hi[2]; ++iz)
+		for (iy = lo[1]; iy <= hi[1]; ++iy)
+			for (ix = lo[0]; ix <= hi[0]; ++ix)
+				hash->cellMask[a3particleCollisionKey_internal(ix, iy, iz, tableMask)] |= bit;
+}
+
+// internal helper to add a collider slot
+inline a3_ParticleCollider *a3particleCollisionAdd_internal(a3_ParticleCollisionHash *hash, const a3_ParticleColliderType type, const a3real3p center, const a3real3p velocity)
+{
+	a3_ParticleCollider *collider = hash->collider + hash->colliderCount++;
+	memset(collider, 0, sizeof(a3_ParticleCollider));
+	collider->type = type;
+	a3real3SetReal3(collider->center.v, center);
+	a3real3SetReal3(collider->velocity.v, velocity);
+	return collider;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// collision kernels
+//	- branch-free loops over gathered flat arrays so the compiler 
+//		can vectorize them; a particle either hits (weight 1) or is 
+//		left exactly as it was (weight 0)
+//	- positions are corrected to just outside the surface (skin) 
+//		and approaching relative velocity is reflected
+
+// plane: hit if the particle crossed the plane this step within 
+//	the rectangle, where it started or ended (so a particle that 
+//	crosses two walls at a corner hits both); it returns to the 
+//	side it came from
+void a3particleCollidePlane_internal(a3real *x, a3real *y, a3real *z, a3real *vx, a3real *vy, a3real *vz, const unsigned int count, const a3_ParticleCollider *collider, const a3real restitution, const a3real dt)
+{
+	const a3real skin = (a3real)(0.001);
+	const a3real *const c = collider->center.v, *const u = collider->velocity.v;
+	const a3real *const n = collider->normal.v, *const t = collider->tangent.v, *const b = collider->bitangent.v;
+	a3real dx, dy, dz, d, dPrev, du, dv, duPrev, dvPrev, rx, ry, rz, side, hit, push, bounce;
+	unsigned int i;
+
+	for (i = 0; i < count; ++i)
+	{
+		dx = x[i] - c[0];
+		dy = y[i] - c[1];
+		dz = z[i] - c[2];
+		d = dx * n[0] + dy * n[1] + dz * n[2];
+		du = dx * t[0] + dy * t[1] + dz * t[2];
+		dv = dx * b[0] + dy * b[1] + dz * b[2];
+
+		// offsets before the step, from relative velocity
+		rx = vx[i] - u[0];
+		ry = vy[i] - u[1];
+		rz = vz[i] - u[2];
+		dPrev = d - (rx * n[0] + ry * n[1] + rz * n[2]) * dt;
+		duPrev = du - (rx * t[0] + ry * t[1] + rz * t[2]) * dt;
+		dvPrev = dv - (rx * b[0] + ry * b[1] + rz * b[2]) * dt;
+		side = dPrev >= a3realZero ? a3realOne : -a3realOne;
+
+		hit = (d * side <= a3realZero &&
+			a3minimum(a3absolute(du), a3absolute(duPrev)) <= collider->halfWidth &&
+			a3minimum(a3absolute(dv), a3absolute(dvPrev)) <= collider->halfHeight) ? a3realOne : a3realZero;
+		push = hit * (side * skin - d);
+		bounce = hit * (a3realOne + restitution) * (rx * n[0] + ry * n[1] + rz * n[2]);
+
+		x[i] += n[0] * push;
+		y[i] += n[1] * push;
+		z[i] += n[2] * push;
+		vx[i] -= n[0] * bounce;
+		vy[i] -= n[1] * bounce;
+		vz[i] -= n[2] * bounce;
+	}
+}
+
+// sphere: hit if the particle is inside; it leaves along the radius
+void a3particleCollideSphere_internal(a3real *x, a3real *y, a3real *z, a3real *vx, a3real *vy, a3real *vz, const unsigned int count, const a3_ParticleCollider *collider, const a3real restitution)
+{
+	const a3real skin = (a3real)(0.001), epsilon = (a3real)(1.0e-6);
+	const a3real *const c = collider->center.v, *const u = collider->velocity.v;
+	const a3real radius = collider->radius;
+	a3real dx, dy, dz, r, rInv, vn, hit, push, bounce;
+	unsigned int i;
+
+	for (i = 0; i < count; ++i)
+	{
+		dx = x[i] - c[0];
+		dy = y[i] - c[1];
+		dz = z[i] - c[2];
+		r = (a3real)a3sqrt(dx * dx + dy * dy + dz * dz);
+		rInv = a3realOne / a3maximum(r, epsilon);
+		dx *= rInv;
+		dy *= rInv;
+		dz *= rInv;
+
+		vn = (vx[i] - u[0]) * dx + (vy[i] - u[1]) * dy + (vz[i] - u[2]) * dz;
+		hit = r < radius ? a3realOne : a3realZero;
+		push = hit * (radius + skin - r);
+		bounce = hit * (vn < a3realZero ? (a3realOne + restitution) * vn : a3realZero);
+
+		x[i] += dx * push;
+		y[i] += dy * push;
+		z[i] += dz * push;
+		vx[i] -= dx * bounce;
+		vy[i] -= dy * bounce;
+		vz[i] -= dz * bounce;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3particleCollisionHashCreate(a3_ParticleCollisionHash *hash_out, const unsigned int tableSizeLog2, const a3real cellSize, const unsigned int capacity)
+{
+	if (hash_out && !hash_out->cellMask && tableSizeLog2 < 32 && cellSize > a3realZero && capacity)
+	{
+		const unsigned int cellMaskCount = 1u << tableSizeLog2;
+		unsigned int *const memory = (unsigned int *)malloc(sizeof(unsigned int) * (cellMaskCount + capacity * 2));
+		if (memory)
+		{
+			hash_out->cellMask = memory;
+			hash_out->cellMaskCount = cellMaskCount;
+			hash_out->cellSize = cellSize;
+			hash_out->candidate = memory + cellMaskCount;
+			hash_out->candidateMask = hash_out->candidate + capacity;
+			hash_out->candidateCapacity = capacity;
+			hash_out->colliderCount = 0;
+			return cellMaskCount;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3particleCollisionHashRelease(a3_ParticleCollisionHash *hash)
+{
+	if (hash && hash->cellMask)
+	{
+		free(hash->cellMask);
+		memset(hash, 0, sizeof(a3_ParticleCollisionHash));
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particleCollisionHashClear(a3_ParticleCollisionHash *hash)
+{
+	if (hash)
+	{
+		hash->colliderCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particleCollisionHashAddPlane(a3_ParticleCollisionHash *hash, const a3real3p center, const a3real3p normal_unit, const a3real3p tangent_unit, const a3real3p bitangent_unit, const a3real halfWidth, const a3real halfHeight, const a3real3p velocity)
+{
+	a3_ParticleCollider *collider;
+	if (hash && center && normal_unit && tangent_unit && bitangent_unit && velocity && hash->colliderCount < a3particleCollisionMaxCount_collider)
+	{
+		collider = a3particleCollisionAdd_internal(hash, a3particleCollider_plane, center, velocity);
+		a3real3SetReal3(collider->normal.v, normal_unit);
+		a3real3SetReal3(collider->tangent.v, tangent_unit);
+		a3real3SetReal3(collider->bitangent.v, bitangent_unit);
+		collider->halfWidth = halfWidth;
+		collider->halfHeight = halfHeight;
+		return (hash->colliderCount - 1);
+	}
+	return -1;
+}
+
+extern inline int a3particleCollisionHashAddSphere(a3_ParticleCollisionHash *hash, const a3real3p center, const a3real radius, const a3real3p velocity)
+{
+	a3_ParticleCollider *collider;
+	if (hash && center && velocity && radius > a3realZero && hash->colliderCount < a3particleCollisionMaxCount_collider)
+	{
+		collider = a3particleCollisionAdd_internal(hash, a3particleCollider_sphere, center, velocity);
+		collider->radius = radius;
+		return (hash->colliderCount - 1);
+	}
+	return -1;
+}
+
+extern inline int a3particleCollisionHashResolve(a3_ParticleCollisionHash *hash, a3_ParticlePool *pool, const a3real restitution, const a3real dt)
+{
+	if (hash && hash->cellMask && pool && pool->count <= hash->candidateCapacity)
+	{
+		const a3real cellSizeInv = a3recip(hash->cellSize);
+		const unsigned int tableMask = hash->cellMaskCount - 1, stride = pool->capacity;
+		a3real *const px = pool->position, *const py = px + stride, *const pz = py + stride;
+		a3real *const vx = pool->velocity, *const vy = vx + stride, *const vz = vy + stride;
+		a3real batch[6][a3particleCollisionBatchSize];
+		unsigned int index[a3particleCollisionBatchSize];
+		const a3_ParticleCollider *collider;
+		a3vec3 extent;
+		unsigned int i, j, k, n, mask, bit, count = 0;
+
+		// mark cells near each collider
+		memset(hash->cellMask, 0, sizeof(unsigned int) * hash->cellMaskCount);
+		for (k = 0, collider = hash->collider; k < hash->colliderCount; ++k, ++collider)
+		{
+			if (collider->type == a3particleCollider_plane)
+				for (i = 0; i < 3; ++i)
+					extent.v[i] = a3absolute(collider->tangent.v[i]) * collider->halfWidth + a3absolute(collider->bitangent.v[i]) * collider->halfHeight;
+			else
+				extent.x = extent.y = extent.z = collider->radius;
+			a3particleCollisionMark_internal(hash, collider->center.v, extent.v, 1u << k);
+		}
+
+		// hash every particle's cell in one flat pass (keys are kept 
+		//	in the mask array: each is read before its slot is reused)
+		for (i = 0; i < pool->count; ++i)
+			hash->candidateMask[i] = a3particleCollisionKey_internal(
+				a3particleCollisionCell_internal(px[i], cellSizeInv),
+				a3particleCollisionCell_internal(py[i], cellSizeInv),
+				a3particleCollisionCell_internal(pz[i], cellSizeInv), tableMask);
+
+		// particles in marked cells are candidates (branch-free append)
+		for (i = 0; i < pool->count; ++i)
+		{
+			mask = hash->cellMask[hash->candidateMask[i]];
+			hash->candidate[count] = i;
+			hash->candidateMask[count] = mask;
+			count += (mask != 0);
+		}
+
+		// each collider: gather its candidates, run the kernel, scatter
+		for (k = 0, collider = hash->collider; k < hash->colliderCount; ++k, ++collider)
+		{
+			bit = 1u << k;
+			for (j = 0; j < count; )
+			{
+				for (n = 0; n < a3particleCollisionBatchSize && j < count; ++j)
+				{
+					if (hash->candidateMask[j] & bit)
+					{
+						i = index[n] = hash->candidate[j];
+						batch[0][n] = px[i];
+						batch[1][n] = py[i];
+						batch[2][n] = pz[i];
+						batch[3][n] = vx[i];
+						batch[4][n] = vy[i];
+						batch[5][n] = vz[i];
+						++n;
+					}
+				}
+				if (!n)
+					break;
+
+				if (collider->type == a3particleCollider_plane)
+					a3particleCollidePlane_internal(batch[0], batch[1], batch[2], batch[3], batch[4], batch[5], n, collider, restitution, dt);
+				else
+					a3particleCollideSphere_internal(batch[0], batch[1], batch[2], batch[3], batch[4], batch[5], n, collider, restitution);
+
+				// scatter back
+				while (n--)
+				{
+					i = index[n];
+					px[i] = batch[0][n];
+					py[i] = batch[1][n];
+					pz[i] = batch[2][n];
+					vx[i] = batch[3][n];
+					vy[i] = batch[4][n];
+					vz[i] = batch[5][n];
+				}
+			}
+		}
+		return count;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,138 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleCollision.h
+	Particle collision against static colliders through a spatial hash.
+*/
+
+#ifndef __ANIMAL3D_PARTICLECOLLISION_H
+#define __ANIMAL3D_PARTICLECOLLISION_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_ParticlePool.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_ParticleCollider			a3_ParticleCollider;
+	typedef struct a3_ParticleCollisionHash		a3_ParticleCollisionHash;
+	typedef enum a3_ParticleColliderType		a3_ParticleColliderType;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_ParticleCollisionLimits
+	{
+		// one mask bit per collider
+		a3particleCollisionMaxCount_collider = 32,
+
+		// candidates gathered per kernel call
+		a3particleCollisionBatchSize = 256,
+	};
+
+	// collider shapes
+	enum a3_ParticleColliderType
+	{
+		a3particleCollider_plane,	// two-sided bounded rectangle
+		a3particleCollider_sphere,
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// static collider: rigid shape that particles bounce off
+	//	- may move (velocity) but is not pushed back
+	struct a3_ParticleCollider
+	{
+		a3_ParticleColliderType type;
+		a3vec3 center, velocity;
+
+		// plane: unit normal and in-plane axes with half extents
+		a3vec3 normal, tangent, bitangent;
+		a3real halfWidth, halfHeight;
+
+		// sphere
+		a3real radius;
+	};
+
+	// spatial hash of colliders
+	//	- each cell of the hash holds a mask of colliders within half 
+	//		a cell of it; particles look up their cell and only those 
+	//		in marked cells are tested, in batches gathered into 
+	//		flat arrays for branch-free kernels
+	//	- particles must not move more than half a cell per step
+	struct a3_ParticleCollisionHash
+	{
+		a3_ParticleCollider collider[a3particleCollisionMaxCount_collider];
+		unsigned int colliderCount;
+
+		// cell masks (power-of-two size) and cell edge length
+		unsigned int *cellMask;
+		unsigned int cellMaskCount;
+		a3real cellSize;
+
+		// candidate particles and their masks (pool capacity each)
+		unsigned int *candidate, *candidateMask;
+		unsigned int candidateCapacity;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create hash with 2^tableSizeLog2 cells for a pool of 'capacity'
+	//	(allocates; call once at startup)
+	inline int a3particleCollisionHashCreate(a3_ParticleCollisionHash *hash_out, const unsigned int tableSizeLog2, const a3real cellSize, const unsigned int capacity);
+
+	// release hash memory
+	inline int a3particleCollisionHashRelease(a3_ParticleCollisionHash *hash);
+
+	// remove all colliders
+	inline int a3particleCollisionHashClear(a3_ParticleCollisionHash *hash);
+
+	// add plane collider (axes unit length); returns index or -1 if full
+	inline int a3particleCollisionHashAddPlane(a3_ParticleCollisionHash *hash, const a3real3p center, const a3real3p normal_unit, const a3real3p tangent_unit, const a3real3p bitangent_unit, const a3real halfWidth, const a3real halfHeight, const a3real3p velocity);
+
+	// add sphere collider; returns index or -1 if full
+	inline int a3particleCollisionHashAddSphere(a3_ParticleCollisionHash *hash, const a3real3p center, const a3real radius, const a3real3p velocity);
+
+	// collide pool's particles, which have just moved by velocity * dt, 
+	//	with every collider: particles that crossed a plane or entered 
+	//	a sphere are put back on the surface and bounce
+	//	- returns the number of particles tested
+	inline int a3particleCollisionHashResolve(a3_ParticleCollisionHash *hash, a3_ParticlePool *pool, const a3real restitution, const a3real dt);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PARTICLECOLLISION_H
@@ -0,0 +1,129 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleEmitter.c/.cpp
+	Implementation of particle emitter.
+*/
+
+#include "a3_ParticleEmitter.h"
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper to draw a uniform real in [0, 1) from a stream
+//	- xorshift32: three shifts per draw, no shared state
+inline a3real a3particleEmitterRandom_internal(unsigned int *random)
+{
+	unsigned int x = *random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*random = x;
+
+	// top 24 bits fill a float mantissa exactly
+	return (a3real)(x >> 8) * (a3real)(1.0 / 16777216.0);
+}
+
+// internal helper to draw a uniform real in [lo, hi)
+inline a3real a3particleEmitterRandomRange_internal(unsigned int *random, const a3real lo, const a3real hi)
+{
+	return (lo + (hi - lo) * a3particleEmitterRandom_internal(random));
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3particleEmitterCreate(a3_ParticleEmitter *emitter_out, const a3real3p position, const a3real3p direction_unit, const a3real coneAngle_degrees, const a3real rate, const unsigned int seed)
+{
+	if (emitter_out && position && direction_unit && rate >= a3realZero)
+	{
+		a3real3SetReal3(emitter_out->position.v, position);
+		a3real3SetReal3(emitter_out->direction.v, direction_unit);
+		emitter_out->coneAngle = coneAngle_degrees;
+		emitter_out->rate = rate;
+		emitter_out->speedMin = emitter_out->speedMax = a3realZero;
+		emitter_out->lifetimeMin = emitter_out->lifetimeMax = a3realZero;
+		emitter_out->acceleration = a3zeroVec3;
+		emitter_out->accumulator = a3realZero;
+		emitter_out->random = seed ? seed : 0x9e3779b9u;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particleEmitterSetRanges(a3_ParticleEmitter *emitter, const a3real speedMin, const a3real speedMax, const a3real lifetimeMin, const a3real lifetimeMax)
+{
+	if (emitter && speedMin <= speedMax && lifetimeMin <= lifetimeMax)
+	{
+		emitter->speedMin = speedMin;
+		emitter->speedMax = speedMax;
+		emitter->lifetimeMin = lifetimeMin;
+		emitter->lifetimeMax = lifetimeMax;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particleEmitterEmit(a3_ParticleEmitter *emitter, a3_ParticlePool *pool, const a3real dt)
+{
+	if (emitter && pool)
+	{
+		const a3real cosMax = a3cosd(emitter->coneAngle);
+		a3vec3 tangent, bitangent, direction, velocity;
+		a3real cosTheta, sinTheta, phi, speed;
+		unsigned int count, i;
+
+		// whole particles owed this step
+		emitter->accumulator += emitter->rate * dt;
+		count = (unsigned int)(emitter->accumulator);
+		emitter->accumulator -= (a3real)(count);
+
+		// basis about the cone axis
+		if (a3absolute(emitter->direction.z) < (a3real)(0.9))
+			a3real3Set(tangent.v, -emitter->direction.y, emitter->direction.x, a3realZero);
+		else
+			a3real3Set(tangent.v, a3realZero, -emitter->direction.z, emitter->direction.y);
+		a3real3Normalize(tangent.v);
+		a3real3Cross(bitangent.v, emitter->direction.v, tangent.v);
+
+		for (i = 0; i < count && pool->count < pool->capacity; ++i)
+		{
+			// uniform over the cone's cap: cos(theta) is uniform
+			cosTheta = a3particleEmitterRandomRange_internal(&emitter->random, cosMax, a3realOne);
+			sinTheta = (a3real)a3sqrt(a3maximum(a3realOne - cosTheta * cosTheta, a3realZero));
+			phi = a3particleEmitterRandomRange_internal(&emitter->random, a3realZero, (a3real)(360));
+
+			a3real3ProductS(direction.v, emitter->direction.v, cosTheta);
+			a3real3Add(direction.v, a3real3ProductS(velocity.v, tangent.v, sinTheta * a3cosd(phi)));
+			a3real3Add(direction.v, a3real3ProductS(velocity.v, bitangent.v, sinTheta * a3sind(phi)));
+
+			speed = a3particleEmitterRandomRange_internal(&emitter->random, emitter->speedMin, emitter->speedMax);
+			a3real3ProductS(velocity.v, direction.v, speed);
+
+			a3particlePoolAdd(pool, emitter->position.v, velocity.v, emitter->acceleration.v,
+				a3particleEmitterRandomRange_internal(&emitter->random, emitter->lifetimeMin, emitter->lifetimeMax));
+		}
+		return i;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
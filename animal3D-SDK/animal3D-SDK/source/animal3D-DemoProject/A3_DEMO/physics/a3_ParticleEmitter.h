@@ -0,0 +1,93 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleEmitter.h
+	Particle emitter feeding a particle pool.
+*/
+
+#ifndef __ANIMAL3D_PARTICLEEMITTER_H
+#define __ANIMAL3D_PARTICLEEMITTER_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_ParticlePool.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_ParticleEmitter		a3_ParticleEmitter;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// particle emitter
+	//	- emits 'rate' particles per second from its position, in 
+	//		directions spread uniformly over a cone about 'direction'
+	//	- speed and lifetime are drawn uniformly from their ranges
+	//	- each emitter has its own random stream, so emission is 
+	//		repeatable per seed and emitters never share state
+	struct a3_ParticleEmitter
+	{
+		a3vec3 position;
+		a3vec3 direction;			// unit cone axis
+		a3real coneAngle;			// degrees from axis
+		a3real rate;				// particles per second
+		a3real speedMin, speedMax;
+		a3real lifetimeMin, lifetimeMax;
+
+		// acceleration given to every particle emitted (e.g. gravity)
+		a3vec3 acceleration;
+
+		// fraction of a particle owed from previous steps
+		a3real accumulator;
+
+		// random stream state (xorshift, never zero)
+		unsigned int random;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create emitter; other ranges and acceleration default to zero
+	inline int a3particleEmitterCreate(a3_ParticleEmitter *emitter_out, const a3real3p position, const a3real3p direction_unit, const a3real coneAngle_degrees, const a3real rate, const unsigned int seed);
+
+	// set speed and lifetime ranges
+	inline int a3particleEmitterSetRanges(a3_ParticleEmitter *emitter, const a3real speedMin, const a3real speedMax, const a3real lifetimeMin, const a3real lifetimeMax);
+
+	// emit this step's particles into pool (no allocation; stops when full)
+	//	- returns the number emitted
+	inline int a3particleEmitterEmit(a3_ParticleEmitter *emitter, a3_ParticlePool *pool, const a3real dt);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PARTICLEEMITTER_H
@@ -0,0 +1,329 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleFluid.c/.cpp
+	Implementation of SPH fluid.
+*/
+
+#include "a3_ParticleFluid.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// passes split into jobs
+enum a3_ParticleFluidPass
+{
+	a3particleFluidPass_density,
+	a3particleFluidPass_force,
+};
+
+
+// internal density pass over [begin, end)
+//	- density sums the poly6 kernel over every neighbor including 
+//		the particle itself; neighbors (other than itself) are listed 
+//		for the force pass
+void a3particleFluidDensity_internal(a3_ParticleFluid *fluid, const unsigned int begin, const unsigned int end)
+{
+	const a3real h = fluid->smoothingRadius, h2 = h * h, h3 = h2 * h;
+	const a3real poly6 = fluid->particleMass * (a3real)(315.0 / 64.0) / (a3realPi * h3 * h3 * h3);
+	const unsigned int stride = fluid->pool->capacity;
+	const a3real *const px = fluid->pool->position, *const py = px + stride, *const pz = py + stride;
+	const unsigned int *const cellStart = fluid->grid->cellStart;
+	unsigned int slot[a3particleNeighborMaxCount_cell], slotCount = 0;
+	int cell[3], cellLast[3] = { 0 };
+	unsigned int i, j, k, n, *neighbor;
+	a3real position[3], dx, dy, dz, w, sum, density, pressure;
+
+	for (i = begin; i < end; ++i)
+	{
+		// particles are sorted by cell, so the slot list is 
+		//	usually the same as the last particle's
+		position[0] = px[i];
+		position[1] = py[i];
+		position[2] = pz[i];
+		a3particleNeighborGridCell(fluid->grid, cell, position);
+		if (i == begin || cell[0] != cellLast[0] || cell[1] != cellLast[1] || cell[2] != cellLast[2])
+		{
+			slotCount = a3particleNeighborGridSlots(fluid->grid, slot, cell);
+			cellLast[0] = cell[0];
+			cellLast[1] = cell[1];
+			cellLast[2] = cell[2];
+		}
+
+		sum = a3realZero;
+		neighbor = fluid->neighbor + i * a3particleFluidMaxCount_neighbor;
+		for (k = 0, n = 0; k < slotCount; ++k)
+		{
+			for (j = cellStart[slot[k]]; j < cellStart[slot[k] + 1]; ++j)
+			{
+				dx = position[0] - px[j];
+				dy = position[1] - py[j];
+				dz = position[2] - pz[j];
+				w = h2 - (dx * dx + dy * dy + dz * dz);
+				if (w > a3realZero)
+				{
+					sum += w * w * w;
+					if (j != i && n < a3particleFluidMaxCount_neighbor)
+						neighbor[n++] = j;
+				}
+			}
+		}
+		density = poly6 * sum;
+		fluid->densityInv[i] = a3recip(density);
+		fluid->neighborCount[i] = n;
+
+		pressure = fluid->stiffness * (density - fluid->restDensity);
+		pressure = pressure > a3realZero ? pressure : a3realZero;
+		fluid->pressureTerm[i] = pressure * fluid->densityInv[i] * fluid->densityInv[i];
+	}
+}
+
+// internal force pass over [begin, end)
+//	- symmetric pressure term (p_i/rho_i^2 + p_j/rho_j^2) so pairs 
+//		push each other equally; viscosity pulls velocity toward 
+//		the neighbors'; results are accelerations, with gravity
+void a3particleFluidForce_internal(a3_ParticleFluid *fluid, const unsigned int begin, const unsigned int end)
+{
+	const a3real h = fluid->smoothingRadius, h2 = h * h, h6 = h2 * h2 * h2;
+	const a3real spiky = fluid->particleMass * (a3real)(45.0) / (a3realPi * h6);
+	const a3real laplacian = fluid->viscosity * spiky;
+	const a3real epsilon = h2 * (a3real)(1.0e-6);
+	const unsigned int stride = fluid->pool->capacity;
+	const a3real *const px = fluid->pool->position, *const py = px + stride, *const pz = py + stride;
+	const a3real *const vx = fluid->pool->velocity, *const vy = vx + stride, *const vz = vy + stride;
+	a3real *const ax = fluid->pool->acceleration, *const ay = ax + stride, *const az = ay + stride;
+	const a3real *const densityInv = fluid->densityInv, *const pressureTerm = fluid->pressureTerm;
+	const unsigned int *neighbor;
+	unsigned int i, j, n, count;
+	a3real dx, dy, dz, r2, r, rInv, q, sp, sv, fx, fy, fz;
+
+	for (i = begin; i < end; ++i)
+	{
+		fx = fy = fz = a3realZero;
+		neighbor = fluid->neighbor + i * a3particleFluidMaxCount_neighbor;
+		count = fluid->neighborCount[i];
+		for (n = 0; n < count; ++n)
+		{
+			j = neighbor[n];
+			dx = px[i] - px[j];
+			dy = py[i] - py[j];
+			dz = pz[i] - pz[j];
+
+			// coincident particles have no direction to push along
+			r2 = dx * dx + dy * dy + dz * dz;
+			r2 = r2 > epsilon ? r2 : epsilon;
+			r = (a3real)a3sqrt(r2);
+			rInv = a3recip(r);
+			q = h - r;
+
+			// pressure along the separation, away from j
+			sp = spiky * (pressureTerm[i] + pressureTerm[j]) * q * q * rInv;
+			fx += sp * dx;
+			fy += sp * dy;
+			fz += sp * dz;
+
+			// viscosity toward j's velocity
+			sv = laplacian * q * densityInv[i] * densityInv[j];
+			fx += sv * (vx[j] - vx[i]);
+			fy += sv * (vy[j] - vy[i]);
+			fz += sv * (vz[j] - vz[i]);
+		}
+		ax[i] = fluid->gravity.x + fx;
+		ay[i] = fluid->gravity.y + fy;
+		az[i] = fluid->gravity.z + fz;
+	}
+}
+
+// internal job: run a pass over [begin, end)
+void a3particleFluidWork_internal(const a3_ParticleFluidTask *task, const unsigned int begin, const unsigned int end)
+{
+	switch (task->pass)
+	{
+	case a3particleFluidPass_density:
+		a3particleFluidDensity_internal(task->fluid, begin, end);
+		break;
+	case a3particleFluidPass_force:
+		a3particleFluidForce_internal(task->fluid, begin, end);
+		break;
+	}
+}
+
+// internal utility to split a pass into jobs and wait
+void a3particleFluidRunPass_internal(a3_ParticleFluid *fluid, const int pass)
+{
+	a3_ParticleFluidTask task[1];
+	task->fluid = fluid;
+	task->pass = pass;
+	a3jobParallelFor(fluid->jobs, (a3_JobFunc)a3particleFluidWork_internal, task, fluid->pool->count, a3particleFluidMinCount_share);
+}
+
+// internal utility to keep particles in the bounds
+//	- a particle outside is put back on the face and its velocity 
+//		into the face is reflected
+void a3particleFluidBound_internal(a3_ParticleFluid *fluid)
+{
+	const unsigned int count = fluid->pool->count, stride = fluid->pool->capacity;
+	const a3real e = fluid->restitution;
+	a3real *x, *v, lo, hi;
+	unsigned int c, i;
+
+	for (c = 0; c < 3; ++c)
+	{
+		x = fluid->pool->position + stride * c;
+		v = fluid->pool->velocity + stride * c;
+		lo = fluid->boundsMin.v[c];
+		hi = fluid->boundsMax.v[c];
+		for (i = 0; i < count; ++i)
+		{
+			v[i] = (x[i] < lo && v[i] < a3realZero) || (x[i] > hi && v[i] > a3realZero) ? -e * v[i] : v[i];
+			x[i] = x[i] < lo ? lo : x[i] > hi ? hi : x[i];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3particleFluidCreate(a3_ParticleFluid *fluid_out, const unsigned int capacity, const a3real smoothingRadius, const a3real restDensity, a3_JobSystem *jobs)
+{
+	if (fluid_out && !fluid_out->memory && capacity && smoothingRadius > a3realZero && restDensity > a3realZero)
+	{
+		// hash table about twice the particle count
+		unsigned int tableSizeLog2 = 10;
+		while ((1u << tableSizeLog2) < capacity * 2 && tableSizeLog2 < 24)
+			++tableSizeLog2;
+
+		if (a3particlePoolCreate(fluid_out->pool, capacity) > 0)
+		{
+			fluid_out->memory = malloc((sizeof(a3real) * 2 + sizeof(unsigned int) * (1 + a3particleFluidMaxCount_neighbor)) * fluid_out->pool->capacity);
+			if (fluid_out->memory &&
+				a3particleNeighborGridCreate(fluid_out->grid, tableSizeLog2, smoothingRadius, fluid_out->pool->capacity) > 0)
+			{
+				fluid_out->densityInv = (a3real *)fluid_out->memory;
+				fluid_out->pressureTerm = fluid_out->densityInv + fluid_out->pool->capacity;
+				fluid_out->neighborCount = (unsigned int *)(fluid_out->pressureTerm + fluid_out->pool->capacity);
+				fluid_out->neighbor = fluid_out->neighborCount + fluid_out->pool->capacity;
+
+				// water-like defaults: a bounded, rather compressible 
+				//	fluid that settles quickly
+				fluid_out->smoothingRadius = smoothingRadius;
+				fluid_out->restDensity = restDensity;
+				fluid_out->particleMass = restDensity * smoothingRadius * smoothingRadius * smoothingRadius * (a3real)(0.125);
+				fluid_out->stiffness = (a3real)(1000.0);
+				fluid_out->viscosity = restDensity * (a3real)(0.1);
+				a3real3Set(fluid_out->gravity.v, a3realZero, a3realZero, (a3real)(-9.80665));
+				a3real3Set(fluid_out->boundsMin.v, -smoothingRadius * 100, -smoothingRadius * 100, -smoothingRadius * 100);
+				a3real3Set(fluid_out->boundsMax.v, +smoothingRadius * 100, +smoothingRadius * 100, +smoothingRadius * 100);
+				fluid_out->restitution = (a3real)(0.25);
+				fluid_out->stepMax = a3realZero;
+				fluid_out->jobs = jobs;
+				return fluid_out->pool->capacity;
+			}
+			a3particleNeighborGridRelease(fluid_out->grid);
+			a3particlePoolRelease(fluid_out->pool);
+			free(fluid_out->memory);
+			fluid_out->memory = 0;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3particleFluidRelease(a3_ParticleFluid *fluid)
+{
+	if (fluid && fluid->memory)
+	{
+		a3particleNeighborGridRelease(fluid->grid);
+		a3particlePoolRelease(fluid->pool);
+		free(fluid->memory);
+		fluid->memory = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particleFluidAddBlock(a3_ParticleFluid *fluid, const a3real3p boxMin, const a3real3p boxMax, const a3real spacing)
+{
+	a3vec3 position;
+	const a3real zero[3] = { a3realZero, a3realZero, a3realZero };
+	const unsigned int count = fluid ? fluid->pool->count : 0;
+	unsigned int ix, iy, iz, n[3], c;
+	if (fluid && fluid->memory && boxMin && boxMax && spacing > a3realZero)
+	{
+		for (c = 0; c < 3; ++c)
+			n[c] = boxMax[c] > boxMin[c] ? (unsigned int)((boxMax[c] - boxMin[c]) / spacing) : 0;
+		fluid->particleMass = fluid->restDensity * spacing * spacing * spacing;
+
+		// particles sit at cell centers, half a spacing in from the faces
+		for (iz = 0; iz < n[2]; ++iz)
+			for (iy = 0; iy < n[1]; ++iy)
+				for (ix = 0; ix < n[0]; ++ix)
+				{
+					position.x = boxMin[0] + spacing * ((a3real)(ix) + a3realHalf);
+					position.y = boxMin[1] + spacing * ((a3real)(iy) + a3realHalf);
+					position.z = boxMin[2] + spacing * ((a3real)(iz) + a3realHalf);
+					if (a3particlePoolAdd(fluid->pool, position.v, zero, fluid->gravity.v, a3realZero) < 0)
+						return (fluid->pool->count - count);
+				}
+		return (fluid->pool->count - count);
+	}
+	return -1;
+}
+
+extern inline int a3particleFluidStep(a3_ParticleFluid *fluid, const a3real dt)
+{
+	a3real h, hMax;
+	unsigned int substeps, s;
+	if (fluid && fluid->memory && dt > a3realZero)
+	{
+		if (!fluid->pool->count)
+			return 0;
+
+		// longest stable substep: sound crossing a fraction of the 
+		//	smoothing radius, and viscosity diffusing across it
+		hMax = (a3real)(0.4) * fluid->smoothingRadius / a3sqrt(fluid->stiffness > a3realZero ? fluid->stiffness : a3realOne);
+		if (fluid->viscosity > a3realZero)
+			hMax = a3minimum(hMax, (a3real)(0.125) * fluid->smoothingRadius * fluid->smoothingRadius * fluid->restDensity / fluid->viscosity);
+		if (fluid->stepMax > a3realZero)
+			hMax = a3minimum(hMax, fluid->stepMax);
+		substeps = (unsigned int)(dt / hMax) + 1;
+		h = dt / (a3real)(substeps);
+
+		for (s = 0; s < substeps; ++s)
+		{
+			// sort by cell so neighbor loops read contiguous memory
+			a3particleNeighborGridBuild(fluid->grid, fluid->pool);
+			a3particleNeighborGridReorderPool(fluid->grid, fluid->pool);
+
+			a3particleFluidRunPass_internal(fluid, a3particleFluidPass_density);
+			a3particleFluidRunPass_internal(fluid, a3particleFluidPass_force);
+			a3particlePoolIntegrateEulerSemiImplicit(fluid->pool, h);
+			a3particleFluidBound_internal(fluid);
+		}
+		return substeps;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
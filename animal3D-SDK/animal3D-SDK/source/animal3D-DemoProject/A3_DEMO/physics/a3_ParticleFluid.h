@@ -0,0 +1,146 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleFluid.h
+	Smoothed-particle hydrodynamics (SPH) fluid on a particle pool.
+*/
+
+#ifndef __ANIMAL3D_PARTICLEFLUID_H
+#define __ANIMAL3D_PARTICLEFLUID_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_ParticleNeighbor.h"
+
+#include "a3_JobSystem.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_ParticleFluid				a3_ParticleFluid;
+	typedef struct a3_ParticleFluidTask			a3_ParticleFluidTask;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_ParticleFluidLimits
+	{
+		// fewest particles worth handing to another thread
+		a3particleFluidMinCount_share = 256,
+
+		// neighbors kept per particle (more than twice the usual 
+		//	count at a smoothing radius of two spacings)
+		a3particleFluidMaxCount_neighbor = 64,
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// pass handed to the job system
+	struct a3_ParticleFluidTask
+	{
+		a3_ParticleFluid *fluid;
+		int pass;
+	};
+
+	// SPH fluid
+	//	- particles live in the fluid's own pool; each substep sorts 
+	//		them by cell with the neighbor grid (cell size is the 
+	//		smoothing radius), then the density pass searches the 27 
+	//		cells around each particle and keeps the ones in range as 
+	//		its neighbor list, which the force pass walks; last, the 
+	//		pool is integrated and clamped to the bounds
+	//	- kernels (Mueller et al. 2003): poly6 for density, spiky 
+	//		gradient for pressure, viscosity laplacian for viscosity; 
+	//		pressure is stiffness * (density - restDensity), not 
+	//		allowed below zero so particles do not clump
+	//	- density and force passes are split into jobs; each 
+	//		particle only writes its own entries
+	//	- substeps are no longer than stepMax, which should stay 
+	//		under about 0.4 * smoothingRadius / sqrt(stiffness)
+	struct a3_ParticleFluid
+	{
+		a3_ParticlePool pool[1];
+		a3_ParticleNeighborGrid grid[1];
+
+		// per particle: 1 / density, pressure / density^2, and 
+		//	neighbor list (a3particleFluidMaxCount_neighbor slots each)
+		a3real *densityInv;
+		a3real *pressureTerm;
+		unsigned int *neighborCount;
+		unsigned int *neighbor;
+
+		// material
+		a3real smoothingRadius, particleMass, restDensity;
+		a3real stiffness, viscosity;
+		a3vec3 gravity;
+
+		// box the fluid is kept in, and speed kept bouncing off it
+		a3vec3 boundsMin, boundsMax;
+		a3real restitution;
+
+		// longest substep
+		a3real stepMax;
+
+		// job system passes run on (null to run them here)
+		a3_JobSystem *jobs;
+
+		// allocation holding per-particle arrays
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create fluid for up to 'capacity' particles with a smoothing 
+	//	radius and rest density; the remaining material and bounds 
+	//	start at water-like defaults (allocates; call once at startup)
+	inline int a3particleFluidCreate(a3_ParticleFluid *fluid_out, const unsigned int capacity, const a3real smoothingRadius, const a3real restDensity, a3_JobSystem *jobs);
+
+	// release fluid memory
+	inline int a3particleFluidRelease(a3_ParticleFluid *fluid);
+
+	// fill a box with particles at rest on a lattice of 'spacing'
+	//	- sets particle mass so the lattice is at rest density
+	//	- stops early if the pool fills
+	//	- returns the number added
+	inline int a3particleFluidAddBlock(a3_ParticleFluid *fluid, const a3real3p boxMin, const a3real3p boxMax, const a3real spacing);
+
+	// advance the fluid by dt in substeps of at most stepMax
+	inline int a3particleFluidStep(a3_ParticleFluid *fluid, const a3real dt);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PARTICLEFLUID_H
@@ -0,0 +1,183 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleNeighbor.c/.cpp
+	Implementation of particle neighbor search.
+*/
+
+#include "a3_ParticleNeighbor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper to get the cell coordinate containing x
+inline int a3particleNeighborCell_internal(const a3real x, const a3real cellSizeInv)
+{
+	// truncate, then step down for negatives (floor)
+	const a3real s = x * cellSizeInv;
+	const int i = (int)s;
+	return (i - (s < (a3real)i));
+}
+
+// internal helper to hash a cell into the table
+inline unsigned int a3particleNeighborKey_internal(const int ix, const int iy, const int iz, const unsigned int tableMask)
+{
+	return (((unsigned int)ix * 73856093u) ^ ((unsigned int)iy * 19349663u) ^ ((unsigned int)iz * 83492791u)) & tableMask;
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3particleNeighborGridCreate(a3_ParticleNeighborGrid *grid_out, const unsigned int tableSizeLog2, const a3real cellSize, const unsigned int capacity)
+{
+	if (grid_out && !grid_out->memory && tableSizeLog2 && tableSizeLog2 < 31 && cellSize > a3realZero && capacity)
+	{
+		// per-slot arrays, then per-particle arrays
+		const unsigned int tableSize = 1u << tableSizeLog2;
+		const size_t slotSize = sizeof(unsigned int) * (tableSize * 2 + 1);
+		const size_t particleSize = sizeof(unsigned int) * capacity * 2 + sizeof(a3real) * capacity;
+		void *const memory = malloc(slotSize + particleSize);
+		if (memory)
+		{
+			memset(memory, 0, slotSize + particleSize);
+			grid_out->memory = memory;
+			grid_out->cellSize = cellSize;
+			grid_out->cellStart = (unsigned int *)memory;
+			grid_out->cellCursor = grid_out->cellStart + tableSize + 1;
+			grid_out->tableSize = tableSize;
+			grid_out->key = grid_out->cellCursor + tableSize;
+			grid_out->order = grid_out->key + capacity;
+			grid_out->scratch = (a3real *)(grid_out->order + capacity);
+			grid_out->count = 0;
+			grid_out->capacity = capacity;
+			return tableSize;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3particleNeighborGridRelease(a3_ParticleNeighborGrid *grid)
+{
+	if (grid && grid->memory)
+	{
+		free(grid->memory);
+		memset(grid, 0, sizeof(a3_ParticleNeighborGrid));
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particleNeighborGridBuild(a3_ParticleNeighborGrid *grid, const a3_ParticlePool *pool)
+{
+	if (grid && grid->memory && pool && pool->count <= grid->capacity)
+	{
+		const a3real cellSizeInv = a3recip(grid->cellSize);
+		const unsigned int tableMask = grid->tableSize - 1, count = pool->count, stride = pool->capacity;
+		const a3real *const px = pool->position, *const py = px + stride, *const pz = py + stride;
+		unsigned int *const cellStart = grid->cellStart, *const cellCursor = grid->cellCursor;
+		unsigned int *const key = grid->key, *const order = grid->order;
+		unsigned int i, k, sum;
+
+		// key and count every particle
+		memset(cellCursor, 0, sizeof(unsigned int) * grid->tableSize);
+		for (i = 0; i < count; ++i)
+		{
+			key[i] = a3particleNeighborKey_internal(
+				a3particleNeighborCell_internal(px[i], cellSizeInv),
+				a3particleNeighborCell_internal(py[i], cellSizeInv),
+				a3particleNeighborCell_internal(pz[i], cellSizeInv), tableMask);
+			++cellCursor[key[i]];
+		}
+
+		// exclusive prefix sum: where each slot's range starts
+		for (k = 0, sum = 0; k < grid->tableSize; ++k)
+		{
+			cellStart[k] = sum;
+			sum += cellCursor[k];
+			cellCursor[k] = cellStart[k];
+		}
+		cellStart[k] = sum;
+
+		// scatter indices into their ranges (stable)
+		for (i = 0; i < count; ++i)
+			order[cellCursor[key[i]]++] = i;
+
+		grid->count = count;
+		return count;
+	}
+	return -1;
+}
+
+extern inline int a3particleNeighborGridReorderPool(a3_ParticleNeighborGrid *grid, a3_ParticlePool *pool)
+{
+	unsigned int i;
+	if (grid && grid->memory && pool && pool->count == grid->count)
+	{
+		a3particlePoolReorder(pool, grid->order, grid->scratch);
+		for (i = 0; i < grid->count; ++i)
+			grid->order[i] = i;
+		return grid->count;
+	}
+	return -1;
+}
+
+extern inline int a3particleNeighborGridCell(const a3_ParticleNeighborGrid *grid, int *cell_out, const a3real3p position)
+{
+	if (grid && cell_out && position)
+	{
+		const a3real cellSizeInv = a3recip(grid->cellSize);
+		cell_out[0] = a3particleNeighborCell_internal(position[0], cellSizeInv);
+		cell_out[1] = a3particleNeighborCell_internal(position[1], cellSizeInv);
+		cell_out[2] = a3particleNeighborCell_internal(position[2], cellSizeInv);
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particleNeighborGridSlots(const a3_ParticleNeighborGrid *grid, unsigned int *slot_out, const int *cell)
+{
+	const unsigned int tableMask = grid ? grid->tableSize - 1 : 0;
+	unsigned int key, n = 0, m;
+	int ix, iy, iz;
+	if (grid && slot_out && cell)
+	{
+		// skip slots already listed and slots with nothing in them
+		for (iz = cell[2] - 1; iz <= cell[2] + 1; ++iz)
+			for (iy = cell[1] - 1; iy <= cell[1] + 1; ++iy)
+				for (ix = cell[0] - 1; ix <= cell[0] + 1; ++ix)
+				{
+					key = a3particleNeighborKey_internal(ix, iy, iz, tableMask);
+					if (grid->cellStart[key] == grid->cellStart[key + 1])
+						continue;
+					for (m = 0; m < n && slot_out[m] != key; ++m);
+					if (m == n)
+						slot_out[n++] = key;
+				}
+		return n;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,119 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticleNeighbor.h
+	Neighbor search for particles: a spatial hash built by counting sort.
+*/
+
+#ifndef __ANIMAL3D_PARTICLENEIGHBOR_H
+#define __ANIMAL3D_PARTICLENEIGHBOR_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_ParticlePool.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_ParticleNeighborGrid		a3_ParticleNeighborGrid;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_ParticleNeighborLimits
+	{
+		// cells searched around a particle (3x3x3)
+		a3particleNeighborMaxCount_cell = 27,
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// neighbor grid
+	//	- space is cut into cubic cells hashed into a table; building 
+	//		counts particles per table slot, prefix-sums the counts 
+	//		into cellStart, then writes each particle index into its 
+	//		slot's range of 'order' (a counting sort, two flat passes)
+	//	- reordering the pool by 'order' afterward puts particles 
+	//		that share a cell next to each other, so neighbor loops 
+	//		walk contiguous memory: slot k holds pool particles 
+	//		[cellStart[k], cellStart[k + 1])
+	//	- distinct cells can share a slot, so callers still test 
+	//		distance; with cellSize no smaller than the search radius 
+	//		every neighbor is in the 27 cells around a particle
+	struct a3_ParticleNeighborGrid
+	{
+		a3real cellSize;
+		unsigned int *cellStart;	// tableSize + 1 entries
+		unsigned int *cellCursor;	// scatter cursor per slot
+		unsigned int tableSize;
+
+		unsigned int *key;			// slot of each particle
+		unsigned int *order;		// particle indices sorted by slot
+		a3real *scratch;			// reorder buffer
+		unsigned int count, capacity;
+
+		// single allocation holding every array
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create grid with 2^tableSizeLog2 slots for up to 'capacity' 
+	//	particles (allocates; call once at startup)
+	inline int a3particleNeighborGridCreate(a3_ParticleNeighborGrid *grid_out, const unsigned int tableSizeLog2, const a3real cellSize, const unsigned int capacity);
+
+	// release grid memory
+	inline int a3particleNeighborGridRelease(a3_ParticleNeighborGrid *grid);
+
+	// sort the pool's live particles into slots
+	//	- returns the number sorted or -1 if the pool is too big
+	inline int a3particleNeighborGridBuild(a3_ParticleNeighborGrid *grid, const a3_ParticlePool *pool);
+
+	// reorder the pool the grid was just built from into slot order 
+	//	(order becomes the identity, so cellStart indexes the pool)
+	inline int a3particleNeighborGridReorderPool(a3_ParticleNeighborGrid *grid, a3_ParticlePool *pool);
+
+	// get the cell coordinates containing a position
+	inline int a3particleNeighborGridCell(const a3_ParticleNeighborGrid *grid, int *cell_out, const a3real3p position);
+
+	// get the distinct slots of the 27 cells around a cell
+	//	- returns the number written to slot_out (at most 27)
+	inline int a3particleNeighborGridSlots(const a3_ParticleNeighborGrid *grid, unsigned int *slot_out, const int *cell);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PARTICLENEIGHBOR_H
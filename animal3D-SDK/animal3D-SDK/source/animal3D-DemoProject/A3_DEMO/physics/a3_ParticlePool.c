@@ -0,0 +1,184 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticlePool.c/.cpp
+	Implementation of particle pool.
+*/
+
+#include "a3_ParticlePool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper to set one particle's vector attribute
+inline void a3particlePoolSet_internal(a3real *block, const unsigned int capacity, const unsigned int index, const a3real3p v)
+{
+	block[index] = v[0];
+	block[index + capacity] = v[1];
+	block[index + capacity * 2] = v[2];
+}
+
+// internal helper to copy one particle over another
+//	- attribute blocks are contiguous, so every block from position 
+//		through life is a stride of capacity apart
+inline void a3particlePoolMove_internal(a3_ParticlePool *pool, const unsigned int index_out, const unsigned int index)
+{
+	a3real *block = pool->position;
+	unsigned int b;
+	for (b = 0; b < 10; ++b, block += pool->capacity)
+		block[index_out] = block[index];
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3particlePoolCreate(a3_ParticlePool *pool_out, const unsigned int capacity)
+{
+	if (pool_out && capacity && !pool_out->memory)
+	{
+		// three attributes of three blocks, life, plus slack to align
+		const unsigned int capacityPadded = (capacity + 7) & ~7u;
+		const size_t blockSize = sizeof(a3real) * capacityPadded;
+		void *const memory = malloc(blockSize * 10 + 32);
+		a3real *base;
+		if (memory)
+		{
+			base = (a3real *)(((size_t)memory + 31) & ~(size_t)31);
+			memset(base, 0, blockSize * 10);
+			pool_out->memory = memory;
+			pool_out->position = base;
+			pool_out->velocity = base + 3 * capacityPadded;
+			pool_out->acceleration = base + 6 * capacityPadded;
+			pool_out->life = base + 9 * capacityPadded;
+			pool_out->capacity = capacityPadded;
+			pool_out->count = 0;
+			return capacityPadded;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3particlePoolRelease(a3_ParticlePool *pool)
+{
+	if (pool && pool->memory)
+	{
+		free(pool->memory);
+		memset(pool, 0, sizeof(a3_ParticlePool));
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3particlePoolAdd(a3_ParticlePool *pool, const a3real3p position, const a3real3p velocity, const a3real3p acceleration, const a3real lifetime)
+{
+	if (pool && position && velocity && acceleration && pool->count < pool->capacity)
+	{
+		const unsigned int i = pool->count++;
+		a3particlePoolSet_internal(pool->position, pool->capacity, i, position);
+		a3particlePoolSet_internal(pool->velocity, pool->capacity, i, velocity);
+		a3particlePoolSet_internal(pool->acceleration, pool->capacity, i, acceleration);
+		pool->life[i] = lifetime;
+		return i;
+	}
+	return -1;
+}
+
+extern inline int a3particlePoolRemove(a3_ParticlePool *pool, const unsigned int index)
+{
+	if (pool && index < pool->count)
+	{
+		if (index < --pool->count)
+			a3particlePoolMove_internal(pool, index, pool->count);
+		return pool->count;
+	}
+	return -1;
+}
+
+extern inline int a3particlePoolAge(a3_ParticlePool *pool, const a3real dt)
+{
+	const unsigned int count = pool ? pool->count : 0;
+	unsigned int i;
+	if (pool)
+	{
+		// age in one flat pass, then compact
+		for (i = 0; i < count; ++i)
+			pool->life[i] -= dt;
+
+		// a particle moved in from the end is checked again
+		for (i = 0; i < pool->count; )
+		{
+			if (pool->life[i] > a3realZero)
+				++i;
+			else if (i < --pool->count)
+				a3particlePoolMove_internal(pool, i, pool->count);
+		}
+		return (count - pool->count);
+	}
+	return -1;
+}
+
+extern inline int a3particlePoolReorder(a3_ParticlePool *pool, const unsigned int *order, a3real *scratch)
+{
+	a3real *block;
+	unsigned int b, i;
+	if (pool && order && scratch)
+	{
+		// gather each block through the order, then copy it back
+		for (b = 0, block = pool->position; b < 10; ++b, block += pool->capacity)
+		{
+			for (i = 0; i < pool->count; ++i)
+				scratch[i] = block[order[i]];
+			memcpy(block, scratch, sizeof(a3real) * pool->count);
+		}
+		return pool->count;
+	}
+	return -1;
+}
+
+extern inline int a3particlePoolIntegrateEulerSemiImplicit(a3_ParticlePool *pool, const a3real dt)
+{
+	unsigned int c;
+	if (pool)
+	{
+		// one flat pass per component
+		for (c = 0; c < 3; ++c)
+			a3integrateEulerSemiImplicit(pool->position + pool->capacity * c, pool->velocity + pool->capacity * c, pool->acceleration + pool->capacity * c, pool->count, dt);
+		return pool->count;
+	}
+	return -1;
+}
+
+extern inline int a3particlePoolCopyPositions(a3real *position_out, const a3_ParticlePool *pool)
+{
+	unsigned int c;
+	if (position_out && pool)
+	{
+		for (c = 0; c < 3; ++c)
+			memcpy(position_out + pool->capacity * c, pool->position + pool->capacity * c, sizeof(a3real) * pool->count);
+		return pool->count;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,108 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_ParticlePool.h
+	Fixed-capacity particle pool in structure-of-arrays layout.
+*/
+
+#ifndef __ANIMAL3D_PARTICLEPOOL_H
+#define __ANIMAL3D_PARTICLEPOOL_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_Integration.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_ParticlePool		a3_ParticlePool;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// particle pool
+	//	- each vector attribute is three blocks of 'capacity' reals 
+	//		(all x, then all y, then all z) so integration runs over 
+	//		flat arrays; live particles are the first 'count' of each
+	//	- capacity is rounded up to a multiple of 8 and blocks are 
+	//		32-byte aligned for 8-wide kernels
+	//	- dead particles are replaced by the last live one, so the 
+	//		live range stays dense and order is not preserved
+	struct a3_ParticlePool
+	{
+		a3real *position;			// x
+		a3real *velocity;			// v = dx/dt
+		a3real *acceleration;		// a = dv/dt
+		a3real *life;				// seconds left to live (one block)
+
+		unsigned int count, capacity;
+
+		// single allocation holding every block
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create pool with room for at least 'capacity' particles
+	//	(allocates; call once at startup)
+	inline int a3particlePoolCreate(a3_ParticlePool *pool_out, const unsigned int capacity);
+
+	// release pool memory
+	inline int a3particlePoolRelease(a3_ParticlePool *pool);
+
+	// add particle that lives for 'lifetime' seconds
+	//	- returns its index or -1 if full
+	inline int a3particlePoolAdd(a3_ParticlePool *pool, const a3real3p position, const a3real3p velocity, const a3real3p acceleration, const a3real lifetime);
+
+	// remove particle by index (last particle takes its place)
+	inline int a3particlePoolRemove(a3_ParticlePool *pool, const unsigned int index);
+
+	// age every live particle and remove the expired ones
+	//	- returns the number removed
+	inline int a3particlePoolAge(a3_ParticlePool *pool, const a3real dt);
+
+	// permute live particles so slot n holds the one that was at 
+	//	order[n] (e.g. to sort by cell); scratch holds 'count' reals
+	inline int a3particlePoolReorder(a3_ParticlePool *pool, const unsigned int *order, a3real *scratch);
+
+	// semi-implicit Euler over every live particle
+	inline int a3particlePoolIntegrateEulerSemiImplicit(a3_ParticlePool *pool, const a3real dt);
+
+	// copy live positions in bulk to a buffer with the pool's layout 
+	//	(three blocks of 'capacity' reals)
+	inline int a3particlePoolCopyPositions(a3real *position_out, const a3_ParticlePool *pool);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PARTICLEPOOL_H
@@ -0,0 +1,367 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_PhysicsBatch.c/.cpp
+	Implementation of physics world batch.
+*/
+
+#include "a3_PhysicsBatch.h"
+
+#include "animal3D/a3utility/a3_Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// body slot of a lane group, gathered component by component 
+//	([component][lane]) so each operation is one loop over lanes
+typedef struct a3_PhysicsBatchLanes_internal
+{
+	a3real position[3][a3physicsBatchMaxCount_lane];
+	a3real velocity[3][a3physicsBatchMaxCount_lane];
+	a3real acceleration[3][a3physicsBatchMaxCount_lane];
+	a3real pseudoVelocity[3][a3physicsBatchMaxCount_lane];
+	a3real force[3][a3physicsBatchMaxCount_lane];
+	a3real rotation[4][a3physicsBatchMaxCount_lane];
+	a3real velocity_a[4][a3physicsBatchMaxCount_lane];
+	a3real acceleration_a[4][a3physicsBatchMaxCount_lane];
+	a3real torque[4][a3physicsBatchMaxCount_lane];
+	a3real massInv[a3physicsBatchMaxCount_lane];
+	a3real dt[a3physicsBatchMaxCount_lane];
+} a3_PhysicsBatchLanes_internal;
+
+
+// internal helper: concatenate quaternions in every lane, in the 
+//	same order of operations as a3quaternionConcat
+inline void a3physicsBatchConcat_internal(a3real q_out[4][a3physicsBatchMaxCount_lane], a3real qL[4][a3physicsBatchMaxCount_lane], a3real qR[4][a3physicsBatchMaxCount_lane])
+{
+	unsigned int l;
+	a3real x, y, z;
+	for (l = 0; l < a3physicsBatchMaxCount_lane; ++l)
+	{
+		// v = qR qL.w + qL qR.w, out = qR x qL + v
+		x = qR[0][l] * qL[3][l] + qL[0][l] * qR[3][l];
+		y = qR[1][l] * qL[3][l] + qL[1][l] * qR[3][l];
+		z = qR[2][l] * qL[3][l] + qL[2][l] * qR[3][l];
+		q_out[3][l] = qL[3][l] * qR[3][l] - (qL[0][l] * qR[0][l] + qL[1][l] * qR[1][l] + qL[2][l] * qR[2][l]);
+		q_out[0][l] = (qR[1][l] * qL[2][l] - qR[2][l] * qL[1][l]) + x;
+		q_out[1][l] = (qR[2][l] * qL[0][l] - qR[0][l] * qL[2][l]) + y;
+		q_out[2][l] = (qR[0][l] * qL[1][l] - qR[1][l] * qL[0][l]) + z;
+	}
+}
+
+// internal helper: integrate a gathered body slot in every lane
+//	- the kinematic step of a3rigidbodyIntegrateEulerKinematic, then 
+//		a3rigidbodyIntegratePseudoVelocity and the acceleration 
+//		update; normalizing is left to the scatter
+void a3physicsBatchIntegrateLanes_internal(a3_PhysicsBatchLanes_internal *b)
+{
+	a3real first[4][a3physicsBatchMaxCount_lane], second[4][a3physicsBatchMaxCount_lane];
+	a3real third[4][a3physicsBatchMaxCount_lane], fourth[4][a3physicsBatchMaxCount_lane];
+	a3real dt, dt2, halfDt;
+	unsigned int c, l;
+
+	// x(t+dt) = x(t) + v(t)dt + a(t)dt2 / 2
+	// v(t+dt) = v(t) + a(t)dt
+	for (c = 0; c < 3; ++c)
+		for (l = 0; l < a3physicsBatchMaxCount_lane; ++l)
+		{
+			dt = b->dt[l];
+			dt2 = a3realHalf * dt * dt;
+			b->position[c][l] += b->velocity[c][l] * dt + b->acceleration[c][l] * dt2;
+			b->velocity[c][l] += b->acceleration[c][l] * dt;
+		}
+
+	// q(t+dt) = q(t) + w(t)q(t)dt/2 + (aq/2 + w(t)^2 q(t)/4)dt^2 / 2
+	a3physicsBatchConcat_internal(first, b->velocity_a, b->rotation);
+	a3physicsBatchConcat_internal(second, b->acceleration_a, b->rotation);
+	a3physicsBatchConcat_internal(fourth, b->velocity_a, b->velocity_a);
+	a3physicsBatchConcat_internal(third, fourth, b->rotation);
+	for (c = 0; c < 4; ++c)
+		for (l = 0; l < a3physicsBatchMaxCount_lane; ++l)
+		{
+			dt = b->dt[l];
+			halfDt = a3realHalf * dt;
+			first[c][l] *= halfDt;
+			second[c][l] *= a3realHalf;
+			second[c][l] += third[c][l] * a3realQuarter;
+			second[c][l] *= dt * dt;
+			second[c][l] *= a3realHalf;
+			first[c][l] += second[c][l];
+			b->rotation[c][l] += first[c][l];
+			b->velocity_a[c][l] += b->acceleration_a[c][l] * dt;
+			b->acceleration_a[c][l] = b->torque[c][l] * b->massInv[l];
+		}
+
+	// x(t+dt) += v_pseudo dt, pseudo-velocity only lives for one step; 
+	//	then a = F / m
+	for (c = 0; c < 3; ++c)
+		for (l = 0; l < a3physicsBatchMaxCount_lane; ++l)
+		{
+			b->position[c][l] += b->pseudoVelocity[c][l] * b->dt[l];
+			b->pseudoVelocity[c][l] = a3realZero;
+			b->acceleration[c][l] = b->force[c][l] * b->massInv[l];
+		}
+}
+
+// internal helper: integrate the bodies of a lane group over a 
+//	substep h per lane (0 where a world is not stepping)
+//	- does for each world what a3physicsStepIntegrate does, slot by 
+//		slot across worlds
+void a3physicsBatchIntegrate_internal(a3_PhysicsWorld *world, const unsigned int lanes, const a3real *h)
+{
+	a3_PhysicsBatchLanes_internal b[1];
+	a3_RigidBody *rb;
+	unsigned int active[a3physicsBatchMaxCount_lane];
+	unsigned int i, c, l, slots = 0, any;
+
+	for (l = 0; l < lanes; ++l)
+		slots = a3maximum(slots, world[l].rigidbodiesActive);
+
+	for (i = 0; i < slots; ++i)
+	{
+		// gather bodies stepping in this slot; idle lanes integrate 
+		//	zeros and are not written back
+		memset(b, 0, sizeof(b));
+		for (l = any = 0; l < a3physicsBatchMaxCount_lane; ++l)
+		{
+			active[l] = 0;
+			if (l >= lanes || h[l] <= a3realZero || i >= world[l].rigidbodiesActive)
+				continue;
+			rb = world[l].rigidbody + i;
+			if (rb->held)
+				continue;
+
+			// sleeping bodies wake when pushed
+			if (rb->sleeping)
+			{
+				if (a3real3LengthSquared(rb->force.v) <= a3realZero)
+					continue;
+				a3rigidbodyWake(rb);
+			}
+
+			for (c = 0; c < 3; ++c)
+			{
+				b->position[c][l] = rb->position.v[c];
+				b->velocity[c][l] = rb->velocity.v[c];
+				b->acceleration[c][l] = rb->acceleration.v[c];
+				b->pseudoVelocity[c][l] = rb->pseudoVelocity.v[c];
+				b->force[c][l] = rb->force.v[c];
+			}
+			for (c = 0; c < 4; ++c)
+			{
+				b->rotation[c][l] = rb->rotation.v[c];
+				b->velocity_a[c][l] = rb->velocity_a.v[c];
+				b->acceleration_a[c][l] = rb->acceleration_a.v[c];
+				b->torque[c][l] = rb->torque.v[c];
+			}
+			b->massInv[l] = rb->massInv;
+			b->dt[l] = h[l];
+			active[l] = any = 1;
+		}
+		if (!any)
+			continue;
+
+		a3physicsBatchIntegrateLanes_internal(b);
+
+		// scatter and normalize
+		for (l = 0; l < lanes; ++l)
+		{
+			if (!active[l])
+				continue;
+			rb = world[l].rigidbody + i;
+			for (c = 0; c < 3; ++c)
+			{
+				rb->position.v[c] = b->position[c][l];
+				rb->velocity.v[c] = b->velocity[c][l];
+				rb->acceleration.v[c] = b->acceleration[c][l];
+				rb->pseudoVelocity.v[c] = b->pseudoVelocity[c][l];
+			}
+			for (c = 0; c < 4; ++c)
+			{
+				rb->rotation.v[c] = b->rotation[c][l];
+				rb->velocity_a.v[c] = b->velocity_a[c][l];
+				rb->acceleration_a.v[c] = b->acceleration_a[c][l];
+			}
+			a3real4Normalize(rb->rotation.v);
+			a3real4Normalize(rb->velocity_a.v);
+			a3real4Normalize(rb->acceleration_a.v);
+		}
+	}
+}
+
+// internal helper: step a lane group once
+void a3physicsBatchStepLanes_internal(a3_PhysicsWorld *world, const double *dt, const unsigned int lanes)
+{
+	a3real h[a3physicsBatchMaxCount_lane];
+	unsigned int substeps[a3physicsBatchMaxCount_lane];
+	unsigned int l, j, k, substepsMax;
+
+	for (l = 0; l < lanes; ++l)
+		a3physicsStepBegin(world + l, dt[l]);
+
+	for (k = 0; k < physicsMaxCount_tier; ++k)
+	{
+		// each world schedules its own tiers; a lane sits out the 
+		//	substeps its world does not take
+		for (l = substepsMax = 0; l < lanes; ++l)
+		{
+			h[l] = a3physicsStepTier(world + l, k);
+			substeps[l] = world[l].substeps > 1 ? world[l].substeps : 1;
+			if (h[l] > a3realZero)
+				substepsMax = a3maximum(substepsMax, substeps[l]);
+		}
+		for (j = 0; j < substepsMax; ++j)
+		{
+			for (l = 0; l < lanes; ++l)
+				if (j >= substeps[l])
+					h[l] = a3realZero;
+			for (l = 0; l < lanes; ++l)
+				if (h[l] > a3realZero)
+					a3physicsStepSolve(world + l, h[l]);
+			a3physicsBatchIntegrate_internal(world, lanes, h);
+			if (k == 0)
+				for (l = 0; l < lanes; ++l)
+					if (h[l] > a3realZero)
+						a3physicsStepParticles(world + l, h[l]);
+		}
+	}
+
+	for (l = 0; l < lanes; ++l)
+		a3physicsStepEnd(world + l, dt[l]);
+}
+
+// internal job: step worlds (or lane groups) [begin, end)
+void a3physicsBatchWork_internal(const a3_PhysicsBatchTask *task, const unsigned int begin, const unsigned int end)
+{
+	a3_PhysicsBatch *const batch = task->batch;
+	unsigned int g, i, s, lanes;
+	if (batch->lanes)
+	{
+		for (g = begin; g < end; ++g)
+		{
+			i = g * a3physicsBatchMaxCount_lane;
+			lanes = a3minimum(batch->count - i, (unsigned int)a3physicsBatchMaxCount_lane);
+			for (s = 0; s < task->steps; ++s)
+				a3physicsBatchStepLanes_internal(batch->world + i, batch->dt + i, lanes);
+		}
+	}
+	else
+	{
+		for (i = begin; i < end; ++i)
+			for (s = 0; s < task->steps; ++s)
+				a3physicsUpdate(batch->world + i, batch->dt[i]);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3physicsBatchCreate(a3_PhysicsBatch *batch_out, const unsigned int count, a3_JobSystem *jobs)
+{
+	if (batch_out && !batch_out->memory && count)
+	{
+		const size_t size = (sizeof(a3_PhysicsWorld) + sizeof(double)) * count;
+		unsigned int i;
+		batch_out->memory = malloc(size);
+		if (batch_out->memory)
+		{
+			memset(batch_out->memory, 0, size);
+			batch_out->world = (a3_PhysicsWorld *)batch_out->memory;
+			batch_out->dt = (double *)(batch_out->world + count);
+			for (i = 0; i < count; ++i)
+				batch_out->dt[i] = 1.0 / 60.0;
+			batch_out->count = count;
+			batch_out->lanes = 0;
+			batch_out->jobs = jobs;
+			batch_out->steps = 0;
+			batch_out->time = 0.0;
+			return count;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3physicsBatchInitialize(a3_PhysicsBatch *batch)
+{
+	if (batch && batch->memory)
+	{
+		unsigned int i;
+		for (i = 0; i < batch->count; ++i)
+			a3physicsWorldInitialize(batch->world + i);
+		return batch->count;
+	}
+	return -1;
+}
+
+extern inline int a3physicsBatchRelease(a3_PhysicsBatch *batch)
+{
+	if (batch && batch->memory)
+	{
+		unsigned int i;
+		for (i = 0; i < batch->count; ++i)
+			if (batch->world[i].init)
+				a3physicsWorldTerminate(batch->world + i);
+		free(batch->memory);
+		batch->memory = 0;
+		batch->world = 0;
+		batch->dt = 0;
+		batch->count = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3physicsBatchStep(a3_PhysicsBatch *batch, const unsigned int steps)
+{
+	if (batch && batch->memory)
+	{
+		// one job per world or lane group: worlds are small, so 
+		//	even one is worth handing to another thread
+		const unsigned int jobCount = batch->lanes ? (batch->count + a3physicsBatchMaxCount_lane - 1) / a3physicsBatchMaxCount_lane : batch->count;
+		a3_PhysicsBatchTask task[1];
+		a3_Timer timer[1] = { 0 };
+
+		task->batch = batch;
+		task->steps = steps;
+		a3timerSet(timer, 0.0);
+		a3timerStart(timer);
+		a3jobParallelFor(batch->jobs, (a3_JobFunc)a3physicsBatchWork_internal, task, jobCount, 1);
+		a3timerUpdate(timer);
+
+		batch->steps += (unsigned long long)(batch->count) * steps;
+		batch->time += timer->previousTick;
+		return batch->count * steps;
+	}
+	return -1;
+}
+
+extern inline double a3physicsBatchThroughput(const a3_PhysicsBatch *batch)
+{
+	if (batch && batch->time > 0.0)
+		return (double)(batch->steps) / batch->time;
+	return 0.0;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,138 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_PhysicsBatch.h
+	Batch of physics worlds stepped together on a job system.
+*/
+
+#ifndef __ANIMAL3D_PHYSICSBATCH_H
+#define __ANIMAL3D_PHYSICSBATCH_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_PhysicsWorld.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_PhysicsBatchTask			a3_PhysicsBatchTask;
+	typedef struct a3_PhysicsBatch				a3_PhysicsBatch;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_PhysicsBatchLimits
+	{
+		// worlds a lane group steps in lockstep (one per SIMD lane 
+		//	of the widest registers the integration loops fill)
+		a3physicsBatchMaxCount_lane = 8,
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// steps handed to the job system
+	struct a3_PhysicsBatchTask
+	{
+		a3_PhysicsBatch *batch;
+		unsigned int steps;
+	};
+
+	// batch of worlds
+	//	- worlds are packed contiguously in one allocation and each 
+	//		steps by its own dt; a job runs one world (or one lane 
+	//		group) for all of a call's steps, so worlds never share 
+	//		a thread mid-step and their own jobs stay null
+	//	- each world's content comes from its scene builder (world 
+	//		scene and sceneUser, set with its other config fields), 
+	//		so a batch of small worlds holds a few bodies each; a 
+	//		world left without one builds the whole demo scene
+	//	- every world is still a whole a3_PhysicsWorld, sized for 
+	//		physicsMaxCount_rigidbody bodies, the broadphase cells 
+	//		and the contact solver (on the order of 128 KB) however 
+	//		few bodies its scene adds; storage is not trimmed to 
+	//		what each world uses
+	//	- lanes: worlds are grouped a3physicsBatchMaxCount_lane at 
+	//		a time and stepped in lockstep; only integration is 
+	//		vectorized: contacts and the solver still run world by 
+	//		world, but each substep integrates every body slot of 
+	//		the group at once, component by component across worlds 
+	//		(results match stepping the worlds one at a time)
+	//	- steps and time count world-steps taken and seconds spent 
+	//		taking them, for throughput
+	struct a3_PhysicsBatch
+	{
+		a3_PhysicsWorld *world;
+		double *dt;
+		unsigned int count;
+
+		// lane mode (0 to step worlds one at a time)
+		int lanes;
+
+		// job system worlds are spread over (null to step here)
+		a3_JobSystem *jobs;
+
+		unsigned long long steps;
+		double time;
+
+		// allocation holding worlds and steps
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create batch of zeroed worlds stepping 1/60 s each (allocates; 
+	//	call once at startup)
+	//	- set each world's config fields (scene builder included) and 
+	//		dt, then initialize
+	inline int a3physicsBatchCreate(a3_PhysicsBatch *batch_out, const unsigned int count, a3_JobSystem *jobs);
+
+	// create every world's content from its scene builder
+	inline int a3physicsBatchInitialize(a3_PhysicsBatch *batch);
+
+	// destroy every world's content and release batch memory
+	inline int a3physicsBatchRelease(a3_PhysicsBatch *batch);
+
+	// advance every world by the given number of its steps
+	//	- returns the number of world-steps taken
+	inline int a3physicsBatchStep(a3_PhysicsBatch *batch, const unsigned int steps);
+
+	// world-steps per second over every step taken so far
+	inline double a3physicsBatchThroughput(const a3_PhysicsBatch *batch);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PHYSICSBATCH_H
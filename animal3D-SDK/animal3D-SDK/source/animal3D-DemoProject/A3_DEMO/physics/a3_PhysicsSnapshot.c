@@ -0,0 +1,347 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_PhysicsSnapshot.c/.cpp
+	Implementation of shared memory snapshot ring.
+		(readers in other processes build only this file; the state 
+		layout it shares is in a3_PhysicsState.h)
+*/
+
+#include "a3_PhysicsSnapshot.h"
+
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+// platform: barriers and named shared memory
+
+#ifdef _WIN32
+#include <Windows.h>
+
+void a3physicsSnapshotBarrier_internal()
+{
+	MemoryBarrier();
+}
+
+void *a3physicsSnapshotMapCreate_internal(const char *name, const size_t size, void **mapping_out)
+{
+	const unsigned long long size64 = size;
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE, (DWORD)(size64 >> 32), (DWORD)(size64), name);
+	void *base;
+	if (!mapping)
+		return 0;
+
+	// a name cannot be replaced while anything holds it open, as 
+	//	POSIX replaces it below; rather than clear a ring another 
+	//	writer (or readers of a released one) still maps, leave it
+	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		CloseHandle(mapping);
+		return 0;
+	}
+
+	base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (!base)
+	{
+		CloseHandle(mapping);
+		return 0;
+	}
+	*mapping_out = mapping;
+	return base;
+}
+
+void *a3physicsSnapshotMapOpen_internal(const char *name, size_t *size_out, void **mapping_out)
+{
+	MEMORY_BASIC_INFORMATION info[1];
+	HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+	void *base;
+	if (!mapping)
+		return 0;
+	base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!base || !VirtualQuery(base, info, sizeof(info)))
+	{
+		if (base)
+			UnmapViewOfFile(base);
+		CloseHandle(mapping);
+		return 0;
+	}
+	*size_out = info->RegionSize;
+	*mapping_out = mapping;
+	return base;
+}
+
+void a3physicsSnapshotUnmap_internal(void *base, const size_t size, void *mapping, const char *name, const int writer)
+{
+	// the mapping goes when its last handle closes
+	UnmapViewOfFile(base);
+	CloseHandle(mapping);
+}
+
+#else	// !_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void a3physicsSnapshotBarrier_internal()
+{
+	__sync_synchronize();
+}
+
+void *a3physicsSnapshotMapCreate_internal(const char *name, const size_t size, void **mapping_out)
+{
+	void *base;
+	int fd;
+
+	// a ring left by a writer that did not release it is replaced; 
+	//	readers still mapping it see no more snapshots and reopen
+	shm_unlink(name);
+	fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0)
+		return 0;
+	if (ftruncate(fd, (off_t)(size)))
+	{
+		close(fd);
+		shm_unlink(name);
+		return 0;
+	}
+	base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+	{
+		shm_unlink(name);
+		return 0;
+	}
+	*mapping_out = 0;
+	return base;
+}
+
+void *a3physicsSnapshotMapOpen_internal(const char *name, size_t *size_out, void **mapping_out)
+{
+	struct stat info[1];
+	void *base;
+	const int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return 0;
+	if (fstat(fd, info) || info->st_size <= 0)
+	{
+		close(fd);
+		return 0;
+	}
+	base = mmap(0, (size_t)(info->st_size), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return 0;
+	*size_out = (size_t)(info->st_size);
+	*mapping_out = 0;
+	return base;
+}
+
+void a3physicsSnapshotUnmap_internal(void *base, const size_t size, void *mapping, const char *name, const int writer)
+{
+	munmap(base, size);
+	if (writer)
+		shm_unlink(name);
+}
+
+#endif	// _WIN32
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper: slot by index
+inline a3_PhysicsSnapshotSlot *a3physicsSnapshotSlot_internal(const a3_PhysicsSnapshotRing *ring, const unsigned int index)
+{
+	return (a3_PhysicsSnapshotSlot *)(ring->slot + (size_t)(ring->header->slotSize) * index);
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3physicsSnapshotCreate(a3_PhysicsSnapshotRing *ring_out, const char *name, const unsigned int slotCount)
+{
+	if (ring_out && !ring_out->header && name && strlen(name) < sizeof(ring_out->name) && slotCount >= a3physicsSnapshotMinCount_slot && slotCount <= a3physicsSnapshotMaxCount_slot)
+	{
+		// header gets a cache line of its own too
+		const unsigned int slotSize = (sizeof(a3_PhysicsSnapshotSlot) + a3physicsSnapshotAlign_slot - 1) / a3physicsSnapshotAlign_slot * a3physicsSnapshotAlign_slot;
+		const size_t size = a3physicsSnapshotAlign_slot + (size_t)(slotSize) * slotCount;
+		void *mapping = 0;
+		void *base = a3physicsSnapshotMapCreate_internal(name, size, &mapping);
+		if (base)
+		{
+			memset(base, 0, size);
+			ring_out->header = (a3_PhysicsSnapshotHeader *)base;
+			ring_out->slot = (unsigned char *)base + a3physicsSnapshotAlign_slot;
+			ring_out->size = size;
+			ring_out->mapping = mapping;
+			ring_out->writer = 1;
+			strcpy(ring_out->name, name);
+
+			// magic goes in last, so a reader opening the ring while 
+			//	it is being set up does not trust it yet
+			ring_out->header->layout = sizeof(a3_PhysicsWorldState);
+			ring_out->header->slotCount = slotCount;
+			ring_out->header->slotSize = slotSize;
+			ring_out->header->written = 0;
+			a3physicsSnapshotBarrier_internal();
+			ring_out->header->magic = a3physicsSnapshotMagic;
+			return slotCount;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3physicsSnapshotWrite(a3_PhysicsSnapshotRing *ring, const a3_PhysicsWorldState *state)
+{
+	if (ring && ring->header && ring->writer && state)
+	{
+		// the slot after the newest is the oldest
+		const unsigned int written = ring->header->written;
+		a3_PhysicsSnapshotSlot *const slot = a3physicsSnapshotSlot_internal(ring, written % ring->header->slotCount);
+		const unsigned int sequence = slot->sequence;
+
+		// odd while writing, even again after; then publish the slot
+		slot->sequence = sequence + 1;
+		a3physicsSnapshotBarrier_internal();
+		memcpy(&slot->state, state, sizeof(a3_PhysicsWorldState));
+		a3physicsSnapshotBarrier_internal();
+		slot->sequence = sequence + 2;
+		a3physicsSnapshotBarrier_internal();
+		ring->header->written = written + 1;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3physicsSnapshotOpen(a3_PhysicsSnapshotRing *ring_out, const char *name)
+{
+	if (ring_out && !ring_out->header && name && strlen(name) < sizeof(ring_out->name))
+	{
+		const a3_PhysicsSnapshotHeader *header;
+		size_t size = 0;
+		void *mapping = 0;
+		void *base = a3physicsSnapshotMapOpen_internal(name, &size, &mapping);
+		if (base)
+		{
+			// only trust a ring laid out like ours
+			header = (const a3_PhysicsSnapshotHeader *)base;
+			if (size >= a3physicsSnapshotAlign_slot && 
+				header->magic == a3physicsSnapshotMagic && 
+				header->layout == sizeof(a3_PhysicsWorldState) && 
+				header->slotSize >= sizeof(a3_PhysicsSnapshotSlot) && 
+				header->slotCount >= a3physicsSnapshotMinCount_slot && header->slotCount <= a3physicsSnapshotMaxCount_slot && 
+				size >= a3physicsSnapshotAlign_slot + (size_t)(header->slotSize) * header->slotCount)
+			{
+				ring_out->header = (a3_PhysicsSnapshotHeader *)base;
+				ring_out->slot = (unsigned char *)base + a3physicsSnapshotAlign_slot;
+				ring_out->size = size;
+				ring_out->mapping = mapping;
+				ring_out->writer = 0;
+				strcpy(ring_out->name, name);
+				return 1;
+			}
+			a3physicsSnapshotUnmap_internal(base, size, mapping, name, 0);
+		}
+		return 0;
+	}
+	return -1;
+}
+
+extern inline int a3physicsSnapshotAcquire(const a3_PhysicsSnapshotRing *ring, a3_PhysicsSnapshotView *view_out)
+{
+	if (ring && ring->header && view_out)
+	{
+		const a3_PhysicsSnapshotSlot *slot;
+		unsigned int written, index, sequence, attempt;
+		for (attempt = 0; attempt < a3physicsSnapshotMaxCount_attempt; ++attempt)
+		{
+			written = ring->header->written;
+			a3physicsSnapshotBarrier_internal();
+			if (!written)
+				return 0;
+
+			// an odd sequence means the writer has lapped the ring 
+			//	since the count was read: take the newer one
+			index = (written - 1) % ring->header->slotCount;
+			slot = a3physicsSnapshotSlot_internal(ring, index);
+			sequence = slot->sequence;
+			a3physicsSnapshotBarrier_internal();
+			if (!(sequence & 1u))
+			{
+				view_out->state = &slot->state;
+				view_out->slot = index;
+				view_out->sequence = sequence;
+				return 1;
+			}
+		}
+
+		// the writer keeps lapping the ring or stopped mid-write
+		return 0;
+	}
+	return -1;
+}
+
+extern inline int a3physicsSnapshotValidate(const a3_PhysicsSnapshotRing *ring, const a3_PhysicsSnapshotView *view)
+{
+	if (ring && ring->header && view && view->state)
+	{
+		a3physicsSnapshotBarrier_internal();
+		return (a3physicsSnapshotSlot_internal(ring, view->slot)->sequence == view->sequence);
+	}
+	return -1;
+}
+
+extern inline int a3physicsSnapshotRead(const a3_PhysicsSnapshotRing *ring, a3_PhysicsWorldState *state_out)
+{
+	if (ring && ring->header && state_out)
+	{
+		a3_PhysicsSnapshotView view[1];
+		unsigned int attempt;
+		for (attempt = 0; attempt < a3physicsSnapshotMaxCount_attempt; ++attempt)
+		{
+			if (a3physicsSnapshotAcquire(ring, view) <= 0)
+				return 0;
+			memcpy(state_out, view->state, sizeof(a3_PhysicsWorldState));
+			if (a3physicsSnapshotValidate(ring, view) > 0)
+				return state_out->version;
+		}
+		return 0;
+	}
+	return -1;
+}
+
+extern inline int a3physicsSnapshotRelease(a3_PhysicsSnapshotRing *ring)
+{
+	if (ring && ring->header)
+	{
+		a3physicsSnapshotUnmap_internal(ring->header, ring->size, ring->mapping, ring->name, ring->writer);
+		ring->header = 0;
+		ring->slot = 0;
+		ring->size = 0;
+		ring->mapping = 0;
+		ring->writer = 0;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,162 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_PhysicsSnapshot.h
+	Ring of world state snapshots in shared memory, written by the 
+		physics thread and read by other processes without locks.
+*/
+
+#ifndef __ANIMAL3D_PHYSICSSNAPSHOT_H
+#define __ANIMAL3D_PHYSICSSNAPSHOT_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_PhysicsState.h"
+
+#include <stddef.h>
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_PhysicsSnapshotHeader		a3_PhysicsSnapshotHeader;
+	typedef struct a3_PhysicsSnapshotSlot		a3_PhysicsSnapshotSlot;
+	typedef struct a3_PhysicsSnapshotRing		a3_PhysicsSnapshotRing;
+	typedef struct a3_PhysicsSnapshotView		a3_PhysicsSnapshotView;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_PhysicsSnapshotLimits
+	{
+		// slots a ring can hold; a reader has this many snapshots' 
+		//	time to finish with one before it is overwritten, so it 
+		//	needs at least two: one to read while the next is written
+		a3physicsSnapshotMinCount_slot = 2,
+		a3physicsSnapshotMaxCount_slot = 256,
+
+		// tries a reader takes at a snapshot before giving up on a 
+		//	writer that keeps overwriting it or stopped mid-write
+		a3physicsSnapshotMaxCount_attempt = 64,
+
+		// slots start on cache lines so writes to one do not 
+		//	disturb readers of its neighbors
+		a3physicsSnapshotAlign_slot = 64,
+
+		// "A3PS": identifies a mapping as a snapshot ring
+		a3physicsSnapshotMagic = 0x53503341,
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// shared memory layout: header, then slots at a stride of 
+	//	slotSize bytes
+	//	- written counts snapshots; the newest is in slot 
+	//		(written - 1) % slotCount
+	//	- readers check magic and layout (the size of a state) 
+	//		before trusting the rest
+	struct a3_PhysicsSnapshotHeader
+	{
+		unsigned int magic, layout;
+		unsigned int slotCount, slotSize;
+		volatile unsigned int written;
+	};
+
+	// slot: a state and its sequence, odd while the state is being 
+	//	written (a sequence lock: a read is good if the sequence is 
+	//	even and unchanged across it)
+	struct a3_PhysicsSnapshotSlot
+	{
+		volatile unsigned int sequence;
+		a3_PhysicsWorldState state;
+	};
+
+	// a process's handle to a ring (writer or reader)
+	struct a3_PhysicsSnapshotRing
+	{
+		a3_PhysicsSnapshotHeader *header;
+		unsigned char *slot;
+		size_t size;
+		void *mapping;
+		int writer;
+		char name[64];
+	};
+
+	// snapshot being read in place
+	struct a3_PhysicsSnapshotView
+	{
+		const a3_PhysicsWorldState *state;
+		unsigned int slot, sequence;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// writer: create a named ring of slotCount slots (POSIX shared 
+	//	memory object or Windows file mapping; the name starts with 
+	//	a slash and has no others)
+	//	- POSIX replaces a ring left under the name (readers still 
+	//		mapping it keep the old one); Windows cannot replace one 
+	//		something still maps, so creating fails instead
+	inline int a3physicsSnapshotCreate(a3_PhysicsSnapshotRing *ring_out, const char *name, const unsigned int slotCount);
+
+	// writer: copy a state into the next slot and make it the newest
+	//	- never waits on readers
+	inline int a3physicsSnapshotWrite(a3_PhysicsSnapshotRing *ring, const a3_PhysicsWorldState *state);
+
+	// reader: map a ring created by another process, read only
+	//	- returns 0 if there is none or its layout differs from ours
+	inline int a3physicsSnapshotOpen(a3_PhysicsSnapshotRing *ring_out, const char *name);
+
+	// reader: view the newest snapshot in place (no copy), then 
+	//	check the view is still good once done with it; a view that 
+	//	is not was overwritten while being read and is taken again
+	//	- acquire returns 0 if nothing has been written yet, or if 
+	//		no snapshot could be taken in a3physicsSnapshotMaxCount_attempt 
+	//		tries
+	inline int a3physicsSnapshotAcquire(const a3_PhysicsSnapshotRing *ring, a3_PhysicsSnapshotView *view_out);
+	inline int a3physicsSnapshotValidate(const a3_PhysicsSnapshotRing *ring, const a3_PhysicsSnapshotView *view);
+
+	// reader: copy the newest snapshot out, retrying until the copy 
+	//	is good (returns its version, or 0 if nothing was written or 
+	//	no copy was good in a3physicsSnapshotMaxCount_attempt tries)
+	inline int a3physicsSnapshotRead(const a3_PhysicsSnapshotRing *ring, a3_PhysicsWorldState *state_out);
+
+	// unmap a ring; the writer also removes its name
+	inline int a3physicsSnapshotRelease(a3_PhysicsSnapshotRing *ring);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PHYSICSSNAPSHOT_H
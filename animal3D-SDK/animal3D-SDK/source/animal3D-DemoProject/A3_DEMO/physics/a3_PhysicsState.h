@@ -0,0 +1,148 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_PhysicsState.h
+	Published physics world state: rigid body poses and counts, as 
+		shared by the physics thread, the demo and snapshot readers.
+*/
+
+#ifndef __ANIMAL3D_PHYSICSSTATE_H
+#define __ANIMAL3D_PHYSICSSTATE_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "animal3D/a3math/A3DM.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_PhysicsPose					a3_PhysicsPose;
+	typedef struct a3_PhysicsWorldState				a3_PhysicsWorldState;
+	typedef struct a3_PhysicsWorldStateEntry		a3_PhysicsWorldStateEntry;
+	typedef struct a3_PhysicsWorldStateDelta		a3_PhysicsWorldStateDelta;
+	typedef struct a3_PhysicsWorldTransforms		a3_PhysicsWorldTransforms;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// counters
+	enum a3_PhysicsStateMaxCount
+	{
+		physicsMaxCount_rigidbody = 32,
+	};
+
+	// sets of bodies (publication bookkeeping, the mask of 
+	//	a3physicsWorldStateExpand and the demo's visible bodies) are 
+	//	one bit per body in a 32-bit unsigned int; this fails to 
+	//	compile if the cap outgrows one rather than shifting bodies 
+	//	out of it
+	typedef char a3_PhysicsStateBodyMaskCheck[(physicsMaxCount_rigidbody <= 32) ? 1 : -1];
+
+
+//-----------------------------------------------------------------------------
+
+	// pose of a rigid body: rotation and position (28 bytes)
+	struct a3_PhysicsPose
+	{
+		a3vec4 rotation;
+		a3vec3 position;
+	};
+
+	// state of a physics world: things that can be used for graphics ONLY
+	//	- position and rotation... why not scale? RIGID bodies don't scale
+	//	- bodies are published as poses; transforms are expanded 
+	//		from them where they are needed (see 
+	//		a3physicsWorldStateExpand), which keeps states a fifth 
+	//		of the size they would be with matrices
+	struct a3_PhysicsWorldState
+	{
+		a3_PhysicsPose pose_rb[physicsMaxCount_rigidbody];
+
+		// current counts
+		//	(particle, fluid, cloth, position-based and orbit 
+		//	positions are published in bulk to the world's 
+		//	particlePosition, fluidPosition, clothPosition, 
+		//	positionBasedPosition and orbitPosition buffers alongside 
+		//	this state)
+		unsigned int count_p, count_rb, count_f, count_c, count_pb, count_o;
+
+		// simulation time this state describes
+		double t;
+
+		// publication: number of this state (from 1; 0 before the 
+		//	first), the publication each body's entries last changed 
+		//	in, and whether this one rewrote every entry (a keyframe)
+		//	- a copy at version v is brought up to date by copying 
+		//		the entries changed after v (a3physicsWorldStateSync)
+		unsigned int version;
+		unsigned int version_rb[physicsMaxCount_rigidbody];
+		int keyframe;
+	};
+
+	// one body's entries of a state
+	struct a3_PhysicsWorldStateEntry
+	{
+		unsigned int index, version;
+		a3_PhysicsPose pose;
+	};
+
+	// entries of a state that changed after version base, packed 
+	//	for recording (base 0 for every entry: a keyframe)
+	//	- a recorder keeps the first entryCount entries (see 
+	//		a3physicsWorldStateDeltaSize); playback starts from a 
+	//		keyframe and applies each delta in turn
+	struct a3_PhysicsWorldStateDelta
+	{
+		unsigned int count_p, count_rb, count_f, count_c, count_pb, count_o;
+		double t;
+		unsigned int version, base;
+		unsigned int entryCount;
+		a3_PhysicsWorldStateEntry entry[physicsMaxCount_rigidbody];
+	};
+
+	// rigid body transforms and inverses expanded from a state's 
+	//	poses, with the version of the pose each was expanded from 
+	//	(0 for one expanded every time), so expanding again only 
+	//	redoes poses that changed
+	struct a3_PhysicsWorldTransforms
+	{
+		a3mat4 transform_rb[physicsMaxCount_rigidbody];
+		a3mat4 transformInv_rb[physicsMaxCount_rigidbody];
+		unsigned int version_rb[physicsMaxCount_rigidbody];
+	};
+
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_PHYSICSSTATE_H
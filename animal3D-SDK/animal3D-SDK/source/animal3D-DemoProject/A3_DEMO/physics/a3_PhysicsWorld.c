@@ -29,6 +29,7 @@
 */
 
 #include "a3_PhysicsWorld.h"
+#include "a3_PhysicsSnapshot.h"
 
 // include utilities on an as-needed basis
 #include "animal3D/a3utility/a3_Timer.h"
@@ -36,6 +37,8 @@
 
 // external
 #include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 
 
@@ -64,7 +67,6 @@ int setupBSPs(a3_PhysicsWorld * world, a3real3p min, a3real3p max, a3real3p unit
 		{
 			for (int z = 0; z < (int)boxUnits.z; ++z)
 			{
-				++num;
 				tmpMin.x = min[0] + x * units[0];
 				tmpMin.y = min[1] + y * units[1];
 				tmpMin.z = min[2] + z * units[2];
@@ -72,6 +74,7 @@ int setupBSPs(a3_PhysicsWorld * world, a3real3p min, a3real3p max, a3real3p unit
 				a3real3Sum(tmpMax.v, tmpMin.v, units);
 
 				setupBSP(world->bsps + num, tmpMin.v, tmpMax.v);
+				++num;
 			}
 		}
 	}
@@ -88,6 +91,16 @@ int updateHulls(a3_PhysicsWorld * world)
 
 	for (unsigned int i = 0; i < world->rigidbodiesActive; ++i)
 	{
+		// sleeping bodies stay in the cell they fell asleep in
+		if (world->rigidbody[i].sleeping && world->bspIndex_rb[i] < world->numBSPs)
+		{
+			BSP *bsp = world->bsps + world->bspIndex_rb[i];
+			bsp->containedHulls[bsp->numContainedHulls] = world->hull + i;
+			++bsp->numContainedHulls;
+			continue;
+		}
+
+		world->bspIndex_rb[i] = world->numBSPs;
 		for (unsigned int j = 0; j < world->numBSPs; ++j)
 		{
 			if (world->hull[i].type == a3hullType_plane)
@@ -101,6 +114,7 @@ int updateHulls(a3_PhysicsWorld * world)
 			{
 				world->bsps[j].containedHulls[world->bsps[j].numContainedHulls] = world->hull + i;
 				++world->bsps[j].numContainedHulls;
+				world->bspIndex_rb[i] = j;
 				break;
 			}
 		}
@@ -110,28 +124,73 @@ int updateHulls(a3_PhysicsWorld * world)
 
 
 
-// internal utility for initializing and terminating physics world
-void a3physicsInitialize_internal(a3_PhysicsWorld *world)
+// internal utility to write body state for graphics, and the 
+//	transforms hulls read
+//	- returns the bodies whose entries changed (all of them if 'all')
+unsigned int a3physicsWriteState_internal(const a3_PhysicsWorld *world, a3_PhysicsWorldState *state, a3_PhysicsWorldTransforms *transforms, const int all)
 {
-	//unsigned int i, j;
+	a3_PhysicsPose *pose;
+	unsigned int i, dirty = 0;
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+	{
+		// sleeping bodies have not moved since they were last written
+		if (world->rigidbody[i].sleeping)
+			continue;
+
+		// neither have resting ones that have yet to fall asleep
+		pose = state->pose_rb + i;
+		if (!all && 
+			pose->position.x == world->rigidbody[i].position.x &&
+			pose->position.y == world->rigidbody[i].position.y &&
+			pose->position.z == world->rigidbody[i].position.z &&
+			pose->rotation.x == world->state->pose_rb[i].rotation.x &&
+			pose->rotation.y == world->state->pose_rb[i].rotation.y &&
+			pose->rotation.z == world->state->pose_rb[i].rotation.z &&
+			pose->rotation.w == world->state->pose_rb[i].rotation.w)
+			continue;
+		dirty |= 1u << i;
+
+		pose->position = world->rigidbody[i].position;
+		pose->rotation = world->state->pose_rb[i].rotation;
 
-	// e.g. reset all particles and/or rigid bodies
-	memset(world->rigidbody, 0, sizeof(world->rigidbody));
-	memset(world->particle, 0, sizeof(world->particle));
-	world->t = 0.0;
+		// rotation
+		a3quaternionConvertToMat4(transforms->transform_rb[i].m, pose->rotation.v, pose->position.v);
+		a3real4x4TransformInverseIgnoreScale(transforms->transformInv_rb[i].m, transforms->transform_rb[i].m);
+	}
+	state->count_rb = i;
+	state->count_p = world->particlePool->count;
+	state->count_f = world->fluid->pool->count;
+	state->count_c = world->cloth->particleCount;
+	state->count_pb = world->positionBased->pool->count;
+	state->count_o = world->orbitPool->count;
+	return dirty;
+}
 
-	// using random rotation
-	a3randomSetSeed(0);
 
+// internal helper: add a distance constraint between two particles 
+//	unless one added since 'first' already links them (tetrahedra 
+//	share edges)
+int a3physicsAddEdgeOnce_internal(a3_PositionBasedSolver *pb, const unsigned int first, const unsigned int a, const unsigned int b, const a3real compliance)
+{
+	const a3_PositionConstraint *constraint;
+	unsigned int i;
+	for (i = first, constraint = pb->constraint + first; i < pb->constraintCount; ++i, ++constraint)
+		if (constraint->type == a3positionConstraint_distance &&
+			((constraint->particle[0] == a && constraint->particle[1] == b) || (constraint->particle[0] == b && constraint->particle[1] == a)))
+			return i;
+	return a3positionBasedAddDistance(pb, a, b, compliance);
+}
 
+// internal scene builder: the demo scene, a box of six planes with 
+//	spheres falling through it and a chain hanging from its ceiling
+void a3physicsSceneDemo_internal(a3_PhysicsWorld *world, void *user)
+{
 	// set up rigid bodies to test ray picking
 	
 	// ****TO-DO: 
 	//	- add rotation to all
 	
 	// static shapes
-	world->rigidbodiesActive = 0;
-	
 	const a3real PLANE_SIZE = 30.0f;
 
 	world->rb_ground[0].position.x = a3realZero;
@@ -140,7 +199,7 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	world->rb_ground[0].velocity.z = 1.0f;
 	a3rigidbodySetMass(world->rb_ground, 0.0f);
 
-	a3collisionCreateHullPlane(world->hull_ground + 0, world->rb_ground + 0, world->state->transform_rb + world->rigidbodiesActive, world->state->transformInv_rb + world->rigidbodiesActive,
+	a3collisionCreateHullPlane(world->hull_ground + 0, world->rb_ground + 0, world->transformWrite->transform_rb + world->rigidbodiesActive, world->transformWrite->transformInv_rb + world->rigidbodiesActive,
 		(a3real)(PLANE_SIZE), (a3real)(PLANE_SIZE), 1, a3axis_z);
 	++world->rigidbodiesActive;
 
@@ -154,9 +213,9 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	axis.y = 1;
 	axis.z = 0;
 
-	a3quaternionCreateAxisAngle(world->state->rotation_rb[world->rigidbodiesActive].v, axis.v, 180.0f);
+	a3quaternionCreateAxisAngle(world->state->pose_rb[world->rigidbodiesActive].rotation.v, axis.v, 180.0f);
 	a3collisionCreateHullPlane(world->hull_ground + world->rigidbodiesActive, world->rb_ground + world->rigidbodiesActive,
-		world->state->transform_rb + world->rigidbodiesActive, world->state->transformInv_rb + world->rigidbodiesActive,
+		world->transformWrite->transform_rb + world->rigidbodiesActive, world->transformWrite->transformInv_rb + world->rigidbodiesActive,
 		(a3real)(PLANE_SIZE), (a3real)(PLANE_SIZE), 1, a3axis_z);
 	++world->rigidbodiesActive;
 
@@ -169,9 +228,9 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	axis.y = 1;
 	axis.z = 0;
 
-	a3quaternionCreateAxisAngle(world->state->rotation_rb[world->rigidbodiesActive].v, axis.v, 90.0f);
+	a3quaternionCreateAxisAngle(world->state->pose_rb[world->rigidbodiesActive].rotation.v, axis.v, 90.0f);
 	a3collisionCreateHullPlane(world->hull_ground + world->rigidbodiesActive, world->rb_ground + world->rigidbodiesActive,
-		world->state->transform_rb + world->rigidbodiesActive, world->state->transformInv_rb + world->rigidbodiesActive,
+		world->transformWrite->transform_rb + world->rigidbodiesActive, world->transformWrite->transformInv_rb + world->rigidbodiesActive,
 		(a3real)(PLANE_SIZE), (a3real)(PLANE_SIZE), 1, a3axis_z);
 	++world->rigidbodiesActive;
 
@@ -184,9 +243,9 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	axis.y = 1;
 	axis.z = 0;
 
-	a3quaternionCreateAxisAngle(world->state->rotation_rb[world->rigidbodiesActive].v, axis.v, 270.0f);
+	a3quaternionCreateAxisAngle(world->state->pose_rb[world->rigidbodiesActive].rotation.v, axis.v, 270.0f);
 	a3collisionCreateHullPlane(world->hull_ground + world->rigidbodiesActive, world->rb_ground + world->rigidbodiesActive,
-		world->state->transform_rb + world->rigidbodiesActive, world->state->transformInv_rb + world->rigidbodiesActive,
+		world->transformWrite->transform_rb + world->rigidbodiesActive, world->transformWrite->transformInv_rb + world->rigidbodiesActive,
 		(a3real)(PLANE_SIZE), (a3real)(PLANE_SIZE), 1, a3axis_z);
 	++world->rigidbodiesActive;
 
@@ -199,9 +258,9 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	axis.y = 0;
 	axis.z = 0;
 
-	a3quaternionCreateAxisAngle(world->state->rotation_rb[world->rigidbodiesActive].v, axis.v, 270.0f);
+	a3quaternionCreateAxisAngle(world->state->pose_rb[world->rigidbodiesActive].rotation.v, axis.v, 270.0f);
 	a3collisionCreateHullPlane(world->hull_ground + world->rigidbodiesActive, world->rb_ground + world->rigidbodiesActive,
-		world->state->transform_rb + world->rigidbodiesActive, world->state->transformInv_rb + world->rigidbodiesActive,
+		world->transformWrite->transform_rb + world->rigidbodiesActive, world->transformWrite->transformInv_rb + world->rigidbodiesActive,
 		(a3real)(PLANE_SIZE), (a3real)(PLANE_SIZE), 1, a3axis_z);
 	++world->rigidbodiesActive;
 
@@ -214,9 +273,9 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	axis.y = 0;
 	axis.z = 0;
 
-	a3quaternionCreateAxisAngle(world->state->rotation_rb[world->rigidbodiesActive].v, axis.v, 90.0f);
+	a3quaternionCreateAxisAngle(world->state->pose_rb[world->rigidbodiesActive].rotation.v, axis.v, 90.0f);
 	a3collisionCreateHullPlane(world->hull_ground + world->rigidbodiesActive, world->rb_ground + world->rigidbodiesActive,
-		world->state->transform_rb + world->rigidbodiesActive, world->state->transformInv_rb + world->rigidbodiesActive,
+		world->transformWrite->transform_rb + world->rigidbodiesActive, world->transformWrite->transformInv_rb + world->rigidbodiesActive,
 		(a3real)(PLANE_SIZE), (a3real)(PLANE_SIZE), 1, a3axis_z);
 	++world->rigidbodiesActive;
 
@@ -238,6 +297,10 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	world->rb_sphere[2].velocity.x = +20;
 	a3rigidbodySetMass(world->rb_sphere + 2, 0.5f);
 
+	// fast movers use continuous collision
+	world->rb_sphere[1].continuous = 1;
+	world->rb_sphere[2].continuous = 1;
+
 	world->rb_sphere[3].position.x = -10.0f;
 	world->rb_sphere[3].position.y = +10.0f;
 	world->rb_sphere[3].position.z = +10.0f;
@@ -250,13 +313,250 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 	a3rigidbodySetMass(world->rb_sphere + 4, 0.75f);
 
 	for (int i = 0; i < 5; ++i, ++world->rigidbodiesActive)
-		a3collisionCreateHullSphere(world->hull_sphere + i, world->rb_sphere + i, world->state->transform_rb + world->rigidbodiesActive,
-			world->state->transformInv_rb + world->rigidbodiesActive,
+		a3collisionCreateHullSphere(world->hull_sphere + i, world->rb_sphere + i, world->transformWrite->transform_rb + world->rigidbodiesActive,
+			world->transformWrite->transformInv_rb + world->rigidbodiesActive,
 			a3randomRange(a3realHalf, a3realTwo));
 
+	// spheres fall and are slowed by air (drag scales with radius), 
+	//	moving with the wind if there is any
+	a3vec3 gravity;
+	a3real3ProductS(gravity.v, a3zVec3.v, (a3real)(-9.80665));
+	const int forceGravity = a3forceRegistryAddGravity(world->forces, gravity.v);
+	const int forceDrag = world->wind->memory ? a3forceRegistryAddWindField(world->forces, world->wind, 1.2f) : a3forceRegistryAddDrag(world->forces, 1.2f);
+	for (int i = 0; i < 5; ++i)
+	{
+		a3forceRegistryAttach(world->forces, forceGravity, (unsigned int)(world->rb_sphere + i - world->rigidbody), a3realOne);
+		a3forceRegistryAttach(world->forces, forceDrag, (unsigned int)(world->rb_sphere + i - world->rigidbody), world->hull_sphere[i].prop[a3hullProperty_radius] * 0.47f);
+	}
+
+	// chain: links hung from the ceiling, the top one on a ball 
+	//	joint, the middle ones held to the xz plane through their 
+	//	neighbors by planar joints and the last on a distance joint; 
+	//	the bottom link starts with a push so the chain swings
+	const a3real linkRadius = a3realHalf, linkSpacing = 1.5f;
+	const a3real linkAxis[3] = { a3realZero, a3realOne, a3realZero };
+	const unsigned int linkCount = sizeof(world->rb_link) / sizeof(*world->rb_link);
+	a3vec3 linkPosition, linkVelocity, anchor_a, anchor_b;
+	int link, linkPrev = -1;
+	for (unsigned int i = 0; i < linkCount; ++i, linkPrev = link)
+	{
+		a3real3Set(linkPosition.v, a3realZero, 20.0f, PLANE_SIZE - linkSpacing * (a3real)(i + 1));
+		a3real3Set(linkVelocity.v, i + 1 < linkCount ? a3realZero : 6.0f, a3realZero, a3realZero);
+		link = a3physicsWorldAddSphere(world, linkPosition.v, linkVelocity.v, 0.25f, linkRadius);
+		if (link < 0)
+			break;
+		a3forceRegistryAttach(world->forces, forceGravity, link, a3realOne);
+		a3forceRegistryAttach(world->forces, forceDrag, link, linkRadius * 0.47f);
+
+		if (linkPrev < 0)
+		{
+			// pivot on the ceiling above the top link
+			a3real3Set(anchor_a.v, linkPosition.x, linkPosition.y, a3realZero);
+			a3real3Set(anchor_b.v, a3realZero, a3realZero, linkSpacing);
+			a3solverAddJointBall(world->solver, world->rb_ground + 1, world->rigidbody + link, anchor_a.v, anchor_b.v);
+		}
+		else if (i + 1 < linkCount)
+			a3solverAddJointPlanar(world->solver, world->rigidbody + linkPrev, world->rigidbody + link, 0, 0, linkAxis);
+		else
+			a3solverAddJointDistance(world->solver, world->rigidbody + linkPrev, world->rigidbody + link, 0, 0);
+	}
+}
+
+// internal utility for initializing and terminating physics world
+void a3physicsInitialize_internal(a3_PhysicsWorld *world)
+{
+	//unsigned int i, j;
+
+	// e.g. reset all particles and/or rigid bodies
+	memset(world->rigidbody, 0, sizeof(world->rigidbody));
+	memset(world->tier_rb, 0, sizeof(world->tier_rb));
+	memset(world->owed_rb, 0, sizeof(world->owed_rb));
+	memset(world->tierTime, 0, sizeof(world->tierTime));
+	world->tierStep = 0;
+	world->t = 0.0;
+	world->rigidbodiesActive = 0;
+
+	// using random rotation
+	a3randomSetSeed(0);
+
+	const a3real PLANE_SIZE = 30.0f;
+
+	// wind: a steady breeze with gusts over the whole box
+	a3vec3 windOrigin;
+	if (world->windSize > 1)
+	{
+		a3real3Set(windOrigin.v, -PLANE_SIZE, -PLANE_SIZE, -PLANE_SIZE);
+		a3windFieldCreate(world->wind, world->windSize, world->windSize, world->windSize, windOrigin.v, PLANE_SIZE * a3realTwo / (a3real)(world->windSize - 1));
+		a3real3Set(world->wind->mean.v, 2.0f, a3realZero, a3realZero);
+		world->wind->turbulence = 3.0f;
+		world->wind->wavelength = 20.0f;
+		world->wind->rate = 0.5f;
+		a3windFieldUpdate(world->wind, a3realZero);
+	}
 
-	// no particles today
-	world->particlesActive = 0;
+	// bodies, hulls, the forces on them and their joints
+	a3forceRegistryReset(world->forces);
+	a3solverReset(world->solver);
+	if (world->scene)
+		world->scene(world, world->sceneUser);
+	else
+		a3physicsSceneDemo_internal(world, 0);
+
+
+	// particle pool and its publication buffer
+	world->emittersActive = 0;
+	if (world->particleCapacity && a3particlePoolCreate(world->particlePool, world->particleCapacity) > 0)
+	{
+		world->particlePosition = (a3real *)malloc(sizeof(a3real) * 3 * world->particlePool->capacity);
+
+		// cells must be larger than a particle moves in a step
+		a3particleCollisionHashCreate(world->particleHash, 16, 2.0f, world->particlePool->capacity);
+
+		// fountain in the middle of the box
+		a3vec3 fountain;
+		a3real3Set(fountain.v, a3realZero, a3realZero, -PLANE_SIZE + a3realOne);
+		a3particleEmitterCreate(world->emitter + world->emittersActive, fountain.v, a3zVec3.v, 15.0f, 20000.0f, 1);
+		a3particleEmitterSetRanges(world->emitter + world->emittersActive, 15.0f, 20.0f, 2.0f, 4.0f);
+		a3real3Set(world->emitter[world->emittersActive].acceleration.v, a3realZero, a3realZero, -9.80665f);
+		++world->emittersActive;
+	}
+
+	// fluid: a block of water released against one wall of the box
+	if (world->fluidCapacity && a3particleFluidCreate(world->fluid, world->fluidCapacity, 0.5f, 1000.0f, world->jobs) > 0)
+	{
+		world->fluidPosition = (a3real *)malloc(sizeof(a3real) * 3 * world->fluid->pool->capacity);
+
+		a3vec3 blockMin, blockMax;
+		world->fluid->stiffness = 600.0f;
+		world->fluid->viscosity = 100.0f;
+		a3real3Set(world->fluid->boundsMin.v, -PLANE_SIZE, -PLANE_SIZE, -PLANE_SIZE);
+		a3real3Set(world->fluid->boundsMax.v, +PLANE_SIZE, +PLANE_SIZE, +PLANE_SIZE);
+		a3real3Set(blockMin.v, -PLANE_SIZE, -10.0f, -PLANE_SIZE);
+		a3real3Set(blockMax.v, -5.0f, +10.0f, -PLANE_SIZE + 3.0f);
+		a3particleFluidAddBlock(world->fluid, blockMin.v, blockMax.v, 0.25f);
+	}
+
+	// cloth: a stiff 10 x 10 sheet hung by two corners
+	if (world->clothSize > 1 && a3clothCreate(world->cloth, world->clothSize * world->clothSize, world->clothSize * world->clothSize * 6) > 0)
+	{
+		world->clothPosition = (a3real *)malloc(sizeof(a3real) * 3 * world->cloth->particleCapacity);
+
+		a3vec3 corner, edgeU, edgeV;
+		a3real3Set(corner.v, -5.0f, 15.0f, 20.0f);
+		a3real3Set(edgeU.v, 10.0f, a3realZero, a3realZero);
+		a3real3Set(edgeV.v, a3realZero, 10.0f, a3realZero);
+		a3clothAddSheet(world->cloth, corner.v, edgeU.v, edgeV.v, world->clothSize, world->clothSize, 0.01f, 5000.0f, 0.5f);
+		a3clothSetMass(world->cloth, 0, a3realZero);
+		a3clothSetMass(world->cloth, world->clothSize - 1, a3realZero);
+		world->cloth->airDamping = 0.01f;
+		world->cloth->integrator = world->clothIntegrator;
+	}
+
+	// position-based: a rope hung from one end, a soft block of 
+	//	tetrahedra and a column of grains, all boxed in
+	if (world->positionBasedCapacity && a3positionBasedCreate(world->positionBased, world->positionBasedCapacity, world->positionBasedCapacity * 16, 0.125f, world->jobs) > 0)
+	{
+		// corners of the five tetrahedra splitting a cube (bit 0 is x, 
+		//	bit 1 is y, bit 2 is z); alternate cells mirror in x so 
+		//	neighbors share face diagonals
+		const unsigned int tetCorner[5][4] = { { 1, 2, 4, 7 }, { 0, 1, 2, 4 }, { 3, 1, 2, 7 }, { 5, 1, 4, 7 }, { 6, 2, 4, 7 } };
+		const unsigned int ropeCount = 32, blockSize = 4, pileSize = 10;
+		a3_PositionBasedSolver *const pb = world->positionBased;
+		unsigned int first, edgeFirst, corner[8], i, j, k, m, n, flip;
+		a3vec3 position, normal;
+
+		world->positionBasedPosition = (a3real *)malloc(sizeof(a3real) * 3 * pb->pool->capacity);
+
+		// walls of the box
+		for (i = 0; i < 6; ++i)
+		{
+			a3real3Set(normal.v, a3realZero, a3realZero, a3realZero);
+			normal.v[i % 3] = i < 3 ? a3realOne : -a3realOne;
+			a3real3ProductS(position.v, normal.v, -PLANE_SIZE);
+			a3positionBasedAddPlane(pb, position.v, normal.v);
+		}
+
+		// rope: stiff links, soft bending; links are longer than a 
+		//	particle's diameter so neighbors do not rub
+		first = pb->pool->count;
+		for (i = 0; i < ropeCount; ++i)
+		{
+			a3real3Set(position.v, 10.0f + (a3real)i * 0.3f, -10.0f, 10.0f);
+			a3positionBasedAddParticle(pb, position.v, i ? 0.05f : a3realZero);
+		}
+		for (i = 0; i + 1 < ropeCount; ++i)
+			a3positionBasedAddDistance(pb, first + i, first + i + 1, a3realZero);
+		for (i = 0; i + 2 < ropeCount; ++i)
+			a3positionBasedAddBending(pb, first + i, first + i + 1, first + i + 2, 0.001f);
+
+		// soft block: lattice cells split into tetrahedra that keep 
+		//	their volume and (more loosely) their edges
+		first = pb->pool->count;
+		for (k = 0; k < blockSize; ++k)
+			for (j = 0; j < blockSize; ++j)
+				for (i = 0; i < blockSize; ++i)
+				{
+					a3real3Set(position.v, 10.0f + (a3real)i, 10.0f + (a3real)j, -PLANE_SIZE + 5.0f + (a3real)k);
+					a3positionBasedAddParticle(pb, position.v, 0.1f);
+				}
+		if (pb->pool->count == first + blockSize * blockSize * blockSize)
+		{
+			edgeFirst = pb->constraintCount;
+			for (k = 0; k + 1 < blockSize; ++k)
+				for (j = 0; j + 1 < blockSize; ++j)
+					for (i = 0; i + 1 < blockSize; ++i)
+					{
+						flip = (i + j + k) & 1;
+						for (m = 0; m < 8; ++m)
+							corner[m ^ flip] = first + (i + (m & 1)) + (j + (m >> 1 & 1)) * blockSize + (k + (m >> 2 & 1)) * blockSize * blockSize;
+						for (m = 0; m < 5; ++m)
+						{
+							a3positionBasedAddVolume(pb, corner[tetCorner[m][0]], corner[tetCorner[m][1]], corner[tetCorner[m][2]], corner[tetCorner[m][3]], 0.0001f);
+							for (n = 0; n < 6; ++n)
+								a3physicsAddEdgeOnce_internal(pb, edgeFirst, corner[tetCorner[m][n < 3 ? 0 : n < 5 ? 1 : 2]], corner[tetCorner[m][n < 3 ? n + 1 : n < 5 ? n - 1 : 3]], 0.001f);
+						}
+					}
+		}
+
+		// grains: a loose column that slumps into a pile
+		for (k = 0; k < pileSize; ++k)
+			for (j = 0; j < pileSize; ++j)
+				for (i = 0; i < pileSize; ++i)
+				{
+					a3real3Set(position.v, -10.0f + (a3real)i * 0.3f, 10.0f + (a3real)j * 0.3f, -PLANE_SIZE + 0.5f + (a3real)k * 0.3f);
+					a3positionBasedAddParticle(pb, position.v, 0.01f);
+				}
+	}
+
+	// orbits: a heavy body circled by a disc of light ones, each 
+	//	started at the circular speed for the mass inside its radius
+	if (world->orbitCapacity > 1 && a3particlePoolCreate(world->orbitPool, world->orbitCapacity) > 0 &&
+		a3barnesHutCreate(world->orbitTree, world->orbitPool->capacity, world->jobs) > 0)
+	{
+		const a3real massCenter = 500.0f, massDisc = 50.0f, radiusMin = 2.0f, radiusMax = 10.0f;
+		const a3real zero[3] = { a3realZero, a3realZero, a3realZero };
+		const unsigned int count = world->orbitPool->capacity;
+		a3real radius, angle, speed;
+		a3vec3 center, position, velocity;
+		unsigned int i;
+
+		world->orbitMass = (a3real *)malloc(sizeof(a3real) * count);
+		world->orbitPosition = (a3real *)malloc(sizeof(a3real) * 3 * count);
+		world->orbitTree->softening = 0.05f;
+
+		a3real3Set(center.v, -15.0f, -15.0f, 15.0f);
+		world->orbitMass[a3particlePoolAdd(world->orbitPool, center.v, zero, zero, a3realZero)] = massCenter;
+		for (i = 1; i < count; ++i)
+		{
+			// uniform over the disc's area
+			radius = (a3real)a3sqrt(a3randomRange(radiusMin * radiusMin, radiusMax * radiusMax));
+			angle = a3randomRange(a3realZero, a3realTwo * a3realPi);
+			speed = (a3real)a3sqrt((massCenter + massDisc * (radius * radius - radiusMin * radiusMin) / (radiusMax * radiusMax - radiusMin * radiusMin)) / radius);
+			a3real3Set(position.v, center.x + radius * a3cosr(angle), center.y + radius * a3sinr(angle), center.z + a3randomRange(-0.1f, 0.1f));
+			a3real3Set(velocity.v, -speed * a3sinr(angle), speed * a3cosr(angle), a3realZero);
+			world->orbitMass[a3particlePoolAdd(world->orbitPool, position.v, velocity.v, zero, a3realZero)] = massDisc / (a3real)(count - 1);
+		}
+	}
 
 	// raise initialized flag
 	world->init = 1;
@@ -267,132 +567,831 @@ void a3physicsInitialize_internal(a3_PhysicsWorld *world)
 
 	setupBSPs(world, min.v, max.v, units.v);
 
-	world->framesSkipped = 0;
-	// reset state
+	// reset state, then publish initial transforms so hulls start 
+	//	where their bodies are instead of at the origin
 	a3physicsWorldStateReset(world->state);
+	a3physicsWriteState_internal(world, world->state, world->transformWrite, 1);
+	*world->statePrev = *world->stateWrite = *world->state;
+	a3physicsWorldStateExpand(world->transform, world->state, ~0u);
+	updateHulls(world);
 }
 
 void a3physicsTerminate_internal(a3_PhysicsWorld *world)
 {
 	// any term tasks here
+	a3particlePoolRelease(world->particlePool);
+	a3particleCollisionHashRelease(world->particleHash);
+	free(world->particlePosition);
+	world->particlePosition = 0;
+	a3particleFluidRelease(world->fluid);
+	free(world->fluidPosition);
+	world->fluidPosition = 0;
+	a3clothRelease(world->cloth);
+	free(world->clothPosition);
+	world->clothPosition = 0;
+	a3positionBasedRelease(world->positionBased);
+	free(world->positionBasedPosition);
+	world->positionBasedPosition = 0;
+	a3windFieldRelease(world->wind);
+	a3barnesHutRelease(world->orbitTree);
+	a3particlePoolRelease(world->orbitPool);
+	free(world->orbitMass);
+	free(world->orbitPosition);
+	world->orbitMass = world->orbitPosition = 0;
 }
 
 
 //-----------------------------------------------------------------------------
 
-void a3handleCollision(a3_ConvexHullCollision* collision, a3_ConvexHull* hull_a, a3_ConvexHull* hull_b)
+// internal utility to check if a body can start an interaction: 
+//	awake and either dynamic or moving
+inline int a3physicsBodyIsAwake_internal(const a3_RigidBody *rb)
 {
-	// http://www.chrishecker.com/images/e/e7/Gdmphys3.pdf
+	return (!rb->sleeping && (rb->massInv > a3realZero || a3rigidbodyIsMoving(rb)));
+}
 
+// internal utility to collide two hulls and record a contact
+//	- the narrowphase dispatches on the first hull's type, so order 
+//		the pair with the "richer" shape first (sphere, box, plane)
+int a3physicsCollideHulls_internal(a3_PhysicsWorld *world, a3_ConvexHullCollision *collision, const a3_ConvexHull *hull_a, const a3_ConvexHull *hull_b, const a3real dt)
+{
+	const a3_ConvexHull *tmp;
 	a3vec3 rVel;
-	a3real3Diff(rVel.v, hull_a->rb->velocity.v, hull_b->rb->velocity.v);
+	a3real margin, period;
+
+	// nothing to do unless one side is awake and can move
+	if (!a3physicsBodyIsAwake_internal(hull_a->rb) && !a3physicsBodyIsAwake_internal(hull_b->rb))
+		return 0;
+
+	if (hull_a->type < hull_b->type)
+	{
+		tmp = hull_a;
+		hull_a = hull_b;
+		hull_b = tmp;
+	}
 
-	a3real j1 = (-a3realTwo * a3real3Dot(rVel.v, collision->normal_a[0].v)) / (a3real3Dot(collision->normal_a[0].v, 
-		collision->normal_a[0].v)*(hull_a->rb->massInv + hull_b->rb->massInv));
+	// speculative margin grows with how far the pair can close before 
+	//	both have stepped again (slow tiers take longer steps)
+	period = (a3real)(1u << a3maximum(world->tier_rb[hull_a->rb - world->rigidbody], world->tier_rb[hull_b->rb - world->rigidbody]));
+	a3real3Diff(rVel.v, hull_a->rb->velocity.v, hull_b->rb->velocity.v);
+	margin = a3minimum(a3real3Length(rVel.v) * dt * period, world->speculativeMargin);
 
-	a3real3Add(hull_a->rb->velocity.v, a3real3ProductS(rVel.v, collision->normal_a[0].v, (j1 * hull_a->rb->massInv)));
-	a3real3Add(hull_b->rb->velocity.v, a3real3ProductS(rVel.v, collision->normal_b[0].v, (j1 * hull_b->rb->massInv)));
+	if (a3collisionTestConvexHullsSpeculative(collision, hull_a, hull_b, margin) > 0)
+		return a3solverAddContact(world->solver, collision);
+	return 0;
 }
 
-// physics simulation
-void a3physicsUpdate(a3_PhysicsWorld *world, double dt)
+// internal utility to get the radius of a sphere around a hull's 
+//	center that holds it (planes span every cell and are not bounded)
+a3real a3physicsHullExtent_internal(const a3_ConvexHull *hull)
 {
-	// copy of state to edit before writing to world
-	a3_PhysicsWorldState state[1] = { 0 };
+	switch (hull->type)
+	{
+	case a3hullType_box:
+		return (a3real)a3sqrt(hull->prop[a3hullProperty_halfwidth] * hull->prop[a3hullProperty_halfwidth] + 
+			hull->prop[a3hullProperty_halfheight] * hull->prop[a3hullProperty_halfheight] + 
+			hull->prop[a3hullProperty_halfdepth] * hull->prop[a3hullProperty_halfdepth]);
+	case a3hullType_sphere:
+		return hull->prop[a3hullProperty_radius];
+	case a3hullType_cylinder:
+		return (a3real)a3sqrt(hull->prop[a3hullProperty_radiusSq] + 
+			hull->prop[a3hullProperty_length] * hull->prop[a3hullProperty_length] * (a3real)(0.25));
+	default:
+		return a3realZero;
+	}
+}
 
-	// time as real
-	const a3real t_r = (a3real)(world->t);
-	const a3real dt_r = (a3real)(dt);
+// internal utility to bound where each body can be at the end of a 
+//	step of dt (longer for slow tiers), for the pipelined broadphase
+//	- a contact changes a body's velocity by at most twice the 
+//		closing speed, which is at most its own speed plus the 
+//		fastest body's; forces add a dt^2; the speculative margin 
+//		covers contacts the next step makes before touching
+void a3physicsPredictReach_internal(a3_PhysicsWorld *world, const a3real dt)
+{
+	a3real speedMax = a3realZero, speed, h;
+	unsigned int i;
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+		speedMax = a3maximum(speedMax, a3real3Length(world->rigidbody[i].velocity.v));
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+	{
+		h = dt * (a3real)(1u << world->tier_rb[i]);
+		speed = a3real3Length(world->rigidbody[i].velocity.v);
+		world->reach_rb[i].xyz = world->rigidbody[i].position;
+		world->reach_rb[i].w = a3physicsHullExtent_internal(world->hull + i) + world->speculativeMargin + 
+			((a3real)(3.0) * speed + a3realTwo * speedMax) * h + 
+			a3real3Length(world->rigidbody[i].force.v) * world->rigidbody[i].massInv * h * h;
+	}
+}
 
-	// generic counter
+// internal job: bin predicted bounds into cells and list the pairs 
+//	sharing one for the next step (one job; the range is unused)
+//	- planes are in every cell that holds another body
+void a3physicsPredictPairs_internal(a3_PhysicsWorld *world, const unsigned int begin, const unsigned int end)
+{
+	unsigned int *const pair = world->pair_rb[world->pairFront ^ 1];
+	unsigned int cell[physicsMaxCount_bsp] = { 0 }, planes = 0, mask;
+	const a3vec4 *reach;
+	const BSP *bsp;
 	unsigned int i, j;
 
+	for (i = 0, reach = world->reach_rb; i < world->rigidbodiesActive; ++i, ++reach)
+	{
+		pair[i] = 0;
+		if (world->hull[i].type == a3hullType_plane)
+		{
+			planes |= 1u << i;
+			continue;
+		}
+		for (j = 0, bsp = world->bsps; j < world->numBSPs; ++j, ++bsp)
+			if (bsp->min.x <= reach->x + reach->w && bsp->max.x >= reach->x - reach->w &&
+				bsp->min.y <= reach->y + reach->w && bsp->max.y >= reach->y - reach->w &&
+				bsp->min.z <= reach->z + reach->w && bsp->max.z >= reach->z - reach->w)
+				cell[j] |= 1u << i;
+	}
 
-	// ****TO-DO: 
-	//	- write to state
+	// each body pairs with the later ones in any cell it is in
+	for (j = 0; j < world->numBSPs; ++j)
+	{
+		mask = cell[j] ? cell[j] | planes : 0;
+		for (i = 0; i < world->rigidbodiesActive; ++i)
+			if (mask >> i & 1u)
+				pair[i] |= mask & ~((2u << i) - 1u);
+	}
+}
+
+// internal utility to find a body's island root (with path halving)
+inline unsigned int a3physicsIslandRoot_internal(unsigned int *island, unsigned int i)
+{
+	while (island[i] != i)
+		i = island[i] = island[island[i]];
+	return i;
+}
+
+// internal utility to join the islands of two interacting bodies
+//	- static bodies do not join islands (they would merge everything), 
+//		but a moving static body wakes what it touches
+void a3physicsIslandLink_internal(a3_PhysicsWorld *world, unsigned int *island, a3_RigidBody *rb_a, a3_RigidBody *rb_b)
+{
+	if (rb_a->massInv > a3realZero && rb_b->massInv > a3realZero)
+		island[a3physicsIslandRoot_internal(island, (unsigned int)(rb_a - world->rigidbody))] =
+			a3physicsIslandRoot_internal(island, (unsigned int)(rb_b - world->rigidbody));
+	else if (rb_a->massInv > a3realZero && rb_a->sleeping && a3rigidbodyIsMoving(rb_b))
+		a3rigidbodyWake(rb_a);
+	else if (rb_b->massInv > a3realZero && rb_b->sleeping && a3rigidbodyIsMoving(rb_a))
+		a3rigidbodyWake(rb_b);
+}
+
+// internal utility to build islands from contacts and joints
+void a3physicsBuildIslands_internal(a3_PhysicsWorld *world, unsigned int *island)
+{
+	unsigned int i;
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+		island[i] = i;
+	for (i = 0; i < world->solver->contactCount; ++i)
+		a3physicsIslandLink_internal(world, island, world->solver->contact[i].rb_a, world->solver->contact[i].rb_b);
+	for (i = 0; i < world->solver->jointCount; ++i)
+		a3physicsIslandLink_internal(world, island, world->solver->joint[i].rb_a, world->solver->joint[i].rb_b);
+}
+
+// internal utility to build islands, then wake islands touched by 
+//	awake bodies and sleep islands at rest
+void a3physicsUpdateIslands_internal(a3_PhysicsWorld *world)
+{
+	unsigned int island[physicsMaxCount_rigidbody];
+	a3real restTime[physicsMaxCount_rigidbody];
+	int awake[physicsMaxCount_rigidbody], asleep[physicsMaxCount_rigidbody];
+	a3_RigidBody *rb;
+	unsigned int i, r;
+
+	if (world->sleepTime <= a3realZero)
+		return;
+
+	a3physicsBuildIslands_internal(world, island);
 	for (i = 0; i < world->rigidbodiesActive; ++i)
 	{
-		state->position_rb[i].xyz = world->rigidbody[i].position;
-		state->rotation_rb[i] = world->state->rotation_rb[i];
+		restTime[i] = world->sleepTime;
+		awake[i] = asleep[i] = 0;
+	}
 
-		// rotation
-		a3quaternionConvertToMat4(state->transform_rb[i].m, state->rotation_rb[i].v, state->position_rb[i].v);
-		a3real4x4TransformInverseIgnoreScale(state->transformInv_rb[i].m, state->transform_rb[i].m);
+	// island is as rested as its least rested body
+	for (i = 0, rb = world->rigidbody; i < world->rigidbodiesActive; ++i, ++rb)
+	{
+		if (rb->massInv <= a3realZero)
+			continue;
+		r = a3physicsIslandRoot_internal(island, i);
+		restTime[r] = a3minimum(restTime[r], rb->restTime);
+		awake[r] |= !rb->sleeping;
+		asleep[r] |= rb->sleeping;
+	}
+
+	// mixed islands wake up; fully rested islands go to sleep
+	for (i = 0, rb = world->rigidbody; i < world->rigidbodiesActive; ++i, ++rb)
+	{
+		if (rb->massInv <= a3realZero)
+			continue;
+		r = a3physicsIslandRoot_internal(island, i);
+		if (awake[r] && asleep[r])
+			a3rigidbodyWake(rb);
+		else if (awake[r] && restTime[r] >= world->sleepTime)
+			a3rigidbodySleep(rb);
+	}
+}
+
+// internal utility to assign rate tiers by distance from the observer
+//	- an island steps with its fastest member so interacting bodies 
+//		always advance together; static bodies step every time
+void a3physicsUpdateTiers_internal(a3_PhysicsWorld *world, const a3real dt)
+{
+	unsigned int island[physicsMaxCount_rigidbody], tier[physicsMaxCount_rigidbody];
+	a3_RigidBody *rb;
+	a3real distance;
+	unsigned int i, k;
+
+	a3physicsBuildIslands_internal(world, island);
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+		tier[i] = physicsMaxCount_tier - 1;
+
+	// tier by distance, island takes the fastest
+	for (i = 0, rb = world->rigidbody; i < world->rigidbodiesActive; ++i, ++rb)
+	{
+		if (rb->massInv <= a3realZero)
+			continue;
+		k = 0;
+		if (world->tierDistance[0] > a3realZero)
+		{
+			distance = a3real3Distance(rb->position.v, world->observer.v);
+			while (k < physicsMaxCount_tier - 1 && distance > world->tierDistance[k])
+				++k;
+		}
+		island[i] = a3physicsIslandRoot_internal(island, i);
+		tier[island[i]] = a3minimum(tier[island[i]], k);
 	}
+	for (i = 0, rb = world->rigidbody; i < world->rigidbodiesActive; ++i, ++rb)
+	{
+		world->tier_rb[i] = rb->massInv > a3realZero ? tier[island[i]] : 0;
 
+		// awake bodies owe this step until their tier takes it
+		world->owed_rb[i] = rb->sleeping ? a3realZero : world->owed_rb[i] + dt;
+	}
+	for (k = 0; k < physicsMaxCount_tier; ++k)
+		world->tierTime[k] += dt;
+}
 
-	a3vec3 tmp;
+// internal utility to hold every body outside tier k for its step
+//	- bodies that just joined from a slower tier owe more than the 
+//		tier step; they coast over the difference first so no time 
+//		is lost (bodies that joined from a faster one gain a little)
+//	- returns the number of bodies stepping
+unsigned int a3physicsHoldTiers_internal(a3_PhysicsWorld *world, const unsigned int k)
+{
+	a3_RigidBody *rb;
+	unsigned int i, count = 0;
+	for (i = 0, rb = world->rigidbody; i < world->rigidbodiesActive; ++i, ++rb)
+	{
+		rb->held = (world->tier_rb[i] != k);
+		if (rb->held)
+			continue;
+		if (world->owed_rb[i] > world->tierTime[k] && !rb->sleeping)
+			a3rigidbodyIntegrateEulerKinematic(rb, world->owed_rb[i] - world->tierTime[k]);
+		world->owed_rb[i] = a3realZero;
+		++count;
+	}
+	return count;
+}
 
-	for (int i = 0; i < 5; i++)
+// internal utility to publish bodies between their tier steps where 
+//	they would be by now, coasting along their velocity
+void a3physicsExtrapolateTiers_internal(const a3_PhysicsWorld *world, a3_PhysicsWorldState *state)
+{
+	a3vec3 offset;
+	unsigned int i;
+	for (i = 0; i < state->count_rb; ++i)
 	{
-		a3forceGravity(tmp.v, a3zVec3.v, world->hull_sphere[i].rb->mass);
-		a3real3Add(world->hull_sphere[i].rb->force.v, tmp.v);
-		a3real3Add(world->hull_sphere[i].rb->force.v,
-			a3forceDrag(tmp.v, world->hull_sphere[i].rb->velocity.v, a3zeroVec3.v, 1.2f, world->hull_sphere[i].prop[a3hullProperty_radius], .47f));
+		if (world->owed_rb[i] <= a3realZero)
+			continue;
+		a3real3ProductS(offset.v, world->rigidbody[i].velocity.v, world->owed_rb[i]);
+		a3real3Add(state->pose_rb[i].position.v, offset.v);
 	}
+}
 
-	state->count_rb = i;
-	for (i = 0; i < world->particlesActive; ++i)
+// internal utility to advance rest timers of awake bodies
+void a3physicsUpdateRest_internal(a3_PhysicsWorld *world, const a3real dt)
+{
+	a3_RigidBody *rb;
+	unsigned int i;
+
+	if (world->sleepTime <= a3realZero)
+		return;
+
+	for (i = 0, rb = world->rigidbody; i < world->rigidbodiesActive; ++i, ++rb)
 	{
-		a3real4SetReal3W(state->position_p[i].v, world->particle[i].position.v, a3realOne);
+		if (rb->massInv <= a3realZero || rb->sleeping || rb->held)
+			continue;
+		if (a3rigidbodyIsResting(rb, world->sleepSpeed, world->sleepAngularSpeed))
+			rb->restTime += dt;
+		else
+			rb->restTime = a3realZero;
 	}
-	state->count_p = i;
+}
 
-	a3_ConvexHullCollision collision[1] = { 0 };
+// internal utility for continuous collision of flagged fast spheres
+//	- sweeps each body's motion this step against static hulls; on 
+//		impact the body is moved back to the time of impact and its 
+//		approach velocity is reflected with the solver's restitution
+void a3physicsSweepContinuous_internal(a3_PhysicsWorld *world, const a3_PhysicsWorldState *start)
+{
+	a3_RigidBody *rb;
+	a3vec3 motion, normal, normalHit;
+	a3real toi, toiHit, vn;
+	unsigned int i, j;
 
-	if (world->framesSkipped > 5)
+	for (i = 0, rb = world->rigidbody; i < world->rigidbodiesActive; ++i, ++rb)
 	{
-		for (unsigned int x = 0; x < world->numBSPs; ++x)
+		if (!rb->continuous || rb->sleeping || rb->massInv <= a3realZero || world->hull[i].type != a3hullType_sphere)
+			continue;
+
+		// a sphere moving less than its radius cannot skip a surface
+		a3real3Diff(motion.v, rb->position.v, start->pose_rb[i].position.v);
+		if (a3real3LengthSquared(motion.v) < world->hull[i].prop[a3hullProperty_radius] * world->hull[i].prop[a3hullProperty_radius])
+			continue;
+
+		// earliest impact against any static hull
+		toiHit = a3realOne;
+		for (j = 0; j < world->rigidbodiesActive; ++j)
 		{
-			for (i = 0; i < world->bsps[x].numContainedHulls; ++i)
+			if (j == i || world->rigidbody[j].massInv > a3realZero)
+				continue;
+			if (a3collisionSweepSphere(&toi, normal.v, start->pose_rb[i].position.v, rb->position.v, world->hull[i].prop[a3hullProperty_radius], world->hull + j) > 0 && toi < toiHit)
 			{
-				for (j = 0; j < world->bsps[x].numContainedHulls; ++j)
-				{
-					if (i == j) continue;
-					if (a3collisionTestConvexHulls(collision, world->bsps[x].containedHulls[i], world->bsps[x].containedHulls[j]) > 0)
-					{
-						a3handleCollision(collision, world->bsps[x].containedHulls[i], world->bsps[x].containedHulls[j]);
-					}
-				}
+				toiHit = toi;
+				normalHit = normal;
 			}
 		}
-	}
-	else
-		world->framesSkipped++;
 
-	// ****TO-DO: 
-	//	- apply forces and torques
+		if (toiHit < a3realOne)
+		{
+			a3real3Add(a3real3ProductS(rb->position.v, motion.v, toiHit), start->pose_rb[i].position.v);
+			vn = a3real3Dot(rb->velocity.v, normalHit.v);
+			if (vn < a3realZero)
+				a3real3Sub(rb->velocity.v, a3real3ProductS(normal.v, normalHit.v, (a3realOne + world->solver->restitution) * vn));
+		}
+	}
+}
 
+// internal utility to integrate all rigid bodies not held
+void a3physicsIntegrate_internal(a3_PhysicsWorld *world, const a3real dt)
+{
+	unsigned int i;
 	for (i = 0; i < world->rigidbodiesActive; ++i)
 	{
-		a3rigidbodyIntegrateEulerKinematic(world->rigidbody + i, dt_r);
+		if (world->rigidbody[i].held)
+			continue;
+
+		// sleeping bodies wake when pushed
+		if (world->rigidbody[i].sleeping)
+		{
+			if (a3real3LengthSquared(world->rigidbody[i].force.v) <= a3realZero)
+				continue;
+			a3rigidbodyWake(world->rigidbody + i);
+		}
+
+		a3rigidbodyIntegrateEulerKinematic(world->rigidbody + i, dt);
+		a3rigidbodyIntegratePseudoVelocity(world->rigidbody + i, dt);
 		a3real3ProductS(world->rigidbody[i].acceleration.v, world->rigidbody[i].force.v, world->rigidbody[i].massInv);
 		//Add set to acceleration
 		a3real4ProductS(world->rigidbody[i].acceleration_a.v, world->rigidbody[i].torque.v, world->rigidbody[i].massInv);
 		a3real4Normalize(world->rigidbody[i].acceleration_a.v);
+	}
+}
 
-		//reset force
-		a3rigidbodyResetForce(world->rigidbody + i);
+// internal job: integrate particles [begin, end)
+//	- wind drag is taken implicitly (rate k dt / (1 + k dt)) so it 
+//		stays stable at any drag
+void a3physicsIntegrateParticles_internal(const a3_PhysicsJob *job, const unsigned int begin, const unsigned int end)
+{
+	a3_ParticlePool *const pool = job->world->particlePool;
+	const a3real drag = job->world->particleDrag, dt = job->dt;
+	unsigned int c;
+	if (drag > a3realZero)
+		a3windFieldApplyDrag(job->world->wind, pool->velocity + begin, pool->position + begin, pool->capacity, end - begin, 
+			drag * dt / (a3realOne + drag * dt));
+	for (c = 0; c < 3; ++c)
+		a3integrateEulerSemiImplicit(pool->position + pool->capacity * c + begin, pool->velocity + pool->capacity * c + begin, pool->acceleration + pool->capacity * c + begin, end - begin, dt);
+}
+
+// internal utility to bounce particles off static hulls
+//	- colliders are rebuilt from the hulls each time since static 
+//		bodies may still move
+void a3physicsCollideParticles_internal(a3_PhysicsWorld *world, const a3real dt)
+{
+	const a3_ConvexHull *hull;
+	unsigned int i, a, b;
+
+	if (!world->particlePool->count || !world->particleHash->cellMask)
+		return;
+
+	a3particleCollisionHashClear(world->particleHash);
+	for (i = 0, hull = world->hull; i < world->rigidbodiesActive; ++i, ++hull)
+	{
+		if (hull->rb->massInv > a3realZero)
+			continue;
+		switch (hull->type)
+		{
+		case a3hullType_plane:
+			// normal and rectangle axes are the transform's columns
+			a = (hull->axis + 1) % 3;
+			b = (hull->axis + 2) % 3;
+			a3particleCollisionHashAddPlane(world->particleHash, hull->rb->position.v,
+				hull->transform->m[hull->axis], hull->transform->m[a], hull->transform->m[b],
+				hull->prop[a3hullProperty_halfwidth], hull->prop[a3hullProperty_halfheight], hull->rb->velocity.v);
+			break;
+		case a3hullType_sphere:
+			a3particleCollisionHashAddSphere(world->particleHash, hull->rb->position.v, hull->prop[a3hullProperty_radius], hull->rb->velocity.v);
+			break;
+		default:
+			break;
+		}
+	}
+	a3particleCollisionHashResolve(world->particleHash, world->particlePool, world->particleRestitution, dt);
+}
+
+// internal job: step props [begin, end) over the whole step
+//	- fluid and position-based props take their own substeps
+//	- orbits: gravity from the tree, then one kick and drift
+void a3physicsStepProps_internal(const a3_PhysicsJob *job, const unsigned int begin, const unsigned int end)
+{
+	a3_PhysicsWorld *const world = job->world;
+	unsigned int i;
+	for (i = begin; i < end; ++i)
+	{
+		switch (i)
+		{
+		case physicsProp_fluid:
+			if (world->fluid->memory)
+				a3particleFluidStep(world->fluid, job->dt);
+			break;
+		case physicsProp_positionBased:
+			if (world->positionBased->memory)
+				a3positionBasedStep(world->positionBased, job->dt);
+			break;
+		case physicsProp_orbit:
+			if (a3barnesHutBuild(world->orbitTree, world->orbitPool->position, world->orbitMass, world->orbitPool->count, world->orbitPool->capacity) > 0)
+			{
+				a3barnesHutSolve(world->orbitTree, world->orbitPool->acceleration);
+				a3particlePoolIntegrateEulerSemiImplicit(world->orbitPool, job->dt);
+			}
+			break;
+		}
+	}
+}
+
+// buffers published for graphics, one per particle set
+enum a3_PhysicsBuffer
+{
+	physicsBuffer_particle,
+	physicsBuffer_fluid,
+	physicsBuffer_cloth,
+	physicsBuffer_positionBased,
+	physicsBuffer_orbit,
+	physicsMaxCount_buffer,
+};
+
+// internal job: copy buffers [begin, end) out for graphics
+void a3physicsPublish_internal(const a3_PhysicsWorld *world, const unsigned int begin, const unsigned int end)
+{
+	unsigned int i;
+	for (i = begin; i < end; ++i)
+	{
+		switch (i)
+		{
+		case physicsBuffer_particle:
+			if (world->particlePosition)
+				a3particlePoolCopyPositions(world->particlePosition, world->particlePool);
+			break;
+		case physicsBuffer_fluid:
+			if (world->fluidPosition)
+				a3particlePoolCopyPositions(world->fluidPosition, world->fluid->pool);
+			break;
+		case physicsBuffer_cloth:
+			if (world->clothPosition)
+				a3clothCopyPositions(world->clothPosition, world->cloth);
+			break;
+		case physicsBuffer_positionBased:
+			if (world->positionBasedPosition)
+				a3positionBasedCopyPositions(world->positionBasedPosition, world->positionBased);
+			break;
+		case physicsBuffer_orbit:
+			if (world->orbitPosition)
+				a3particlePoolCopyPositions(world->orbitPosition, world->orbitPool);
+			break;
+		}
+	}
+}
+
+// internal helper: copy a body's entries between states
+inline void a3physicsCopyEntry_internal(a3_PhysicsWorldState *dst, const a3_PhysicsWorldState *src, const unsigned int i)
+{
+	dst->pose_rb[i] = src->pose_rb[i];
+	dst->version_rb[i] = src->version_rb[i];
+}
+
+// internal helper: copy everything in a state but its entries
+inline void a3physicsCopyHeader_internal(a3_PhysicsWorldState *dst, const a3_PhysicsWorldState *src)
+{
+	dst->count_p = src->count_p;
+	dst->count_rb = src->count_rb;
+	dst->count_f = src->count_f;
+	dst->count_c = src->count_c;
+	dst->count_pb = src->count_pb;
+	dst->count_o = src->count_o;
+	dst->t = src->t;
+	dst->version = src->version;
+	dst->keyframe = src->keyframe;
+}
+
+// internal utility to publish the written state
+//	- the previous state takes the entries the last publication 
+//		changed (the rest already match), then the state takes 
+//		the ones written this step; bodies coasting between tier 
+//		steps change every publication, and once more to stop
+//	- the first publication and every keyframeInterval-th after 
+//		it copy every entry
+void a3physicsPublishState_internal(a3_PhysicsWorld *world)
+{
+	a3_PhysicsWorldState *const state = world->state;
+	const a3_PhysicsWorldState *const write = world->stateWrite;
+	const unsigned int version = state->version + 1;
+	const int keyframe = state->version == 0 || (world->keyframeInterval && version % world->keyframeInterval == 0);
+	unsigned int coast = 0, changed, i;
+
+	for (i = 0; i < write->count_rb; ++i)
+		if (world->owed_rb[i] > a3realZero)
+			coast |= 1u << i;
+	changed = keyframe ? ~0u : (world->dirty_rb | coast | world->coast_rb);
+
+	for (i = 0; i < state->count_rb; ++i)
+		if (world->publish_rb >> i & 1u)
+			a3physicsCopyEntry_internal(world->statePrev, state, i);
+	a3physicsCopyHeader_internal(world->statePrev, state);
+
+	for (i = 0; i < write->count_rb; ++i)
+		if (changed >> i & 1u)
+		{
+			a3physicsCopyEntry_internal(state, write, i);
+			state->version_rb[i] = version;
+		}
+	a3physicsCopyHeader_internal(state, write);
+	state->version = version;
+	state->keyframe = keyframe;
+	a3physicsExtrapolateTiers_internal(world, state);
+	if (!world->compactPose)
+		a3physicsWorldStateExpand(world->transform, state, changed);
+
+	world->publish_rb = changed;
+	world->coast_rb = coast;
+}
+
+// internal utility to pick the next step size from the last one's error
+//	- error of a first-order step goes as dt^2, so the step that 
+//		would have met tolerance is dt * sqrt(tolerance / error); 
+//		a safety factor and growth limits keep it from oscillating
+double a3physicsStepAdapt_internal(const a3_PhysicsWorld *world, const double dt)
+{
+	const double safety = 0.9, shrinkMax = 0.25, growMax = 2.0;
+	double scale = growMax;
+	if (world->stepError > a3realZero)
+		scale = a3clamp(shrinkMax, growMax, safety * a3sqrt(world->stepTolerance / world->stepError));
+	return a3clamp(world->stepMin, world->stepMax, dt * scale);
+}
+
+// physics simulation: begin a step
+//	- writes the state the step starts from, hands out the props, 
+//		gathers contacts and accumulates forces
+void a3physicsStepBegin(a3_PhysicsWorld *world, double dt)
+{
+	// state to edit before writing to world
+	a3_PhysicsWorldState *const state = world->stateWrite;
+
+	// time as real
+	const a3real dt_r = (a3real)(dt);
+
+	// generic counter
+	unsigned int i, j;
+
+
+	// ****TO-DO: 
+	//	- write to state
+	world->dirty_rb = a3physicsWriteState_internal(world, state, world->transformWrite, 0);
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+		world->velocityStart_rb[i] = world->rigidbody[i].velocity;
+
+	// props step alongside everything else until they are joined
+	world->stepJob->world = world->substepJob->world = world;
+	world->stepJob->dt = dt_r;
+	for (i = 0; i < physicsMaxCount_prop; ++i)
+		a3jobSubmit(world->jobs, (a3_JobFunc)a3physicsStepProps_internal, world->stepJob, i, i + 1, world->stepPending);
+
+
+	a3_ConvexHullCollision collision[1] = { 0 };
+
+	// gather contacts: each pair the last step predicted, or each 
+	//	pair in a cell once
+	a3solverClearContacts(world->solver);
+	if (world->pipelined && world->pairReady)
+	{
+		for (i = 0; i < world->rigidbodiesActive; ++i)
+			for (j = i + 1; j < world->rigidbodiesActive; ++j)
+				if (world->pair_rb[world->pairFront][i] >> j & 1u)
+					a3physicsCollideHulls_internal(world, collision, world->hull + i, world->hull + j, dt_r);
 	}
-	for (i = 0; i < world->particlesActive; ++i)
+	else for (unsigned int x = 0; x < world->numBSPs; ++x)
 	{
-		a3particleIntegrateEulerSemiImplicit(world->particle + i, dt_r);
+		for (i = 0; i < world->bsps[x].numContainedHulls; ++i)
+		{
+			for (j = i + 1; j < world->bsps[x].numContainedHulls; ++j)
+			{
+				a3physicsCollideHulls_internal(world, collision, world->bsps[x].containedHulls[i], world->bsps[x].containedHulls[j], dt_r);
+			}
+		}
+	}
+
+	// retire expired particles, then emit into the space they left
+	a3particlePoolAge(world->particlePool, dt_r);
+	for (i = 0; i < world->emittersActive; ++i)
+		a3particleEmitterEmit(world->emitter + i, world->particlePool, dt_r);
+
+	// wake or sleep whole islands before applying forces, then 
+	//	group what is awake into rate tiers
+	a3physicsUpdateIslands_internal(world);
+	a3physicsUpdateTiers_internal(world, dt_r);
+
+	// move the wind on, then accumulate registered forces (resting 
+	//	weight does not wake a sleeping body)
+	a3windFieldUpdate(world->wind, dt_r);
+	a3forceRegistryApply(world->forces, world->rigidbody, world->rigidbodiesActive);
+
+	// pipelined: the next step's broadphase runs from here on, 
+	//	from bounds taken before anything moves
+	if (world->pipelined)
+	{
+		a3physicsPredictReach_internal(world, dt_r);
+		a3jobSubmit(world->jobs, (a3_JobFunc)a3physicsPredictPairs_internal, world, 0, 1, world->stepPending);
 	}
+}
+
+// physics simulation: schedule a tier
+//	- tier k steps every 2^k steps over the time since its last 
+//		step while the other tiers are held; islands never span 
+//		tiers, so no contact mixes stepping and held bodies
+//	- the first tier always steps (particles and cloth step with it)
+a3real a3physicsStepTier(a3_PhysicsWorld *world, const unsigned int k)
+{
+	const unsigned int substeps = world->substeps > 1 ? world->substeps : 1;
+	a3real h = a3realZero;
+	if (world->tierStep & ((1u << k) - 1u))
+		return h;
+	if (a3physicsHoldTiers_internal(world, k) || k == 0)
+		h = world->tierTime[k] / (a3real)(substeps);
+	world->tierTime[k] = a3realZero;
+	return h;
+}
+
+// physics simulation: resolve contacts over a substep
+//	- velocity impulses plus split-impulse pseudo-velocity for 
+//		penetration recovery; with substeps, the same contact set 
+//		is solved once per substep against depths re-estimated 
+//		from body motion
+void a3physicsStepSolve(a3_PhysicsWorld *world, const a3real h)
+{
+	a3solverUpdateSeparation(world->solver);
+	a3solverPrestep(world->solver, h);
+	a3solverSolve(world->solver);
+
+	// rest is judged on solved velocity, before this step's 
+	//	acceleration is added back in
+	a3physicsUpdateRest_internal(world, h);
+}
+
+// physics simulation: integrate the bodies stepping over a substep
+void a3physicsStepIntegrate(a3_PhysicsWorld *world, const a3real h)
+{
+	// ****TO-DO: 
+	//	- apply forces and torques
+	a3physicsIntegrate_internal(world, h);
+}
+
+// physics simulation: step particles and cloth over a substep
+void a3physicsStepParticles(a3_PhysicsWorld *world, const a3real h)
+{
+	// particles integrate in chunks of at least 4096
+	world->substepJob->dt = h;
+	a3jobParallelFor(world->jobs, (a3_JobFunc)a3physicsIntegrateParticles_internal, world->substepJob, world->particlePool->count, 4096);
+	a3physicsCollideParticles_internal(world, h);
+	if (world->cloth->memory)
+		a3clothStep(world->cloth, h);
+}
+
+// physics simulation: end a step
+//	- catches tunneling, estimates error, joins the props and 
+//		publishes the state
+void a3physicsStepEnd(a3_PhysicsWorld *world, double dt)
+{
+	// state to edit before writing to world
+	a3_PhysicsWorldState *const state = world->stateWrite;
+
+	// time as real
+	const a3real dt_r = (a3real)(dt);
+	a3real error;
+
+	// generic counter
+	unsigned int i;
+
+
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+		world->rigidbody[i].held = 0;
+	++world->tierStep;
+
+	// catch fast bodies that skipped past a surface this step
+	//	(state still holds each body's position from the start of the step)
+	a3physicsSweepContinuous_internal(world, state);
+
+	// estimate local error: the step moved each body by its start 
+	//	velocity (first order) where the trapezoid rule would use the 
+	//	average of start and end; the gap, half the velocity change 
+	//	times dt, includes solver impulses so impacts count as error
+	world->stepError = a3realZero;
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+	{
+		if (world->rigidbody[i].massInv <= a3realZero || world->rigidbody[i].sleeping)
+			continue;
+		error = (a3real)(0.5) * dt_r * (a3real)(1u << world->tier_rb[i]) * a3real3Distance(world->rigidbody[i].velocity.v, world->velocityStart_rb[i].v);
+		world->stepError = a3maximum(world->stepError, error);
+	}
+
+	//reset force
+	for (i = 0; i < world->rigidbodiesActive; ++i)
+		a3rigidbodyResetForce(world->rigidbody + i);
 
 
 	// accumulate time
 	world->t += dt;
+	state->t = world->t;
 
-	updateHulls(world);
+	// join props (they are published next) and the next step's 
+	//	broadphase; without pipelining, bin bodies where they ended
+	a3jobWait(world->jobs, world->stepPending);
+	if (world->pipelined)
+	{
+		world->pairFront ^= 1;
+		world->pairReady = 1;
+	}
+	else
+		updateHulls(world);
 
 
 	// write operation is locked
 	if (a3physicsLockWorld(world) > 0)
 	{
-		// copy state to world
-		*world->state = *state;
+		// copy what changed in the state to world, keeping the last 
+		//	one for interpolation
+		a3physicsPublishState_internal(world);
+		a3jobParallelFor(world->jobs, (a3_JobFunc)a3physicsPublish_internal, world, physicsMaxCount_buffer, 1);
 		a3physicsUnlockWorld(world);
 	}
+
+	// other processes get the state just published; only this 
+	//	thread changes it, so the lock is not needed to read it
+	if (world->snapshot)
+		a3physicsSnapshotWrite(world->snapshot, world->state);
+}
+
+// physics simulation
+void a3physicsUpdate(a3_PhysicsWorld *world, double dt)
+{
+	// substep count and duration (per tier)
+	const unsigned int substeps = world->substeps > 1 ? world->substeps : 1;
+	a3real h_r;
+
+	// generic counter
+	unsigned int j, k;
+
+	a3physicsStepBegin(world, dt);
+	for (k = 0; k < physicsMaxCount_tier; ++k)
+	{
+		h_r = a3physicsStepTier(world, k);
+		if (h_r > a3realZero)
+		{
+			for (j = 0; j < substeps; ++j)
+			{
+				a3physicsStepSolve(world, h_r);
+				a3physicsStepIntegrate(world, h_r);
+				if (k == 0)
+					a3physicsStepParticles(world, h_r);
+			}
+		}
+	}
+	a3physicsStepEnd(world, dt);
 }
 
 
@@ -405,6 +1404,15 @@ long a3physicsThread(a3_PhysicsWorld *world)
 	// second counter for physics (debugging)
 	unsigned int currSecond = 0, prevSecond = 0;
 
+	// step and time owed to the simulation
+	//	- measured ticks jitter, so real time is accumulated and 
+	//		paid out in whole steps; at most a few ticks' worth is 
+	//		owed so a stall cannot snowball
+	//	- adaptive steps change size after each one; fixed steps 
+	//		stay at 1/rate
+	const double accumulatorMax = a3maximum(4.0 / world->rate, 2.0 * world->stepMax);
+	double accumulator = 0.0, step = 1.0 / world->rate;
+
 	// create world
 	a3physicsInitialize_internal(world);
 
@@ -419,7 +1427,15 @@ long a3physicsThread(a3_PhysicsWorld *world)
 		if (a3timerUpdate(physicsTimer))
 		{
 			// update timer ticked, do the thing
-			a3physicsUpdate(world, physicsTimer->previousTick);
+			accumulator = a3minimum(accumulator + physicsTimer->previousTick, accumulatorMax);
+			while (accumulator >= step)
+			{
+				a3physicsUpdate(world, step);
+				accumulator -= step;
+				if (world->adaptive)
+					step = a3physicsStepAdapt_internal(world, step);
+			}
+			world->step = step;
 
 			// debug display time in seconds
 			currSecond = (unsigned int)(physicsTimer->totalTime);
@@ -438,6 +1454,53 @@ long a3physicsThread(a3_PhysicsWorld *world)
 
 //-----------------------------------------------------------------------------
 
+// create world content outside of the thread
+void a3physicsWorldInitialize(a3_PhysicsWorld *world)
+{
+	a3physicsInitialize_internal(world);
+}
+
+// destroy world content outside of the thread
+void a3physicsWorldTerminate(a3_PhysicsWorld *world)
+{
+	a3physicsTerminate_internal(world);
+}
+
+// add a sphere to the scene
+int a3physicsWorldAddSphere(a3_PhysicsWorld *world, const a3real3p position, const a3real3p velocity, const a3real mass, const a3real radius)
+{
+	if (world && position && velocity && world->rigidbodiesActive < physicsMaxCount_rigidbody)
+	{
+		const unsigned int i = world->rigidbodiesActive;
+		a3_RigidBody *const rb = world->rigidbody + i;
+		a3real3Set(rb->position.v, position[0], position[1], position[2]);
+		a3real3Set(rb->velocity.v, velocity[0], velocity[1], velocity[2]);
+		a3rigidbodySetMass(rb, mass);
+		world->state->pose_rb[i].rotation = a3wVec4;
+		a3collisionCreateHullSphere(world->hull + i, rb, world->transformWrite->transform_rb + i, world->transformWrite->transformInv_rb + i, radius);
+		++world->rigidbodiesActive;
+		return i;
+	}
+	return -1;
+}
+
+// add a static plane to the scene
+int a3physicsWorldAddPlane(a3_PhysicsWorld *world, const a3real3p position, const a3real4p rotation, const a3real width, const a3real height)
+{
+	if (world && position && rotation && world->rigidbodiesActive < physicsMaxCount_rigidbody)
+	{
+		const unsigned int i = world->rigidbodiesActive;
+		a3_RigidBody *const rb = world->rigidbody + i;
+		a3real3Set(rb->position.v, position[0], position[1], position[2]);
+		a3rigidbodySetMass(rb, a3realZero);
+		a3real4Set(world->state->pose_rb[i].rotation.v, rotation[0], rotation[1], rotation[2], rotation[3]);
+		a3collisionCreateHullPlane(world->hull + i, rb, world->transformWrite->transform_rb + i, world->transformWrite->transformInv_rb + i, width, height, 1, a3axis_z);
+		++world->rigidbodiesActive;
+		return i;
+	}
+	return -1;
+}
+
 // reset world state
 int a3physicsWorldStateReset(a3_PhysicsWorldState *worldState)
 {
@@ -447,16 +1510,154 @@ int a3physicsWorldStateReset(a3_PhysicsWorldState *worldState)
 		//	- reset all state data appropriately
 		for (i = 0; i < physicsMaxCount_rigidbody; ++i)
 		{
-			worldState->position_rb[i] = a3wVec4;
-			//worldState->rotation_rb[i] = a3wVec4;
-			worldState->transform_rb[i] = a3identityMat4;
-			worldState->transformInv_rb[i] = a3identityMat4;
+			worldState->pose_rb[i].position = a3zeroVec3;
+			//worldState->pose_rb[i].rotation = a3wVec4;
+			worldState->version_rb[i] = 0;
 		}
-		for (i = 0; i < physicsMaxCount_particle; ++i)
+		worldState->count_p = worldState->count_rb = worldState->count_f = worldState->count_c = worldState->count_pb = worldState->count_o = 0;
+		worldState->t = 0.0;
+		worldState->version = 0;
+		worldState->keyframe = 0;
+		return physicsMaxCount_rigidbody;
+	}
+	return -1;
+}
+
+int a3physicsWorldStateInterpolate(a3_PhysicsWorldState *worldState_out, const a3_PhysicsWorldState *worldState0, const a3_PhysicsWorldState *worldState1, const double t)
+{
+	unsigned int i;
+	if (worldState_out && worldState0 && worldState1)
+	{
+		// blend parameter from timestamps
+		const double span = worldState1->t - worldState0->t;
+		const a3real u = span > 0.0 ? (a3real)a3clamp(0.0, 1.0, (t - worldState0->t) / span) : a3realOne;
+
+		// header and anything new come from the latest state
+		a3physicsCopyHeader_internal(worldState_out, worldState1);
+		worldState_out->t = worldState0->t + span * u;
+
+		for (i = 0; i < worldState1->count_rb; ++i)
+		{
+			// unchanged between the two
+			if (worldState0->version_rb[i] == worldState1->version_rb[i])
+			{
+				a3physicsCopyEntry_internal(worldState_out, worldState1, i);
+				continue;
+			}
+
+			a3real3Lerp(worldState_out->pose_rb[i].position.v, worldState0->pose_rb[i].position.v, worldState1->pose_rb[i].position.v, u);
+			a3quaternionUnitSLERP(worldState_out->pose_rb[i].rotation.v, worldState0->pose_rb[i].rotation.v, worldState1->pose_rb[i].rotation.v, u);
+			worldState_out->version_rb[i] = 0;
+		}
+		return worldState1->count_rb;
+	}
+	return -1;
+}
+
+int a3physicsWorldStateSync(a3_PhysicsWorldState *worldState_inout, const a3_PhysicsWorldState *worldState)
+{
+	unsigned int i, n = 0;
+	if (worldState_inout && worldState)
+	{
+		// a copy never taken, or of something newer, is taken again
+		const int all = worldState_inout->version == 0 || worldState_inout->version > worldState->version;
+		if (!all && worldState_inout->version == worldState->version)
+			return 0;
+		for (i = 0; i < worldState->count_rb; ++i)
+			if (all || worldState->version_rb[i] > worldState_inout->version)
+			{
+				a3physicsCopyEntry_internal(worldState_inout, worldState, i);
+				++n;
+			}
+		a3physicsCopyHeader_internal(worldState_inout, worldState);
+		return n;
+	}
+	return -1;
+}
+
+int a3physicsWorldStateDiff(a3_PhysicsWorldStateDelta *delta_out, const a3_PhysicsWorldState *worldState, const unsigned int base)
+{
+	a3_PhysicsWorldStateEntry *entry;
+	unsigned int i;
+	if (delta_out && worldState)
+	{
+		delta_out->count_p = worldState->count_p;
+		delta_out->count_rb = worldState->count_rb;
+		delta_out->count_f = worldState->count_f;
+		delta_out->count_c = worldState->count_c;
+		delta_out->count_pb = worldState->count_pb;
+		delta_out->count_o = worldState->count_o;
+		delta_out->t = worldState->t;
+		delta_out->version = worldState->version;
+		delta_out->base = base;
+		delta_out->entryCount = 0;
+		for (i = 0; i < worldState->count_rb; ++i)
+			if (base == 0 || worldState->version_rb[i] > base)
+			{
+				entry = delta_out->entry + delta_out->entryCount++;
+				entry->index = i;
+				entry->version = worldState->version_rb[i];
+				entry->pose = worldState->pose_rb[i];
+			}
+		return delta_out->entryCount;
+	}
+	return -1;
+}
+
+int a3physicsWorldStateApply(a3_PhysicsWorldState *worldState_inout, const a3_PhysicsWorldStateDelta *delta)
+{
+	const a3_PhysicsWorldStateEntry *entry;
+	unsigned int i;
+	if (worldState_inout && delta)
+	{
+		// entries changed between the copy and the delta's base are 
+		//	missing from it
+		if (delta->base != 0 && worldState_inout->version < delta->base)
+			return 0;
+		for (i = 0; i < delta->entryCount; ++i)
+		{
+			entry = delta->entry + i;
+			worldState_inout->pose_rb[entry->index] = entry->pose;
+			worldState_inout->version_rb[entry->index] = entry->version;
+		}
+		worldState_inout->count_p = delta->count_p;
+		worldState_inout->count_rb = delta->count_rb;
+		worldState_inout->count_f = delta->count_f;
+		worldState_inout->count_c = delta->count_c;
+		worldState_inout->count_pb = delta->count_pb;
+		worldState_inout->count_o = delta->count_o;
+		worldState_inout->t = delta->t;
+		worldState_inout->version = delta->version;
+		worldState_inout->keyframe = delta->base == 0;
+		return delta->entryCount;
+	}
+	return -1;
+}
+
+unsigned int a3physicsWorldStateDeltaSize(const a3_PhysicsWorldStateDelta *delta)
+{
+	if (delta)
+		return (unsigned int)(offsetof(a3_PhysicsWorldStateDelta, entry) + sizeof(a3_PhysicsWorldStateEntry) * delta->entryCount);
+	return 0;
+}
+
+int a3physicsWorldStateExpand(a3_PhysicsWorldTransforms *transforms_out, const a3_PhysicsWorldState *worldState, const unsigned int mask)
+{
+	const a3_PhysicsPose *pose;
+	unsigned int i, n = 0;
+	if (transforms_out && worldState)
+	{
+		for (i = 0; i < worldState->count_rb; ++i)
 		{
-			worldState->position_p[i] = a3wVec4;
+			if (!(mask >> i & 1u) || (worldState->version_rb[i] && transforms_out->version_rb[i] == worldState->version_rb[i]))
+				continue;
+			pose = worldState->pose_rb + i;
+			a3quaternionConvertToMat4(transforms_out->transform_rb[i].m, pose->rotation.v, pose->position.v);
+			a3real4x4TransformInverseIgnoreScale(transforms_out->transformInv_rb[i].m, transforms_out->transform_rb[i].m);
+			transforms_out->version_rb[i] = worldState->version_rb[i];
+			++n;
 		}
-		return (physicsMaxCount_rigidbody + physicsMaxCount_particle);
+		return n;
 	}
 	return -1;
 }
@@ -35,7 +35,17 @@
 //-----------------------------------------------------------------------------
 // physics includes
 
+#include "a3_PhysicsState.h"
 #include "a3_Collision.h"
+#include "a3_Solver.h"
+#include "a3_ForceRegistry.h"
+#include "a3_ParticleEmitter.h"
+#include "a3_ParticleCollision.h"
+#include "a3_ParticleFluid.h"
+#include "a3_Cloth.h"
+#include "a3_PositionBased.h"
+#include "a3_BarnesHut.h"
+#include "a3_JobSystem.h"
 #include "../BSP.h"
 
 //-----------------------------------------------------------------------------
@@ -45,7 +55,7 @@ extern "C"
 {
 #else	// !__cplusplus
 	typedef struct a3_PhysicsWorld					a3_PhysicsWorld;
-	typedef struct a3_PhysicsWorldState				a3_PhysicsWorldState;
+	typedef struct a3_PhysicsJob					a3_PhysicsJob;
 #endif	// __cplusplus
 
 
@@ -54,32 +64,34 @@ extern "C"
 	// counters
 	enum a3_PhysicsWorldMaxCount
 	{
-		physicsMaxCount_particle = 32,
-		physicsMaxCount_rigidbody = 32,
 		physicsMaxCount_bsp = 32,
+		physicsMaxCount_tier = 3,
+		physicsMaxCount_emitter = 8,
+	};
+
+	// scene builder: adds a world's rigid bodies, hulls, forces and 
+	//	joints (see a3physicsWorldAddSphere, a3physicsWorldAddPlane 
+	//	and the solver's joint adders) when its content is created, 
+	//	after bodies, forces and the solver are reset
+	typedef void (*a3_PhysicsSceneFunc)(a3_PhysicsWorld *world, void *user);
+
+	// props stepped as jobs, each on its own
+	enum a3_PhysicsProp
+	{
+		physicsProp_fluid,
+		physicsProp_positionBased,
+		physicsProp_orbit,
+		physicsMaxCount_prop,
 	};
 
 
 //-----------------------------------------------------------------------------
 
-	// state of a physics world: things that can be used for graphics ONLY
-	//	- position and rotation... why not scale? RIGID bodies don't scale
-	struct a3_PhysicsWorldState
+	// arguments of the jobs a step hands out
+	struct a3_PhysicsJob
 	{
-		//	- add particle position
-		a3vec4 position_p[physicsMaxCount_particle];
-
-		//	- add rigid body position and rotation
-		//	- add matrix for solving inertia tensor
-		//		-> we will use this and its inverse (transpose) 
-		//			to resolve inertia tensors
-		a3vec4 position_rb[physicsMaxCount_rigidbody];
-		a3vec4 rotation_rb[physicsMaxCount_rigidbody];
-		a3mat4 transform_rb[physicsMaxCount_rigidbody];
-		a3mat4 transformInv_rb[physicsMaxCount_rigidbody];
-
-		// current counts
-		unsigned int count_p, count_rb;
+		a3_PhysicsWorld *world;
+		a3real dt;
 	};
 
 
@@ -96,17 +108,107 @@ extern "C"
 		//---------------------------------------------------------------------
 		// initialized flag
 		int init;
-		int framesSkipped;
 
 		//---------------------------------------------------------------------
 		// timer rate
 		double rate;
 
+		// scene the world's content starts from and its user data 
+		//	(set before starting the thread; null for the demo scene: 
+		//	the box, its spheres, wind and props)
+		a3_PhysicsSceneFunc scene;
+		void *sceneUser;
+
+		// integrate/solve substeps per tick (0 or 1 to disable)
+		//	- collision detection still runs once per tick; substeps 
+		//		reuse its contacts, which keeps stacks stiff without 
+		//		paying for detection at a higher rate
+		unsigned int substeps;
+
+		// sleeping: an island of bodies below the rest speeds for 
+		//	sleepTime seconds is skipped by integration, broadphase 
+		//	and publication until a contact or force wakes it
+		//	(sleepTime <= 0 to disable)
+		a3real sleepTime, sleepSpeed, sleepAngularSpeed;
+
+		// speculative contacts: pairs closer than their relative 
+		//	motion this step (capped here) make contacts that limit 
+		//	approach speed before they touch (0 to disable)
+		a3real speculativeMargin;
+
+		// adaptive stepping: each step estimates its integration 
+		//	error and the next step grows or shrinks to keep it near 
+		//	stepTolerance, within [stepMin, stepMax] seconds
+		//	(adaptive = 0 for fixed steps of 1/rate)
+		//	- step is the size the next step will take; stepError is 
+		//		the largest body error measured by the last one
+		int adaptive;
+		a3real stepTolerance;
+		double stepMin, stepMax;
+		double step;
+		a3real stepError;
+
+		// multi-rate stepping (physics LOD): bodies farther than 
+		//	tierDistance[k] from the observer step every 2^(k+1) 
+		//	steps instead of every step; bodies that interact share 
+		//	the fastest tier among them (tierDistance[0] <= 0 to disable)
+		a3vec3 observer;
+		a3real tierDistance[physicsMaxCount_tier - 1];
+
+		// job system the step is spread over (set before starting 
+		//	the thread; null to step everything on the thread)
+		//	- props (fluid, position-based, orbits) share nothing 
+		//		with the bodies or each other, so each steps as a job 
+		//		while the bodies and particles step here; particles 
+		//		integrate and buffers publish as parallel loops
+		a3_JobSystem *jobs;
+
+		// pipelined stepping: the broadphase for the next step runs 
+		//	as a job alongside this step's solve and integration, 
+		//	binning each body by bounds grown to everywhere it can 
+		//	reach by the end of the step; the next step's narrowphase 
+		//	tests the pairs it found against where bodies really are 
+		//	(set before starting the thread; 0 to bin after each step)
+		int pipelined;
+
+		// delta publication: only bodies whose entries changed are 
+		//	copied into the published states (resting and sleeping 
+		//	bodies cost nothing); every keyframeInterval publications 
+		//	all of them are, so recorders have places to start from 
+		//	(0 for only the first)
+		unsigned int keyframeInterval;
+
+		// compact publication: publish poses only, leaving consumers 
+		//	to expand transforms for what they draw (0 to also expand 
+		//	the latest state's transforms into transform under the 
+		//	lock, as they change)
+		int compactPose;
+
+		// ring in shared memory each published state is also written 
+		//	to, for readers in other processes (set before starting 
+		//	the thread; null for none; see a3_PhysicsSnapshot.h)
+		struct a3_PhysicsSnapshotRing *snapshot;
+
 
 		//---------------------------------------------------------------------
 		// the state to store all of the things that need to go to graphics
 		a3_PhysicsWorldState state[1];
 
+		// the state published before it; consumers interpolate 
+		//	between the two by their timestamps
+		a3_PhysicsWorldState statePrev[1];
+
+		// transforms of the latest state (unless poses are compact)
+		a3_PhysicsWorldTransforms transform[1];
+
+		// state being written by the current step and its transforms; 
+		//	persistent so sleeping bodies keep their last entries 
+		//	without rewriting
+		//	- hulls read their transforms from here, so collision 
+		//		detection sees where bodies are at the start of the step
+		a3_PhysicsWorldState stateWrite[1];
+		a3_PhysicsWorldTransforms transformWrite[1];
+
 
 		//---------------------------------------------------------------------
 		// general variables pertinent to the state
@@ -117,15 +219,71 @@ extern "C"
 			struct {
 				a3_RigidBody rb_ground[6];
 				a3_RigidBody rb_sphere[5];
+				a3_RigidBody rb_link[6];
 			};
 		};
 		unsigned int rigidbodiesActive;
+
+		// forces on rigid bodies (indices into rigidbody), evaluated 
+		//	every step before integration
+		a3_ForceRegistry forces[1];
+
+		// wind over the box on a grid of windSize nodes per axis 
+		//	(set before starting the thread; 0 for still air), dragging 
+		//	spheres and, at particleDrag per second, particles
+		a3_WindField wind[1];
+		unsigned int windSize;
+		a3real particleDrag;
 		
-		// e.g. set of particles
-		union {
-			a3_Particle particle[physicsMaxCount_particle];
-		};
-		unsigned int particlesActive;
+		// particles: pool of up to particleCapacity (set before 
+		//	starting the thread; 0 for none) and the buffer its 
+		//	positions are published to, laid out like the pool
+		a3_ParticlePool particlePool[1];
+		unsigned int particleCapacity;
+		a3real *particlePosition;
+
+		// emitters feeding the particle pool
+		a3_ParticleEmitter emitter[physicsMaxCount_emitter];
+		unsigned int emittersActive;
+
+		// particles bounce off static hulls (planes and spheres) 
+		//	found through a spatial hash, keeping this much speed
+		a3_ParticleCollisionHash particleHash[1];
+		a3real particleRestitution;
+
+		// SPH fluid of up to fluidCapacity particles in its own pool 
+		//	(set before starting the thread; 0 for none), and the 
+		//	buffer its positions are published to
+		a3_ParticleFluid fluid[1];
+		unsigned int fluidCapacity;
+		a3real *fluidPosition;
+
+		// cloth sheet of clothSize x clothSize particles stepped with 
+		//	clothIntegrator (both set before starting the thread; 
+		//	size 0 for none), and the buffer its positions are 
+		//	published to
+		a3_Cloth cloth[1];
+		unsigned int clothSize;
+		a3_ClothIntegrator clothIntegrator;
+		a3real *clothPosition;
+
+		// position-based (XPBD) props of up to positionBasedCapacity 
+		//	particles: a rope, a soft block and a pile of grains (set 
+		//	before starting the thread; 0 for none), and the buffer 
+		//	its positions are published to
+		a3_PositionBasedSolver positionBased[1];
+		unsigned int positionBasedCapacity;
+		a3real *positionBasedPosition;
+
+		// N-body disc of up to orbitCapacity particles in its own 
+		//	pool with their masses, attracting each other through a 
+		//	Barnes-Hut tree (set before starting the thread; 0 for 
+		//	none), and the buffer its positions are published to
+		a3_ParticlePool orbitPool[1];
+		a3_BarnesHutTree orbitTree[1];
+		a3real *orbitMass;
+		unsigned int orbitCapacity;
+		a3real *orbitPosition;
 
 		// e.g. set of hulls for rigid bodies
 		union {
@@ -133,13 +291,51 @@ extern "C"
 			struct {
 				a3_ConvexHull hull_ground[6];
 				a3_ConvexHull hull_sphere[5];
+				a3_ConvexHull hull_link[6];
 			};
 		};
 
 		double t;
 
+		// contact solver
+		a3_ContactSolver solver[1];
+
 		BSP bsps[physicsMaxCount_bsp];
 		unsigned int numBSPs;
+
+		// last cell each body was binned into (reused while asleep)
+		unsigned int bspIndex_rb[physicsMaxCount_rigidbody];
+
+		// pipelined broadphase: each body's predicted bounds (center 
+		//	and reach), and candidate pairs for the step being taken 
+		//	and the next (bit j of entry i pairs body i with j > i), 
+		//	ready once a step has predicted them
+		a3vec4 reach_rb[physicsMaxCount_rigidbody];
+		unsigned int pair_rb[2][physicsMaxCount_rigidbody];
+		unsigned int pairFront;
+		int pairReady;
+
+		// multi-rate bookkeeping: each body's tier and the time it 
+		//	has not been stepped for, each tier's time since it last 
+		//	stepped, and the step counter that schedules tiers
+		unsigned int tier_rb[physicsMaxCount_rigidbody];
+		a3real owed_rb[physicsMaxCount_rigidbody];
+		a3real tierTime[physicsMaxCount_tier];
+		unsigned int tierStep;
+
+		// step in progress: velocities it started from (for error 
+		//	estimation), arguments of the jobs it handed out (props 
+		//	over the step, particles per substep) and the counter the 
+		//	jobs running alongside it are joined on
+		a3vec3 velocityStart_rb[physicsMaxCount_rigidbody];
+		a3_PhysicsJob stepJob[1], substepJob[1];
+		a3_JobCounter stepPending[1];
+
+		// delta publication bookkeeping: bodies whose written entries 
+		//	changed this step, bodies the last publication changed, 
+		//	and bodies it published coasting between tier steps 
+		//	(bit i for body i; see a3_PhysicsStateBodyMaskCheck)
+		unsigned int dirty_rb, publish_rb, coast_rb;
 		//---------------------------------------------------------------------
 	};
 
@@ -150,9 +346,66 @@ extern "C"
 	void a3physicsUpdate(a3_PhysicsWorld *world, double dt);
 	long a3physicsThread(a3_PhysicsWorld *world);
 
+	// create and destroy a world's content without a thread (config 
+	//	fields are set first, as before starting the thread)
+	void a3physicsWorldInitialize(a3_PhysicsWorld *world);
+	void a3physicsWorldTerminate(a3_PhysicsWorld *world);
+
+	// add a rigid body to a world's scene (from a scene builder): a 
+	//	sphere, or a static plane facing along its rotated z axis
+	//	- returns the body's index, or -1 if the world is full
+	int a3physicsWorldAddSphere(a3_PhysicsWorld *world, const a3real3p position, const a3real3p velocity, const a3real mass, const a3real radius);
+	int a3physicsWorldAddPlane(a3_PhysicsWorld *world, const a3real3p position, const a3real4p rotation, const a3real width, const a3real height);
+
+	// stages of a3physicsUpdate, for callers that step worlds 
+	//	themselves; one step is:
+	//		begin; for each tier k with h = a3physicsStepTier(k) > 0, 
+	//		substeps times: solve, integrate, and for k = 0 particles; 
+	//		end
+	//	- begin detects contacts and applies forces; end publishes
+	//	- a3physicsStepTier returns the substep a tier takes this 
+	//		step, or 0 if it is not stepped
+	void a3physicsStepBegin(a3_PhysicsWorld *world, double dt);
+	a3real a3physicsStepTier(a3_PhysicsWorld *world, const unsigned int k);
+	void a3physicsStepSolve(a3_PhysicsWorld *world, const a3real h);
+	void a3physicsStepIntegrate(a3_PhysicsWorld *world, const a3real h);
+	void a3physicsStepParticles(a3_PhysicsWorld *world, const a3real h);
+	void a3physicsStepEnd(a3_PhysicsWorld *world, double dt);
+
 	// world utilities
 	int a3physicsWorldStateReset(a3_PhysicsWorldState *worldState);
 
+	// blend two published states at time t (clamped to their timestamps)
+	//	- rigid body positions are interpolated linearly, rotations 
+	//		with SLERP; bodies that did not change between them are 
+	//		copied (and keep their versions, so their transforms 
+	//		need not be expanded again)
+	int a3physicsWorldStateInterpolate(a3_PhysicsWorldState *worldState_out, const a3_PhysicsWorldState *worldState0, const a3_PhysicsWorldState *worldState1, const double t);
+
+	// bring a copy of a published state up to date, copying only the 
+	//	entries that changed since it was taken (every entry if it 
+	//	is newer than the state or was never taken)
+	//	- call with the world locked; returns the entries copied
+	int a3physicsWorldStateSync(a3_PhysicsWorldState *worldState_inout, const a3_PhysicsWorldState *worldState);
+
+	// pack the entries of a state changed after version base (0 for 
+	//	a keyframe), and apply a packed delta to a copy of the state 
+	//	at base or later
+	//	- diff returns the entries packed; apply returns the entries 
+	//		applied, or 0 if the copy is older than the delta's base
+	int a3physicsWorldStateDiff(a3_PhysicsWorldStateDelta *delta_out, const a3_PhysicsWorldState *worldState, const unsigned int base);
+	int a3physicsWorldStateApply(a3_PhysicsWorldState *worldState_inout, const a3_PhysicsWorldStateDelta *delta);
+
+	// bytes of a delta in use (header and packed entries)
+	unsigned int a3physicsWorldStateDeltaSize(const a3_PhysicsWorldStateDelta *delta);
+
+	// expand the transforms of the bodies in mask (bit i for body i) 
+	//	from a state's poses, in bulk, skipping those already 
+	//	expanded from the same pose
+	//	- one mask covers every body (a3_PhysicsStateBodyMaskCheck)
+	//	- returns the transforms expanded
+	int a3physicsWorldStateExpand(a3_PhysicsWorldTransforms *transforms_out, const a3_PhysicsWorldState *worldState, const unsigned int mask);
+
 	// mutex handling
 	inline int a3physicsLockWorld(a3_PhysicsWorld *world);
 	inline int a3physicsUnlockWorld(a3_PhysicsWorld *world);
@@ -0,0 +1,565 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_PositionBased.c/.cpp
+	Implementation of XPBD solver.
+*/
+
+#include "a3_PositionBased.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// passes split into jobs
+enum a3_PositionBasedPass
+{
+	a3positionBasedPass_constraint,
+	a3positionBasedPass_contact,
+};
+
+
+// internal helper: particles used by a constraint type
+inline unsigned int a3positionConstraintParticles_internal(const a3_PositionConstraintType type)
+{
+	return (type == a3positionConstraint_distance ? 2 : type == a3positionConstraint_bending ? 3 : 4);
+}
+
+// internal helper: greedy coloring, then counting sort by color
+//	- each particle keeps a mask of the colors its constraints use; a 
+//		constraint takes the lowest color none of its particles has
+void a3positionBasedColor_internal(a3_PositionBasedSolver *solver)
+{
+	a3_PositionConstraint *constraint;
+	unsigned int count[a3positionBasedMaxCount_color + 1] = { 0 };
+	unsigned long long used;
+	unsigned int i, j, n, color, sum;
+
+	memset(solver->colorMask, 0, sizeof(unsigned long long) * solver->pool->count);
+	for (i = 0, constraint = solver->constraint; i < solver->constraintCount; ++i, ++constraint)
+	{
+		n = a3positionConstraintParticles_internal(constraint->type);
+		for (j = 0, used = 0; j < n; ++j)
+			used |= solver->colorMask[constraint->particle[j]];
+		for (color = 0; color < a3positionBasedMaxCount_color && (used >> color) & 1ull; ++color);
+		if (color < a3positionBasedMaxCount_color)
+			for (j = 0; j < n; ++j)
+				solver->colorMask[constraint->particle[j]] |= 1ull << color;
+		constraint->color = color;
+		++count[color];
+	}
+
+	for (color = 0, sum = 0; color <= a3positionBasedMaxCount_color; ++color)
+	{
+		solver->colorStart[color] = sum;
+		sum += count[color];
+		count[color] = solver->colorStart[color];
+	}
+	solver->colorStart[color] = sum;
+	for (i = 0, constraint = solver->constraint; i < solver->constraintCount; ++i, ++constraint)
+		solver->constraintScratch[count[constraint->color]++] = *constraint;
+	memcpy(solver->constraint, solver->constraintScratch, sizeof(a3_PositionConstraint) * solver->constraintCount);
+
+	// the last color is the serial overflow batch
+	for (color = 0; color < a3positionBasedMaxCount_color && solver->colorStart[color] < solver->colorStart[color + 1]; ++color);
+	solver->colorCount = color;
+	solver->colored = 1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// internal XPBD projection of one constraint
+//	- gradient g_i of C for each particle, then
+//		dlambda = (-C - a lambda) / (sum w_i |g_i|^2 + a), a = compliance / h^2
+//		x_i += w_i g_i dlambda
+void a3positionBasedProject_internal(a3_PositionBasedSolver *solver, a3_PositionConstraint *constraint, const a3real complianceScale)
+{
+	const unsigned int pc = solver->pool->capacity;
+	const unsigned int n = a3positionConstraintParticles_internal(constraint->type);
+	const a3real epsilon = (a3real)(1.0e-9);
+	a3real *const x = solver->pool->position;
+	a3real p[4][3], g[4][3], w[4], c, length, denominator, alpha, lambda;
+	a3vec3 e1, e2, e3;
+	unsigned int i, k;
+
+	for (i = 0; i < n; ++i)
+	{
+		k = constraint->particle[i];
+		p[i][0] = x[k];
+		p[i][1] = x[k + pc];
+		p[i][2] = x[k + pc * 2];
+		w[i] = solver->massInv[k];
+	}
+
+	switch (constraint->type)
+	{
+	case a3positionConstraint_distance:
+		// C = |a - b| - rest
+		a3real3Diff(g[0], p[0], p[1]);
+		length = a3real3Length(g[0]);
+		if (length < epsilon)
+			return;
+		a3real3MulS(g[0], a3recip(length));
+		a3real3ProductS(g[1], g[0], -a3realOne);
+		c = length - constraint->rest;
+		break;
+	case a3positionConstraint_bending:
+		// C = |b - centroid| - rest, b - centroid = (2b - a - c) / 3
+		for (i = 0; i < 3; ++i)
+			e1.v[i] = (p[1][i] * a3realTwo - p[0][i] - p[2][i]) * (a3real)(1.0 / 3.0);
+		length = a3real3Length(e1.v);
+		if (length < epsilon)
+			return;
+		a3real3MulS(e1.v, a3recip(length));
+		a3real3ProductS(g[1], e1.v, (a3real)(2.0 / 3.0));
+		a3real3ProductS(g[0], e1.v, (a3real)(-1.0 / 3.0));
+		a3real3ProductS(g[2], e1.v, (a3real)(-1.0 / 3.0));
+		c = length - constraint->rest;
+		break;
+	case a3positionConstraint_volume:
+		// C = 6 V - rest, 6 V = (e1 x e2) . e3
+		a3real3Diff(e1.v, p[1], p[0]);
+		a3real3Diff(e2.v, p[2], p[0]);
+		a3real3Diff(e3.v, p[3], p[0]);
+		a3real3Cross(g[1], e2.v, e3.v);
+		a3real3Cross(g[2], e3.v, e1.v);
+		a3real3Cross(g[3], e1.v, e2.v);
+		for (i = 0; i < 3; ++i)
+			g[0][i] = -g[1][i] - g[2][i] - g[3][i];
+		c = a3real3Dot(g[3], e3.v) - constraint->rest;
+		break;
+	default:
+		return;
+	}
+
+	alpha = constraint->compliance * complianceScale;
+	for (i = 0, denominator = alpha; i < n; ++i)
+		denominator += w[i] * a3real3LengthSquared(g[i]);
+	if (denominator < epsilon)
+		return;
+	lambda = (-c - alpha * constraint->lambda) / denominator;
+	constraint->lambda += lambda;
+
+	for (i = 0; i < n; ++i)
+	{
+		k = constraint->particle[i];
+		x[k] += w[i] * g[i][0] * lambda;
+		x[k + pc] += w[i] * g[i][1] * lambda;
+		x[k + pc * 2] += w[i] * g[i][2] * lambda;
+	}
+}
+
+// internal helper: position-based friction on a contact's tangential 
+//	motion this substep (removed entirely under static friction)
+inline void a3positionBasedFriction_internal(a3real *correction_inout, const a3real *relative, const a3real *normal, const a3real penetration, const a3real share, const a3real frictionStatic, const a3real frictionKinetic)
+{
+	const a3real along = a3real3Dot(relative, normal);
+	a3real tangent[3], length, scale;
+	tangent[0] = relative[0] - normal[0] * along;
+	tangent[1] = relative[1] - normal[1] * along;
+	tangent[2] = relative[2] - normal[2] * along;
+	length = a3real3Length(tangent);
+	scale = share;
+	if (length >= frictionStatic * penetration && length > a3realZero)
+		scale *= a3minimum(frictionKinetic * penetration / length, a3realOne);
+	correction_inout[0] -= tangent[0] * scale;
+	correction_inout[1] -= tangent[1] * scale;
+	correction_inout[2] -= tangent[2] * scale;
+}
+
+// internal contact pass over particles [begin, end)
+//	- each particle sums the corrections that push it out of its 
+//		neighbors (its share by inverse mass) plus friction, into 
+//		its own entries only
+void a3positionBasedContact_internal(a3_PositionBasedSolver *solver, const unsigned int begin, const unsigned int end)
+{
+	const unsigned int pc = solver->pool->capacity;
+	const a3real diameter = solver->radius * a3realTwo, diameterSq = diameter * diameter;
+	const a3real *const x = solver->pool->position, *const xp = solver->positionPrev;
+	const unsigned int *const cellStart = solver->grid->cellStart, *const order = solver->grid->order;
+	unsigned int slot[a3particleNeighborMaxCount_cell], slotCount;
+	unsigned int i, j, k, m, count;
+	int cell[3];
+	a3real position[3], normal[3], relative[3], correction[3], distanceSq, distance, share;
+
+	for (i = begin; i < end; ++i)
+	{
+		correction[0] = correction[1] = correction[2] = a3realZero;
+		count = 0;
+		if (solver->massInv[i] > a3realZero)
+		{
+			position[0] = x[i];
+			position[1] = x[i + pc];
+			position[2] = x[i + pc * 2];
+			a3particleNeighborGridCell(solver->grid, cell, position);
+			slotCount = a3particleNeighborGridSlots(solver->grid, slot, cell);
+			for (k = 0; k < slotCount; ++k)
+			{
+				for (m = cellStart[slot[k]]; m < cellStart[slot[k] + 1]; ++m)
+				{
+					j = order[m];
+					normal[0] = position[0] - x[j];
+					normal[1] = position[1] - x[j + pc];
+					normal[2] = position[2] - x[j + pc * 2];
+					distanceSq = a3real3LengthSquared(normal);
+					if (j == i || distanceSq >= diameterSq || distanceSq <= a3realZero)
+						continue;
+
+					distance = (a3real)a3sqrt(distanceSq);
+					a3real3MulS(normal, a3recip(distance));
+					share = solver->massInv[i] / (solver->massInv[i] + solver->massInv[j]);
+					correction[0] += normal[0] * (diameter - distance) * share;
+					correction[1] += normal[1] * (diameter - distance) * share;
+					correction[2] += normal[2] * (diameter - distance) * share;
+
+					relative[0] = (x[i] - xp[i]) - (x[j] - xp[j]);
+					relative[1] = (x[i + pc] - xp[i + pc]) - (x[j + pc] - xp[j + pc]);
+					relative[2] = (x[i + pc * 2] - xp[i + pc * 2]) - (x[j + pc * 2] - xp[j + pc * 2]);
+					a3positionBasedFriction_internal(correction, relative, normal, diameter - distance, share, solver->frictionStatic, solver->frictionKinetic);
+					++count;
+				}
+			}
+		}
+		solver->correction[i] = correction[0];
+		solver->correction[i + pc] = correction[1];
+		solver->correction[i + pc * 2] = correction[2];
+		solver->contactCount[i] = count;
+	}
+}
+
+// internal job: run a pass over [offset + begin, offset + end)
+void a3positionBasedWork_internal(const a3_PositionBasedTask *task, const unsigned int begin, const unsigned int end)
+{
+	unsigned int i;
+	switch (task->pass)
+	{
+	case a3positionBasedPass_constraint:
+		for (i = task->offset + begin; i < task->offset + end; ++i)
+			a3positionBasedProject_internal(task->solver, task->solver->constraint + i, task->complianceScale);
+		break;
+	case a3positionBasedPass_contact:
+		a3positionBasedContact_internal(task->solver, task->offset + begin, task->offset + end);
+		break;
+	}
+}
+
+// internal utility to split a pass over [begin, end) into jobs and 
+//	wait (small passes run on the calling thread)
+void a3positionBasedRunPass_internal(a3_PositionBasedSolver *solver, const int pass, const unsigned int begin, const unsigned int end, const a3real complianceScale)
+{
+	a3_PositionBasedTask task[1];
+	task->solver = solver;
+	task->offset = begin;
+	task->pass = pass;
+	task->complianceScale = complianceScale;
+	a3jobParallelFor(solver->jobs, (a3_JobFunc)a3positionBasedWork_internal, task, end - begin, a3positionBasedMinCount_share);
+}
+
+// internal utility: apply averaged contact corrections, then push 
+//	particles out of planes (with friction against the static plane)
+void a3positionBasedResolve_internal(a3_PositionBasedSolver *solver)
+{
+	const unsigned int pc = solver->pool->capacity;
+	a3real *const x = solver->pool->position, *const xp = solver->positionPrev;
+	a3real position[3], correction[3], relative[3], separation, countInv;
+	const a3vec4 *plane;
+	unsigned int i, k;
+
+	for (i = 0; i < solver->pool->count; ++i)
+	{
+		if (solver->massInv[i] <= a3realZero)
+			continue;
+		countInv = solver->contactCount[i] ? a3recip((a3real)solver->contactCount[i]) : a3realZero;
+		position[0] = x[i] + solver->correction[i] * countInv;
+		position[1] = x[i + pc] + solver->correction[i + pc] * countInv;
+		position[2] = x[i + pc * 2] + solver->correction[i + pc * 2] * countInv;
+
+		for (k = 0, plane = solver->plane; k < solver->planeCount; ++k, ++plane)
+		{
+			separation = a3real3Dot(position, plane->v) - plane->w - solver->radius;
+			if (separation < a3realZero)
+			{
+				correction[0] = -plane->x * separation;
+				correction[1] = -plane->y * separation;
+				correction[2] = -plane->z * separation;
+				relative[0] = position[0] + correction[0] - xp[i];
+				relative[1] = position[1] + correction[1] - xp[i + pc];
+				relative[2] = position[2] + correction[2] - xp[i + pc * 2];
+				a3positionBasedFriction_internal(correction, relative, plane->v, -separation, a3realOne, solver->frictionStatic, solver->frictionKinetic);
+				a3real3Add(position, correction);
+			}
+		}
+
+		x[i] = position[0];
+		x[i + pc] = position[1];
+		x[i + pc * 2] = position[2];
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3positionBasedCreate(a3_PositionBasedSolver *solver_out, const unsigned int particleCapacity, const unsigned int constraintCapacity, const a3real radius, a3_JobSystem *jobs)
+{
+	if (solver_out && !solver_out->memory && particleCapacity && radius > a3realZero)
+	{
+		// hash table about twice the particle count
+		unsigned int tableSizeLog2 = 10, pc;
+		size_t size;
+		while ((1u << tableSizeLog2) < particleCapacity * 2 && tableSizeLog2 < 24)
+			++tableSizeLog2;
+
+		if (a3particlePoolCreate(solver_out->pool, particleCapacity) > 0)
+		{
+			// 7 blocks of reals, a mask and an index per particle, then 
+			//	constraints twice over
+			pc = solver_out->pool->capacity;
+			size = (sizeof(a3real) * 7 + sizeof(unsigned long long) + sizeof(unsigned int)) * pc + sizeof(a3_PositionConstraint) * 2 * constraintCapacity;
+			solver_out->memory = malloc(size);
+			if (solver_out->memory &&
+				a3particleNeighborGridCreate(solver_out->grid, tableSizeLog2, radius * a3realTwo, pc) > 0)
+			{
+				memset(solver_out->memory, 0, size);
+				solver_out->massInv = (a3real *)solver_out->memory;
+				solver_out->positionPrev = solver_out->massInv + pc;
+				solver_out->correction = solver_out->positionPrev + pc * 3;
+				solver_out->colorMask = (unsigned long long *)(solver_out->correction + pc * 3);
+				solver_out->contactCount = (unsigned int *)(solver_out->colorMask + pc);
+				solver_out->constraint = (a3_PositionConstraint *)(solver_out->contactCount + pc);
+				solver_out->constraintScratch = solver_out->constraint + constraintCapacity;
+				solver_out->constraintCount = 0;
+				solver_out->constraintCapacity = constraintCapacity;
+				solver_out->colorCount = 0;
+				solver_out->colored = 0;
+				solver_out->planeCount = 0;
+
+				a3real3Set(solver_out->gravity.v, a3realZero, a3realZero, (a3real)(-9.80665));
+				solver_out->radius = radius;
+				solver_out->frictionStatic = (a3real)(0.5);
+				solver_out->frictionKinetic = (a3real)(0.3);
+				solver_out->substeps = 10;
+				solver_out->iterations = 1;
+				solver_out->jobs = jobs;
+				return pc;
+			}
+			a3particleNeighborGridRelease(solver_out->grid);
+			a3particlePoolRelease(solver_out->pool);
+			free(solver_out->memory);
+			solver_out->memory = 0;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3positionBasedRelease(a3_PositionBasedSolver *solver)
+{
+	if (solver && solver->memory)
+	{
+		a3particleNeighborGridRelease(solver->grid);
+		a3particlePoolRelease(solver->pool);
+		free(solver->memory);
+		solver->memory = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3positionBasedAddParticle(a3_PositionBasedSolver *solver, const a3real3p position, const a3real mass)
+{
+	const a3real zero[3] = { a3realZero, a3realZero, a3realZero };
+	int i;
+	if (solver && solver->memory && position)
+	{
+		i = a3particlePoolAdd(solver->pool, position, zero, zero, a3realZero);
+		if (i >= 0)
+			solver->massInv[i] = mass > a3realZero ? a3recip(mass) : a3realZero;
+		return i;
+	}
+	return -1;
+}
+
+// internal helper to add a constraint slot
+inline a3_PositionConstraint *a3positionBasedAdd_internal(a3_PositionBasedSolver *solver, const a3_PositionConstraintType type, const unsigned int *particle, const a3real compliance)
+{
+	const unsigned int n = a3positionConstraintParticles_internal(type);
+	a3_PositionConstraint *constraint;
+	unsigned int i, j;
+	if (!solver || !solver->memory || solver->constraintCount >= solver->constraintCapacity)
+		return 0;
+	for (i = 0; i < n; ++i)
+	{
+		if (particle[i] >= solver->pool->count)
+			return 0;
+		for (j = i + 1; j < n; ++j)
+			if (particle[j] == particle[i])
+				return 0;
+	}
+
+	constraint = solver->constraint + solver->constraintCount++;
+	memset(constraint, 0, sizeof(a3_PositionConstraint));
+	constraint->type = type;
+	for (i = 0; i < n; ++i)
+		constraint->particle[i] = particle[i];
+	constraint->compliance = compliance;
+	solver->colored = 0;
+	return constraint;
+}
+
+extern inline int a3positionBasedAddDistance(a3_PositionBasedSolver *solver, const unsigned int a, const unsigned int b, const a3real compliance)
+{
+	const unsigned int particle[2] = { a, b };
+	a3_PositionConstraint *constraint = a3positionBasedAdd_internal(solver, a3positionConstraint_distance, particle, compliance);
+	const unsigned int pc = solver ? solver->pool->capacity : 0;
+	const a3real *x;
+	a3real d[3];
+	if (constraint)
+	{
+		x = solver->pool->position;
+		d[0] = x[a] - x[b];
+		d[1] = x[a + pc] - x[b + pc];
+		d[2] = x[a + pc * 2] - x[b + pc * 2];
+		constraint->rest = a3real3Length(d);
+		return (int)(constraint - solver->constraint);
+	}
+	return -1;
+}
+
+extern inline int a3positionBasedAddBending(a3_PositionBasedSolver *solver, const unsigned int a, const unsigned int b, const unsigned int c, const a3real compliance)
+{
+	const unsigned int particle[3] = { a, b, c };
+	a3_PositionConstraint *constraint = a3positionBasedAdd_internal(solver, a3positionConstraint_bending, particle, compliance);
+	const unsigned int pc = solver ? solver->pool->capacity : 0;
+	const a3real *x;
+	a3real d[3];
+	unsigned int i;
+	if (constraint)
+	{
+		x = solver->pool->position;
+		for (i = 0; i < 3; ++i)
+			d[i] = (x[b + pc * i] * a3realTwo - x[a + pc * i] - x[c + pc * i]) * (a3real)(1.0 / 3.0);
+		constraint->rest = a3real3Length(d);
+		return (int)(constraint - solver->constraint);
+	}
+	return -1;
+}
+
+extern inline int a3positionBasedAddVolume(a3_PositionBasedSolver *solver, const unsigned int a, const unsigned int b, const unsigned int c, const unsigned int d, const a3real compliance)
+{
+	const unsigned int particle[4] = { a, b, c, d };
+	a3_PositionConstraint *constraint = a3positionBasedAdd_internal(solver, a3positionConstraint_volume, particle, compliance);
+	const unsigned int pc = solver ? solver->pool->capacity : 0;
+	const a3real *x;
+	a3vec3 e1, e2, e3, n;
+	unsigned int i;
+	if (constraint)
+	{
+		x = solver->pool->position;
+		for (i = 0; i < 3; ++i)
+		{
+			e1.v[i] = x[b + pc * i] - x[a + pc * i];
+			e2.v[i] = x[c + pc * i] - x[a + pc * i];
+			e3.v[i] = x[d + pc * i] - x[a + pc * i];
+		}
+		a3real3Cross(n.v, e1.v, e2.v);
+		constraint->rest = a3real3Dot(n.v, e3.v);
+		return (int)(constraint - solver->constraint);
+	}
+	return -1;
+}
+
+extern inline int a3positionBasedAddPlane(a3_PositionBasedSolver *solver, const a3real3p point, const a3real3p unitNormal)
+{
+	a3vec4 *plane;
+	if (solver && point && unitNormal && solver->planeCount < a3positionBasedMaxCount_plane)
+	{
+		plane = solver->plane + solver->planeCount;
+		a3real3SetReal3(plane->v, unitNormal);
+		plane->w = a3real3Dot(point, unitNormal);
+		return solver->planeCount++;
+	}
+	return -1;
+}
+
+extern inline int a3positionBasedStep(a3_PositionBasedSolver *solver, const a3real dt)
+{
+	const unsigned int substeps = solver && solver->substeps > 1 ? solver->substeps : 1;
+	const a3real h = dt / (a3real)(substeps), complianceScale = a3recip(h * h), hInv = a3recip(h);
+	a3real *x, *xp, *v, *a;
+	unsigned int s, k, c, i, j, pc;
+	if (solver && solver->memory && dt > a3realZero)
+	{
+		if (!solver->colored)
+			a3positionBasedColor_internal(solver);
+
+		// gravity on free particles
+		pc = solver->pool->capacity;
+		x = solver->pool->position;
+		v = solver->pool->velocity;
+		a = solver->pool->acceleration;
+		for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+			for (i = 0; i < solver->pool->count; ++i, ++j)
+				a[j] = solver->massInv[i] > a3realZero ? solver->gravity.v[c] : a3realZero;
+
+		for (s = 0; s < substeps; ++s)
+		{
+			// predict
+			for (c = 0; c < 3; ++c)
+				memcpy(solver->positionPrev + pc * c, x + pc * c, sizeof(a3real) * solver->pool->count);
+			a3particlePoolIntegrateEulerSemiImplicit(solver->pool, h);
+			for (k = 0; k < solver->constraintCount; ++k)
+				solver->constraint[k].lambda = a3realZero;
+			a3particleNeighborGridBuild(solver->grid, solver->pool);
+
+			// project: colors in parallel, then the serial overflow
+			for (k = 0; k < solver->iterations; ++k)
+			{
+				for (c = 0; c < solver->colorCount; ++c)
+					a3positionBasedRunPass_internal(solver, a3positionBasedPass_constraint, solver->colorStart[c], solver->colorStart[c + 1], complianceScale);
+				for (i = solver->colorStart[a3positionBasedMaxCount_color]; i < solver->constraintCount; ++i)
+					a3positionBasedProject_internal(solver, solver->constraint + i, complianceScale);
+
+				a3positionBasedRunPass_internal(solver, a3positionBasedPass_contact, 0, solver->pool->count, a3realZero);
+				a3positionBasedResolve_internal(solver);
+			}
+
+			// velocity from the change in position
+			xp = solver->positionPrev;
+			for (c = 0, j = 0; c < 3; ++c, j = pc * c)
+				for (i = 0; i < solver->pool->count; ++i, ++j)
+					v[j] = (x[j] - xp[j]) * hInv;
+		}
+		return substeps;
+	}
+	return -1;
+}
+
+extern inline int a3positionBasedCopyPositions(a3real *position_out, const a3_PositionBasedSolver *solver)
+{
+	if (solver && solver->memory)
+		return a3particlePoolCopyPositions(position_out, solver->pool);
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
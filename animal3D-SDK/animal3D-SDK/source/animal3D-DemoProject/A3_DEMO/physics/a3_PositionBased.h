@@ -0,0 +1,198 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_PositionBased.h
+	Extended position-based dynamics (XPBD) over a particle pool: 
+		distance, bending, volume and collision constraints.
+*/
+
+#ifndef __ANIMAL3D_POSITIONBASED_H
+#define __ANIMAL3D_POSITIONBASED_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_ParticleNeighbor.h"
+
+#include "a3_JobSystem.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_PositionConstraint		a3_PositionConstraint;
+	typedef struct a3_PositionBasedTask			a3_PositionBasedTask;
+	typedef struct a3_PositionBasedSolver		a3_PositionBasedSolver;
+	typedef enum a3_PositionConstraintType		a3_PositionConstraintType;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_PositionBasedLimits
+	{
+		// colors constraints are batched into (one bit each in a 
+		//	particle's mask); constraints that fit none go into one 
+		//	more batch that is solved serially
+		a3positionBasedMaxCount_color = 64,
+
+		// static planes particles collide with
+		a3positionBasedMaxCount_plane = 8,
+
+		// fewest items worth handing to another thread
+		a3positionBasedMinCount_share = 1024,
+	};
+
+	// constraint types and the particles each uses
+	enum a3_PositionConstraintType
+	{
+		a3positionConstraint_distance,	// a, b keep their distance
+		a3positionConstraint_bending,	// b keeps its offset from the centroid of a, b, c
+		a3positionConstraint_volume,	// tetrahedron a, b, c, d keeps its volume
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// constraint
+	//	- compliance is inverse stiffness (0 is rigid); lambda is the 
+	//		accumulated multiplier, reset every substep
+	struct a3_PositionConstraint
+	{
+		a3_PositionConstraintType type;
+		unsigned int particle[4];
+		unsigned int color;
+		a3real rest, compliance, lambda;
+	};
+
+	// pass handed to the job system (items from offset)
+	struct a3_PositionBasedTask
+	{
+		a3_PositionBasedSolver *solver;
+		unsigned int offset;
+		int pass;
+		a3real complianceScale;
+	};
+
+	// XPBD solver
+	//	- particles live in the solver's own pool (constraints refer 
+	//		to them by index, so none are removed); zero inverse mass 
+	//		pins a particle
+	//	- each step is split into substeps (Macklin et al. 2019, small 
+	//		steps): predict positions with the pool's integrator, 
+	//		then for each iteration project the constraints color by 
+	//		color, resolve particle contacts and planes, and finally 
+	//		take velocities from the change in position
+	//	- constraints are greedily colored so no two of one color 
+	//		share a particle; a color's constraints are independent 
+	//		and split into jobs (recolored when one is added)
+	//	- particle contacts (every pair closer than two radii) are 
+	//		found with the neighbor grid and resolved Jacobi style: 
+	//		each particle sums its own corrections from its contacts 
+	//		and applies their average, so the pass splits into jobs 
+	//		with no coloring; contacts and planes also apply 
+	//		static and kinetic position-based friction
+	struct a3_PositionBasedSolver
+	{
+		a3_ParticlePool pool[1];
+		a3_ParticleNeighborGrid grid[1];
+
+		// per particle: inverse mass, position at the start of the 
+		//	substep (three blocks), contact correction (three blocks), 
+		//	color mask (coloring scratch) and contact count
+		a3real *massInv;
+		a3real *positionPrev;
+		a3real *correction;
+		unsigned long long *colorMask;
+		unsigned int *contactCount;
+
+		// constraints, sorted by color when colored (scratch holds 
+		//	them while sorting)
+		a3_PositionConstraint *constraint, *constraintScratch;
+		unsigned int constraintCount, constraintCapacity;
+		unsigned int colorStart[a3positionBasedMaxCount_color + 2];
+		unsigned int colorCount;
+		int colored;
+
+		// static planes: unit normal and offset (n.x = w on the plane)
+		a3vec4 plane[a3positionBasedMaxCount_plane];
+		unsigned int planeCount;
+
+		// uniform acceleration, particle radius, friction
+		a3vec3 gravity;
+		a3real radius;
+		a3real frictionStatic, frictionKinetic;
+
+		// substeps per step and constraint iterations per substep
+		unsigned int substeps, iterations;
+
+		// job system passes run on (null to run them here)
+		a3_JobSystem *jobs;
+
+		// allocation holding per-particle and constraint arrays
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create solver for up to the given particles and constraints, 
+	//	with a particle radius (allocates; call once at startup)
+	inline int a3positionBasedCreate(a3_PositionBasedSolver *solver_out, const unsigned int particleCapacity, const unsigned int constraintCapacity, const a3real radius, a3_JobSystem *jobs);
+
+	// release solver memory
+	inline int a3positionBasedRelease(a3_PositionBasedSolver *solver);
+
+	// add particle at rest (mass <= 0 pins it)
+	//	- returns its index or -1 if full
+	inline int a3positionBasedAddParticle(a3_PositionBasedSolver *solver, const a3real3p position, const a3real mass);
+
+	// add constraints resting at the particles' current configuration
+	//	- each returns its index or -1 if full or invalid; indices 
+	//		hold until the next step sorts constraints by color
+	inline int a3positionBasedAddDistance(a3_PositionBasedSolver *solver, const unsigned int a, const unsigned int b, const a3real compliance);
+	inline int a3positionBasedAddBending(a3_PositionBasedSolver *solver, const unsigned int a, const unsigned int b, const unsigned int c, const a3real compliance);
+	inline int a3positionBasedAddVolume(a3_PositionBasedSolver *solver, const unsigned int a, const unsigned int b, const unsigned int c, const unsigned int d, const a3real compliance);
+
+	// add static plane through a point (particles stay on the side 
+	//	the normal points to)
+	inline int a3positionBasedAddPlane(a3_PositionBasedSolver *solver, const a3real3p point, const a3real3p unitNormal);
+
+	// advance the solver by dt
+	inline int a3positionBasedStep(a3_PositionBasedSolver *solver, const a3real dt);
+
+	// copy positions in bulk to a buffer with the pool's layout
+	inline int a3positionBasedCopyPositions(a3real *position_out, const a3_PositionBasedSolver *solver);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_POSITIONBASED_H
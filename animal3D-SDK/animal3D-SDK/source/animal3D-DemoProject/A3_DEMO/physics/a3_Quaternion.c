@@ -210,28 +210,40 @@ extern inline a3real4r a3quaternionUnitSLERP(a3real4p qSlerp_out, const a3real4p
 {
 	if (qSlerp_out && q0_unit && q1_unit)
 	{
-		// ****TO-DO: implement
 		// PRO TIP: if "angle" is negative, flip second quaternion
 		// PRO TIP: raw SLERP formula is not enough; what if inputs are parallel?
-		a3real dot = a3real3Dot(q1_unit, q0_unit);
+		a3real dot = a3real4Dot(q0_unit, q1_unit);
+		a3real s0, s1, angle, sinAngleInv;
 		a3real4 q1;
-		a3real4Set(q1, q0_unit[0], q0_unit[1], q0_unit[2], q0_unit[3]);
-
-		if (dot < 0)
-			a3real4Set(q1, -q1_unit[0], -q1_unit[1], -q1_unit[2], -q1_unit[3]);
-
-		a3real angle = a3acosd(dot);
-		a3real theta = angle * t;
 
-		a3real s0 = a3cosd(theta) - dot * a3sind(theta) / a3sind(angle);
-		a3real s1 = a3sind(theta) / a3sind(angle);
+		// take the short way around
+		if (dot < a3realZero)
+		{
+			a3real4ProductS(q1, q1_unit, -a3realOne);
+			dot = -dot;
+		}
+		else
+			a3real4SetReal4(q1, q1_unit);
 
-		a3real4 result1, result2;
-		a3real4ProductS(result1, q0_unit, s0);
-		a3real4ProductS(result2, q1_unit, s1);
+		// nearly parallel: sin(angle) vanishes, so blend linearly
+		if (dot > (a3real)(0.9995))
+		{
+			s0 = a3realOne - t;
+			s1 = t;
+		}
+		else
+		{
+			angle = a3acosd(dot);
+			sinAngleInv = a3recip(a3sind(angle));
+			s0 = a3sind(angle * (a3realOne - t)) * sinAngleInv;
+			s1 = a3sind(angle * t) * sinAngleInv;
+		}
 
-		a3real3Add(result1, result2);
-		qSlerp_out = result1;
+		// q = q0 sin((1-t)angle)/sin(angle) + q1 sin(t angle)/sin(angle)
+		a3real4ProductS(qSlerp_out, q0_unit, s0);
+		a3real4Add(qSlerp_out, a3real4MulS(q1, s1));
+		if (dot > (a3real)(0.9995))
+			a3real4Normalize(qSlerp_out);
 	}
 	return qSlerp_out;
 }
@@ -23,6 +23,7 @@
 */
 
 #include "a3_RigidBody.h"
+#include "a3_Integration.h"
 #include <stdio.h>
 
 /*
@@ -109,17 +110,14 @@ inline a3real3x3r a3rigidbodyRebaseMatrix_internal(a3real3x3p m_out, const a3rea
 // named Euler methods (described below)
 extern inline void a3rigidbodyIntegrateEulerExplicit(a3_RigidBody *rb, const a3real dt)
 {
-	a3vec3 d;
 	a3vec4 r;
 	//	x(t+dt) = x(t) + f(t)dt
 	//					 f(t) = dx/dt = v(t)
 	//	x(t+dt) = x(t) + v(t)dt
-	a3real3Add(rb->position.v, a3real3ProductS(d.v, rb->velocity.v, dt));
-
 	//	v(t+dt) = v(t) + g(t)dt
 	//					 g(t) = dv/dt = a(t)
 	//	v(t+dt) = v(t) + a(t)dt
-	a3real3Add(rb->velocity.v, a3real3ProductS(d.v, rb->acceleration.v, dt));
+	a3integrateEulerExplicit(rb->position.v, rb->velocity.v, rb->acceleration.v, 3, dt);
 
 	// ****TO-DO: 
 	//	- integrate rotation
@@ -134,13 +132,10 @@ extern inline void a3rigidbodyIntegrateEulerExplicit(a3_RigidBody *rb, const a3r
 
 extern inline void a3rigidbodyIntegrateEulerSemiImplicit(a3_RigidBody *rb, const a3real dt)
 {
-	a3vec3 d;
 	a3vec4 r;
 	//	v(t+dt) = v(t) + a(t)dt
-	a3real3Add(rb->velocity.v, a3real3ProductS(d.v, rb->acceleration.v, dt));
-
 	//	x(t+dt) = x(t) + v(t+dt)dt
-	a3real3Add(rb->position.v, a3real3ProductS(d.v, rb->velocity.v, dt));
+	a3integrateEulerSemiImplicit(rb->position.v, rb->velocity.v, rb->acceleration.v, 3, dt);
 
 	// ****TO-DO: 
 	//	- integrate angular velocity
@@ -154,13 +149,10 @@ extern inline void a3rigidbodyIntegrateEulerSemiImplicit(a3_RigidBody *rb, const
 
 extern inline void a3rigidbodyIntegrateEulerKinematic(a3_RigidBody *rb, const a3real dt)
 {
-	a3vec3 d;
 	a3vec4 r;
 	//	x(t+dt) = x(t) + v(t)dt + a(t)dt2 / 2
-	a3real3Add(rb->position.v, a3real3ProductS(d.v, a3real3Sum(d.v, rb->velocity.v, a3real3ProductS(d.v, rb->acceleration.v, a3realHalf * dt)), dt));
-
 	//	v(t+dt) = v(t) + a(t)dt
-	a3real3Add(rb->velocity.v, a3real3ProductS(d.v, rb->acceleration.v, dt));
+	a3integrateEulerKinematic(rb->position.v, rb->velocity.v, rb->acceleration.v, 3, dt);
 
 	// ****TO-DO: 
 	//	- integrate rotation using kinematic formula
@@ -194,6 +186,17 @@ extern inline void a3rigidbodyIntegrateEulerKinematic(a3_RigidBody *rb, const a3
 	a3real4Normalize(rb->velocity_a.v);
 }
 
+// split impulse: integrate and reset pseudo-velocity
+extern inline void a3rigidbodyIntegratePseudoVelocity(a3_RigidBody *rb, const a3real dt)
+{
+	a3vec3 d;
+
+	//	x(t+dt) += v_pseudo dt
+	//	pseudo-velocity only lives for one step
+	a3real3Add(rb->position.v, a3real3ProductS(d.v, rb->pseudoVelocity.v, dt));
+	a3real3Set(rb->pseudoVelocity.v, a3realZero, a3realZero, a3realZero);
+}
+
 
 //-----------------------------------------------------------------------------
 
@@ -386,9 +389,49 @@ extern inline int a3rigidbodyIsRotating(const a3_RigidBody *rb)
 {
 	if (rb)
 	{
-		// ****TO-DO: 
 		// determine if particle is rotating (angular speed is not zero)
+		//	- angular velocity lives in the vector part of velocity_a
+		const a3real w = a3real3LengthSquared(rb->velocity_a.v);
+		return a3isNotNearZero(w);
+	}
+	return -1;
+}
+
+// check if body is slow enough to count as resting
+extern inline int a3rigidbodyIsResting(const a3_RigidBody *rb, const a3real speed, const a3real angularSpeed)
+{
+	if (rb)
+	{
+		// moving and rotating, but below thresholds
+		return ((!a3rigidbodyIsMoving(rb) || a3real3LengthSquared(rb->velocity.v) < speed * speed) &&
+			(!a3rigidbodyIsRotating(rb) || a3real3LengthSquared(rb->velocity_a.v) < angularSpeed * angularSpeed));
+	}
+	return -1;
+}
 
+// put body to sleep
+extern inline int a3rigidbodySleep(a3_RigidBody *rb)
+{
+	if (rb)
+	{
+		a3real3Set(rb->velocity.v, a3realZero, a3realZero, a3realZero);
+		a3real3Set(rb->acceleration.v, a3realZero, a3realZero, a3realZero);
+		a3real3Set(rb->pseudoVelocity.v, a3realZero, a3realZero, a3realZero);
+		a3real3Set(rb->velocity_a.v, a3realZero, a3realZero, a3realZero);
+		rb->sleeping = 1;
+		return 1;
+	}
+	return -1;
+}
+
+// wake body
+extern inline int a3rigidbodyWake(a3_RigidBody *rb)
+{
+	if (rb)
+	{
+		rb->restTime = a3realZero;
+		rb->sleeping = 0;
+		return 1;
 	}
 	return -1;
 }
@@ -61,6 +61,23 @@ extern "C"
 		a3vec3 force;
 		a3real mass, massInv;
 
+		// position correction velocity from the contact solver
+		//	(moves the body out of penetration, never adds momentum)
+		a3vec3 pseudoVelocity;
+
+		// sleeping: time spent below rest thresholds and sleep flag
+		//	(sleeping bodies are skipped until something wakes them)
+		a3real restTime;
+		int sleeping;
+
+		// opt-in continuous collision for fast bodies: motion is 
+		//	swept against static hulls so thin walls cannot be skipped
+		int continuous;
+
+		// multi-rate stepping: a held body is waiting for its rate 
+		//	tier's step and is skipped by the solver and integration
+		int held;
+
 		a3vec4 rotation;
 		a3vec4 torque;
 		a3vec4 velocity_a; //w(omega) dq/dt = (w)q/2
@@ -93,6 +110,9 @@ extern "C"
 	// kinematic: integrate average of current and next velocities
 	inline void a3rigidbodyIntegrateEulerKinematic(a3_RigidBody *rb, const a3real dt);
 
+	// split impulse: integrate and reset pseudo-velocity
+	inline void a3rigidbodyIntegratePseudoVelocity(a3_RigidBody *rb, const a3real dt);
+
 
 //-----------------------------------------------------------------------------
 
@@ -134,6 +154,15 @@ extern "C"
 	// check if particle is rotating
 	inline int a3rigidbodyIsRotating(const a3_RigidBody *rb);
 
+	// check if body is slow enough to count as resting
+	inline int a3rigidbodyIsResting(const a3_RigidBody *rb, const a3real speed, const a3real angularSpeed);
+
+	// put body to sleep (stops all motion)
+	inline int a3rigidbodySleep(a3_RigidBody *rb);
+
+	// wake body and restart its rest timer
+	inline int a3rigidbodyWake(a3_RigidBody *rb);
+
 	// apply force at center of mass
 	inline int a3rigidbodyApplyForceDirect(a3_RigidBody *rb, const a3real3p f);
 
@@ -0,0 +1,414 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+
+	a3_Solver.c/.cpp
+	Implementation of contact solver.
+*/
+
+#include "a3_Solver.h"
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper to apply equal and opposite impulse along normal
+inline void a3solverApplyImpulse_internal(a3real3p v_a, a3real3p v_b, const a3real massInv_a, const a3real massInv_b, const a3real3p normal, const a3real impulse)
+{
+	a3real3 d;
+	a3real3Add(v_a, a3real3ProductS(d, normal, impulse * massInv_a));
+	a3real3Sub(v_b, a3real3ProductS(d, normal, impulse * massInv_b));
+}
+
+// internal helper to solve one non-penetration row
+//	- returns applied impulse; accumulated total is clamped to push only
+inline a3real a3solverSolveRow_internal(a3real *accumulated, const a3real3p v_a, const a3real3p v_b, const a3real3p normal, const a3real massNormal, const a3real target)
+{
+	a3real3 rVel;
+	a3real impulse, prev;
+
+	// lambda = -m_eff (J v - target)
+	a3real3Diff(rVel, v_a, v_b);
+	impulse = massNormal * (target - a3real3Dot(rVel, normal));
+
+	prev = *accumulated;
+	*accumulated = a3maximum(prev + impulse, a3realZero);
+	return (*accumulated - prev);
+}
+
+// internal helper to solve one bilateral row (no clamping)
+inline a3real a3solverSolveRowBilateral_internal(a3real *accumulated, const a3real3p v_a, const a3real3p v_b, const a3real3p direction, const a3real massRow, const a3real target)
+{
+	a3real3 rVel;
+	a3real impulse;
+
+	a3real3Diff(rVel, v_a, v_b);
+	impulse = massRow * (target - a3real3Dot(rVel, direction));
+	*accumulated += impulse;
+	return impulse;
+}
+
+// internal helper to check if a body takes part in solving
+//	(sleeping and held bodies keep their joint impulses for later)
+inline int a3solverBodyIsActive_internal(const a3_RigidBody *rb)
+{
+	return (rb->massInv > a3realZero && !rb->sleeping && !rb->held);
+}
+
+// internal helper to get world-space anchor separation (a - b)
+inline a3real3r a3solverJointSeparation_internal(a3real3p separation_out, const a3_Joint *joint)
+{
+	a3real3 p_b;
+	a3real3Sum(separation_out, joint->rb_a->position.v, joint->anchor_a.v);
+	a3real3Sum(p_b, joint->rb_b->position.v, joint->anchor_b.v);
+	return a3real3Sub(separation_out, p_b);
+}
+
+// internal helper to build a joint's distance row (row 0, along the 
+//	anchor line)
+inline void a3solverJointDistanceRow_internal(a3_Joint *joint, const a3real3p separation)
+{
+	const a3real len = a3real3Length(separation);
+	if (len > a3realZero)
+		a3real3ProductS(joint->rowDirection[0].v, separation, a3recip(len));
+	else
+		joint->rowDirection[0] = a3zVec3;
+	joint->rowBias[0] = len - joint->length;
+}
+
+// internal helper to add a joint
+inline a3_Joint *a3solverAddJoint_internal(a3_ContactSolver *solver, a3_RigidBody *rb_a, a3_RigidBody *rb_b, const a3real3p anchor_a, const a3real3p anchor_b, const a3_JointType type)
+{
+	a3_Joint *joint;
+	if (solver->jointCount < a3solverMaxCount_joint && rb_a && rb_b && rb_a != rb_b)
+	{
+		joint = solver->joint + solver->jointCount++;
+		joint->rb_a = rb_a;
+		joint->rb_b = rb_b;
+		joint->type = type;
+		if (anchor_a)
+			a3real3SetReal3(joint->anchor_a.v, anchor_a);
+		else
+			joint->anchor_a = a3zeroVec3;
+		if (anchor_b)
+			a3real3SetReal3(joint->anchor_b.v, anchor_b);
+		else
+			joint->anchor_b = a3zeroVec3;
+		joint->axis = a3zVec3;
+		joint->length = a3realZero;
+		joint->rowCount = 0;
+		joint->impulse[0] = joint->impulse[1] = joint->impulse[2] = a3realZero;
+		return joint;
+	}
+	return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// reset solver to defaults and remove all contacts
+extern inline int a3solverReset(a3_ContactSolver *solver)
+{
+	if (solver)
+	{
+		solver->contactCount = 0;
+		solver->jointCount = 0;
+		solver->iterations = 4;
+		solver->slop = (a3real)(0.01);
+		solver->biasFactor = (a3real)(0.2);
+		solver->restitution = (a3real)(0.8);
+		solver->restitutionThreshold = a3realOne;
+		solver->warmStart = a3realOne;
+		return 1;
+	}
+	return -1;
+}
+
+// remove all contacts
+extern inline int a3solverClearContacts(a3_ContactSolver *solver)
+{
+	if (solver)
+	{
+		solver->contactCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// add contact from collision result
+extern inline int a3solverAddContact(a3_ContactSolver *solver, const a3_ConvexHullCollision *collision)
+{
+	if (solver && collision && collision->hull_a && collision->hull_b)
+	{
+		a3_Contact *contact;
+
+		// two static bodies cannot respond
+		if (collision->hull_a->rb->massInv + collision->hull_b->rb->massInv <= a3realZero)
+			return 0;
+
+		if (solver->contactCount < a3solverMaxCount_contact)
+		{
+			contact = solver->contact + solver->contactCount;
+			contact->rb_a = collision->hull_a->rb;
+			contact->rb_b = collision->hull_b->rb;
+			contact->normal = collision->normal_a[0];
+			contact->penetration = contact->penetrationDetected = collision->penetration[0];
+
+			// hull transforms are what the narrowphase tested against
+			contact->position_a = collision->hull_a->transform->v3.xyz;
+			contact->position_b = collision->hull_b->transform->v3.xyz;
+			contact->impulseNormal = contact->impulseBias = a3realZero;
+			return ++solver->contactCount;
+		}
+		return 0;
+	}
+	return -1;
+}
+
+// add ball-socket joint
+extern inline int a3solverAddJointBall(a3_ContactSolver *solver, a3_RigidBody *rb_a, a3_RigidBody *rb_b, const a3real3p anchor_a, const a3real3p anchor_b)
+{
+	if (solver)
+		return (a3solverAddJoint_internal(solver, rb_a, rb_b, anchor_a, anchor_b, a3jointType_ball) ? solver->jointCount : 0);
+	return -1;
+}
+
+// add planar joint
+extern inline int a3solverAddJointPlanar(a3_ContactSolver *solver, a3_RigidBody *rb_a, a3_RigidBody *rb_b, const a3real3p anchor_a, const a3real3p anchor_b, const a3real3p axis_unit)
+{
+	if (solver && axis_unit)
+	{
+		a3_Joint *joint = a3solverAddJoint_internal(solver, rb_a, rb_b, anchor_a, anchor_b, a3jointType_planar);
+		if (joint)
+		{
+			a3vec3 d;
+			a3real3SetReal3(joint->axis.v, axis_unit);
+			joint->length = a3real3Length(a3solverJointSeparation_internal(d.v, joint));
+			return solver->jointCount;
+		}
+		return 0;
+	}
+	return -1;
+}
+
+// add distance joint
+extern inline int a3solverAddJointDistance(a3_ContactSolver *solver, a3_RigidBody *rb_a, a3_RigidBody *rb_b, const a3real3p anchor_a, const a3real3p anchor_b)
+{
+	if (solver)
+	{
+		a3_Joint *joint = a3solverAddJoint_internal(solver, rb_a, rb_b, anchor_a, anchor_b, a3jointType_distance);
+		if (joint)
+		{
+			a3vec3 d;
+			joint->length = a3real3Length(a3solverJointSeparation_internal(d.v, joint));
+			return solver->jointCount;
+		}
+		return 0;
+	}
+	return -1;
+}
+
+// remove joint by index
+extern inline int a3solverRemoveJoint(a3_ContactSolver *solver, const unsigned int index)
+{
+	if (solver)
+	{
+		if (index < solver->jointCount)
+		{
+			solver->joint[index] = solver->joint[--solver->jointCount];
+			return 1;
+		}
+		return 0;
+	}
+	return -1;
+}
+
+// re-estimate penetration from body motion since detection
+extern inline int a3solverUpdateSeparation(a3_ContactSolver *solver)
+{
+	if (solver)
+	{
+		a3_Contact *contact;
+		a3vec3 d_a, d_b;
+		unsigned int i;
+
+		for (i = 0, contact = solver->contact; i < solver->contactCount; ++i, ++contact)
+		{
+			// depth shrinks as a moves along the normal relative to b
+			a3real3Diff(d_a.v, contact->rb_a->position.v, contact->position_a.v);
+			a3real3Diff(d_b.v, contact->rb_b->position.v, contact->position_b.v);
+			a3real3Sub(d_a.v, d_b.v);
+			contact->penetration = contact->penetrationDetected - a3real3Dot(d_a.v, contact->normal.v);
+		}
+		return solver->contactCount;
+	}
+	return -1;
+}
+
+// prepare contacts for solving
+extern inline int a3solverPrestep(a3_ContactSolver *solver, const a3real dt)
+{
+	if (solver && dt > a3realZero)
+	{
+		const a3real dtInv = a3recip(dt);
+		a3_Contact *contact;
+		a3_Joint *joint;
+		a3vec3 rVel, separation;
+		a3real vn;
+		unsigned int i, j;
+
+		for (i = 0, contact = solver->contact; i < solver->contactCount; ++i, ++contact)
+		{
+			// effective mass along the normal
+			if (!a3solverBodyIsActive_internal(contact->rb_a) && !a3solverBodyIsActive_internal(contact->rb_b))
+			{
+				contact->massNormal = a3realZero;
+				continue;
+			}
+			contact->massNormal = a3recipsafe(contact->rb_a->massInv + contact->rb_b->massInv);
+
+			// bounce only when approaching fast enough to touch this 
+			//	step; slow contacts rest, and speculative contacts 
+			//	(still apart) may close at most their gap
+			a3real3Diff(rVel.v, contact->rb_a->velocity.v, contact->rb_b->velocity.v);
+			vn = a3real3Dot(rVel.v, contact->normal.v);
+			if (vn < -solver->restitutionThreshold && vn * dt <= contact->penetration)
+				contact->velocityBias = -solver->restitution * vn;
+			else if (contact->penetration < a3realZero)
+				contact->velocityBias = contact->penetration * dtInv;
+			else
+				contact->velocityBias = a3realZero;
+
+			// pseudo-velocity that removes penetration beyond the slop
+			contact->positionBias = solver->biasFactor * dtInv * a3maximum(contact->penetration - solver->slop, a3realZero);
+
+			contact->impulseNormal = contact->impulseBias = a3realZero;
+		}
+
+		for (i = 0, joint = solver->joint; i < solver->jointCount; ++i, ++joint)
+		{
+			// effective mass is the same for every linear row
+			joint->massRow = a3recipsafe(joint->rb_a->massInv + joint->rb_b->massInv);
+			if (joint->massRow <= a3realZero ||
+				(!a3solverBodyIsActive_internal(joint->rb_a) && !a3solverBodyIsActive_internal(joint->rb_b)))
+			{
+				joint->rowCount = 0;
+				continue;
+			}
+
+			a3solverJointSeparation_internal(separation.v, joint);
+			switch (joint->type)
+			{
+			case a3jointType_ball:
+				// one row per world axis, driving separation to zero
+				joint->rowCount = 3;
+				a3real3Set(joint->rowDirection[0].v, a3realOne, a3realZero, a3realZero);
+				a3real3Set(joint->rowDirection[1].v, a3realZero, a3realOne, a3realZero);
+				a3real3Set(joint->rowDirection[2].v, a3realZero, a3realZero, a3realOne);
+				joint->rowBias[0] = separation.x;
+				joint->rowBias[1] = separation.y;
+				joint->rowBias[2] = separation.z;
+				break;
+			case a3jointType_planar:
+				// distance, and separation along the axis must vanish
+				joint->rowCount = 2;
+				a3solverJointDistanceRow_internal(joint, separation.v);
+				joint->rowDirection[1] = joint->axis;
+				joint->rowBias[1] = a3real3Dot(separation.v, joint->axis.v);
+				break;
+			case a3jointType_distance:
+				// one row along the anchor line
+				joint->rowCount = 1;
+				a3solverJointDistanceRow_internal(joint, separation.v);
+				break;
+			default:
+				joint->rowCount = 0;
+				break;
+			}
+
+			for (j = 0; j < joint->rowCount; ++j)
+			{
+				// pseudo-velocity that removes drift
+				joint->rowBias[j] *= -solver->biasFactor * dtInv;
+				joint->impulseBias[j] = a3realZero;
+
+				// warm start with last step's impulse
+				joint->impulse[j] *= solver->warmStart;
+				a3solverApplyImpulse_internal(joint->rb_a->velocity.v, joint->rb_b->velocity.v,
+					joint->rb_a->massInv, joint->rb_b->massInv, joint->rowDirection[j].v, joint->impulse[j]);
+			}
+		}
+		return (solver->contactCount + solver->jointCount);
+	}
+	return -1;
+}
+
+// run velocity and pseudo-velocity iterations
+extern inline int a3solverSolve(a3_ContactSolver *solver)
+{
+	if (solver)
+	{
+		a3_Contact *contact;
+		a3_Joint *joint;
+		a3real impulse;
+		unsigned int i, j, iteration;
+
+		for (iteration = 0; iteration < solver->iterations; ++iteration)
+		{
+			for (i = 0, contact = solver->contact; i < solver->contactCount; ++i, ++contact)
+			{
+				if (contact->massNormal <= a3realZero)
+					continue;
+
+				// real velocity: stop approach (plus restitution)
+				impulse = a3solverSolveRow_internal(&contact->impulseNormal,
+					contact->rb_a->velocity.v, contact->rb_b->velocity.v, contact->normal.v, contact->massNormal, contact->velocityBias);
+				a3solverApplyImpulse_internal(contact->rb_a->velocity.v, contact->rb_b->velocity.v,
+					contact->rb_a->massInv, contact->rb_b->massInv, contact->normal.v, impulse);
+
+				// pseudo-velocity: separate penetrating bodies
+				impulse = a3solverSolveRow_internal(&contact->impulseBias,
+					contact->rb_a->pseudoVelocity.v, contact->rb_b->pseudoVelocity.v, contact->normal.v, contact->massNormal, contact->positionBias);
+				a3solverApplyImpulse_internal(contact->rb_a->pseudoVelocity.v, contact->rb_b->pseudoVelocity.v,
+					contact->rb_a->massInv, contact->rb_b->massInv, contact->normal.v, impulse);
+			}
+
+			// joint rows are bilateral: they pull as well as push
+			for (i = 0, joint = solver->joint; i < solver->jointCount; ++i, ++joint)
+			{
+				for (j = 0; j < joint->rowCount; ++j)
+				{
+					impulse = a3solverSolveRowBilateral_internal(joint->impulse + j,
+						joint->rb_a->velocity.v, joint->rb_b->velocity.v, joint->rowDirection[j].v, joint->massRow, a3realZero);
+					a3solverApplyImpulse_internal(joint->rb_a->velocity.v, joint->rb_b->velocity.v,
+						joint->rb_a->massInv, joint->rb_b->massInv, joint->rowDirection[j].v, impulse);
+
+					impulse = a3solverSolveRowBilateral_internal(joint->impulseBias + j,
+						joint->rb_a->pseudoVelocity.v, joint->rb_b->pseudoVelocity.v, joint->rowDirection[j].v, joint->massRow, joint->rowBias[j]);
+					a3solverApplyImpulse_internal(joint->rb_a->pseudoVelocity.v, joint->rb_b->pseudoVelocity.v,
+						joint->rb_a->massInv, joint->rb_b->massInv, joint->rowDirection[j].v, impulse);
+				}
+			}
+		}
+		return (solver->contactCount + solver->jointCount);
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+
+	a3_Solver.h
+	Iterative impulse solver for contact response.
+*/
+
+#ifndef __ANIMAL3D_SOLVER_H
+#define __ANIMAL3D_SOLVER_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "a3_Collision.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_Contact				a3_Contact;
+	typedef struct a3_Joint					a3_Joint;
+	typedef struct a3_ContactSolver			a3_ContactSolver;
+	typedef enum a3_JointType				a3_JointType;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_SolverLimits
+	{
+		a3solverMaxCount_contact = 256,
+		a3solverMaxCount_joint = 256,
+		a3solverMaxCount_jointRow = 3,
+	};
+
+	// joint types
+	//	- bodies in this module respond to impulses linearly only, so 
+	//		joints constrain anchor points offset from body positions; 
+	//		offsets and planar axis are in world space; nothing 
+	//		constrains relative rotation
+	//	- so there is no hinge: its two angular rows (locking twist 
+	//		off the axis) need angular impulses this solver does 
+	//		not apply; planar is the nearest linear stand-in
+	//	- chains and ragdolls are capped by the world's bodies 
+	//		(physicsMaxCount_rigidbody, 32), well before the joint 
+	//		count; hundreds of links are out of scope for now
+	enum a3_JointType
+	{
+		a3jointType_none,
+		a3jointType_ball,		// anchors coincide (3 rows)
+		a3jointType_planar,		// anchors keep distance, b's staying in a's plane normal to axis (2 rows)
+		a3jointType_distance,	// anchors keep distance (1 row)
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// contact constraint between two bodies
+	//	- normal points from b to a (pushes a away from b)
+	struct a3_Contact
+	{
+		a3_RigidBody *rb_a, *rb_b;
+		a3vec3 normal;
+		a3real penetration;
+
+		// body positions the narrowphase saw and the depth it measured;
+		//	current penetration is estimated from motion since then
+		a3vec3 position_a, position_b;
+		a3real penetrationDetected;
+
+		// prestep results: target normal velocity (bounce, or the most 
+		//	approach a speculative contact allows) and pseudo-velocity
+		a3real massNormal;
+		a3real velocityBias;
+		a3real positionBias;
+
+		// accumulated impulses: real velocity and pseudo-velocity
+		a3real impulseNormal;
+		a3real impulseBias;
+	};
+
+	// joint constraint between two bodies
+	//	- persistent: accumulated impulses carry over between steps 
+	//		and warm-start the next solve
+	struct a3_Joint
+	{
+		a3_RigidBody *rb_a, *rb_b;
+		a3_JointType type;
+
+		// anchor offsets from each body and planar axis (world space)
+		a3vec3 anchor_a, anchor_b;
+		a3vec3 axis;
+		a3real length;
+
+		// prestep results: one row per constrained direction
+		a3vec3 rowDirection[a3solverMaxCount_jointRow];
+		a3real rowBias[a3solverMaxCount_jointRow];
+		a3real massRow;
+		unsigned int rowCount;
+
+		// accumulated impulses per row: real velocity and pseudo-velocity
+		a3real impulse[a3solverMaxCount_jointRow];
+		a3real impulseBias[a3solverMaxCount_jointRow];
+	};
+
+	// contact and joint solver
+	//	- sequential impulses with accumulated clamping
+	//	- split impulse: penetration is resolved with a separate
+	//		pseudo-velocity so position correction never adds energy
+	struct a3_ContactSolver
+	{
+		a3_Contact contact[a3solverMaxCount_contact];
+		unsigned int contactCount;
+
+		// joints persist until removed
+		a3_Joint joint[a3solverMaxCount_joint];
+		unsigned int jointCount;
+
+		// velocity iterations per step
+		unsigned int iterations;
+
+		// penetration allowed before correcting (slop) and
+		//	fraction of the remainder removed per step (bias factor)
+		a3real slop, biasFactor;
+
+		// bounciness and the approach speed below which contacts rest
+		a3real restitution, restitutionThreshold;
+
+		// fraction of last step's joint impulse applied before solving
+		//	(long chains converge far faster near 1)
+		a3real warmStart;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// reset solver to defaults and remove all contacts
+	inline int a3solverReset(a3_ContactSolver *solver);
+
+	// remove all contacts
+	inline int a3solverClearContacts(a3_ContactSolver *solver);
+
+	// add contact from collision result
+	inline int a3solverAddContact(a3_ContactSolver *solver, const a3_ConvexHullCollision *collision);
+
+	// add ball-socket joint: anchors are offsets from each body
+	inline int a3solverAddJointBall(a3_ContactSolver *solver, a3_RigidBody *rb_a, a3_RigidBody *rb_b, const a3real3p anchor_a, const a3real3p anchor_b);
+
+	// add planar joint: a point-on-plane and a distance constraint, 
+	//	so b's anchor swings about a's in the plane normal to axis; 
+	//	not a hinge, as the bodies may still turn freely
+	inline int a3solverAddJointPlanar(a3_ContactSolver *solver, a3_RigidBody *rb_a, a3_RigidBody *rb_b, const a3real3p anchor_a, const a3real3p anchor_b, const a3real3p axis_unit);
+
+	// add distance joint: length is taken from current anchor positions
+	inline int a3solverAddJointDistance(a3_ContactSolver *solver, a3_RigidBody *rb_a, a3_RigidBody *rb_b, const a3real3p anchor_a, const a3real3p anchor_b);
+
+	// remove joint by index (last joint takes its place)
+	inline int a3solverRemoveJoint(a3_ContactSolver *solver, const unsigned int index);
+
+	// re-estimate penetration from body motion since detection
+	//	(lets substeps reuse one contact set)
+	inline int a3solverUpdateSeparation(a3_ContactSolver *solver);
+
+	// prepare contacts for solving (call once per step or substep)
+	inline int a3solverPrestep(a3_ContactSolver *solver, const a3real dt);
+
+	// run velocity and pseudo-velocity iterations over contacts and joints
+	inline int a3solverSolve(a3_ContactSolver *solver);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_SOLVER_H
@@ -0,0 +1,236 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_WindField.c/.cpp
+	Implementation of wind field.
+*/
+
+#include "a3_WindField.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+
+// internal helper: grid coordinates of a point, clamped so the cell 
+//	and the one after it on each axis are on the grid
+inline void a3windFieldCell_internal(const a3_WindField *field, unsigned int *cell_out, a3real *param_out, const a3real x, const a3real y, const a3real z)
+{
+	const a3real p[3] = { x, y, z };
+	a3real g;
+	unsigned int c;
+	for (c = 0; c < 3; ++c)
+	{
+		g = (p[c] - field->origin.v[c]) * field->spacingInv;
+		g = a3maximum(g, a3realZero);
+		g = a3minimum(g, (a3real)(field->size[c] - 1));
+		cell_out[c] = a3minimum((unsigned int)g, field->size[c] - 2);
+		param_out[c] = g - (a3real)cell_out[c];
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+
+extern inline int a3windFieldCreate(a3_WindField *field_out, const unsigned int sizeX, const unsigned int sizeY, const unsigned int sizeZ, const a3real3p origin, const a3real spacing)
+{
+	if (field_out && !field_out->memory && origin && sizeX > 1 && sizeY > 1 && sizeZ > 1 && spacing > a3realZero)
+	{
+		const unsigned int nodeCount = sizeX * sizeY * sizeZ, rowCount = sizeX + sizeY + sizeZ;
+		const size_t size = sizeof(a3real) * (nodeCount * 3 + rowCount * a3windFieldMaxCount_octave * 2);
+		field_out->memory = malloc(size);
+		if (field_out->memory)
+		{
+			memset(field_out->memory, 0, size);
+			field_out->size[0] = sizeX;
+			field_out->size[1] = sizeY;
+			field_out->size[2] = sizeZ;
+			field_out->nodeCount = nodeCount;
+			field_out->velocity[0] = (a3real *)field_out->memory;
+			field_out->velocity[1] = field_out->velocity[0] + nodeCount;
+			field_out->velocity[2] = field_out->velocity[1] + nodeCount;
+			field_out->wave[0] = field_out->velocity[2] + nodeCount;
+			field_out->wave[1] = field_out->wave[0] + sizeX * a3windFieldMaxCount_octave * 2;
+			field_out->wave[2] = field_out->wave[1] + sizeY * a3windFieldMaxCount_octave * 2;
+			a3real3SetReal3(field_out->origin.v, origin);
+			field_out->spacing = spacing;
+			field_out->spacingInv = a3recip(spacing);
+
+			// calm until set
+			a3real3Set(field_out->mean.v, a3realZero, a3realZero, a3realZero);
+			field_out->turbulence = a3realZero;
+			field_out->wavelength = spacing * (a3real)(8);
+			field_out->rate = a3realOne;
+			field_out->time = a3realZero;
+			return nodeCount;
+		}
+	}
+	return -1;
+}
+
+extern inline int a3windFieldRelease(a3_WindField *field)
+{
+	if (field && field->memory)
+	{
+		free(field->memory);
+		field->memory = 0;
+		return 1;
+	}
+	return -1;
+}
+
+extern inline int a3windFieldUpdate(a3_WindField *field, const a3real dt)
+{
+	// octaves: wavenumber and amplitude scales, phase rate scales and 
+	//	offsets (irrational ratios so the pattern does not repeat)
+	const a3real octaveScale[a3windFieldMaxCount_octave] = { a3realOne, (a3real)(2.7) };
+	const a3real octaveAmplitude[a3windFieldMaxCount_octave] = { a3realOne, (a3real)(0.4) };
+	const a3real octaveRate[a3windFieldMaxCount_octave] = { a3realOne, (a3real)(1.9) };
+	const a3real octaveOffset[a3windFieldMaxCount_octave] = { a3realZero, (a3real)(1.7) };
+	a3real wavenumber, phase, amplitude, *s, *c, *u, *v, *w;
+	unsigned int axis, o, i, j, k, n;
+
+	if (field && field->memory)
+	{
+		field->time += dt;
+
+		// rows: sine and cosine per axis position and octave
+		for (axis = 0; axis < 3; ++axis)
+			for (o = 0; o < a3windFieldMaxCount_octave; ++o)
+			{
+				wavenumber = a3realTwo * a3realPi * octaveScale[o] / field->wavelength;
+				phase = field->rate * octaveRate[o] * field->time + octaveOffset[o];
+				s = field->wave[axis] + field->size[axis] * o * 2;
+				c = s + field->size[axis];
+				for (i = 0; i < field->size[axis]; ++i)
+				{
+					s[i] = a3sinr(wavenumber * (field->origin.v[axis] + field->spacing * (a3real)i) + phase);
+					c[i] = a3cosr(wavenumber * (field->origin.v[axis] + field->spacing * (a3real)i) + phase);
+				}
+			}
+
+		// nodes: u = sin z + cos y, v = sin x + cos z, w = sin y + cos x
+		u = field->velocity[0];
+		v = field->velocity[1];
+		w = field->velocity[2];
+		for (n = 0; n < field->nodeCount; ++n)
+		{
+			u[n] = field->mean.x;
+			v[n] = field->mean.y;
+			w[n] = field->mean.z;
+		}
+		for (o = 0; o < a3windFieldMaxCount_octave; ++o)
+		{
+			const a3real *const sx = field->wave[0] + field->size[0] * o * 2, *const cx = sx + field->size[0];
+			const a3real *const sy = field->wave[1] + field->size[1] * o * 2, *const cy = sy + field->size[1];
+			const a3real *const sz = field->wave[2] + field->size[2] * o * 2, *const cz = sz + field->size[2];
+			amplitude = field->turbulence * octaveAmplitude[o];
+			for (k = 0, n = 0; k < field->size[2]; ++k)
+				for (j = 0; j < field->size[1]; ++j)
+					for (i = 0; i < field->size[0]; ++i, ++n)
+					{
+						u[n] += amplitude * (sz[k] + cy[j]);
+						v[n] += amplitude * (sx[i] + cz[k]);
+						w[n] += amplitude * (sy[j] + cx[i]);
+					}
+		}
+		return field->nodeCount;
+	}
+	return -1;
+}
+
+extern inline a3real3r a3windFieldSample(const a3_WindField *field, a3real3p velocity_out, const a3real3p position)
+{
+	unsigned int cell[3], n, dy, dz, c;
+	a3real param[3];
+	const a3real *b;
+	if (field && field->memory && velocity_out && position)
+	{
+		a3windFieldCell_internal(field, cell, param, position[0], position[1], position[2]);
+		dy = field->size[0];
+		dz = field->size[0] * field->size[1];
+		n = cell[0] + cell[1] * dy + cell[2] * dz;
+		for (c = 0; c < 3; ++c)
+		{
+			b = field->velocity[c] + n;
+			velocity_out[c] = a3trilerp(b[0], b[1], b[dy], b[dy + 1], b[dz], b[dz + 1], b[dz + dy], b[dz + dy + 1], param[0], param[1], param[2]);
+		}
+	}
+	return velocity_out;
+}
+
+extern inline int a3windFieldSampleBatch(const a3_WindField *field, a3real *velocity_out, const unsigned int strideOut, const a3real *position, const unsigned int strideIn, const unsigned int count)
+{
+	unsigned int cell[3], p, n, dy, dz, c;
+	a3real param[3], weight[8];
+	const a3real *b;
+	if (field && field->memory && velocity_out && position)
+	{
+		dy = field->size[0];
+		dz = field->size[0] * field->size[1];
+		for (p = 0; p < count; ++p)
+		{
+			// the trilinear weights are shared by all three axes
+			a3windFieldCell_internal(field, cell, param, position[p], position[p + strideIn], position[p + strideIn * 2]);
+			weight[0] = (a3realOne - param[0]) * (a3realOne - param[1]) * (a3realOne - param[2]);
+			weight[1] = param[0] * (a3realOne - param[1]) * (a3realOne - param[2]);
+			weight[2] = (a3realOne - param[0]) * param[1] * (a3realOne - param[2]);
+			weight[3] = param[0] * param[1] * (a3realOne - param[2]);
+			weight[4] = (a3realOne - param[0]) * (a3realOne - param[1]) * param[2];
+			weight[5] = param[0] * (a3realOne - param[1]) * param[2];
+			weight[6] = (a3realOne - param[0]) * param[1] * param[2];
+			weight[7] = param[0] * param[1] * param[2];
+			n = cell[0] + cell[1] * dy + cell[2] * dz;
+			for (c = 0; c < 3; ++c)
+			{
+				b = field->velocity[c] + n;
+				velocity_out[p + strideOut * c] =
+					weight[0] * b[0] + weight[1] * b[1] + weight[2] * b[dy] + weight[3] * b[dy + 1] +
+					weight[4] * b[dz] + weight[5] * b[dz + 1] + weight[6] * b[dz + dy] + weight[7] * b[dz + dy + 1];
+			}
+		}
+		return count;
+	}
+	return -1;
+}
+
+extern inline int a3windFieldApplyDrag(const a3_WindField *field, a3real *velocity_inout, const a3real *position, const unsigned int stride, const unsigned int count, const a3real rate)
+{
+	a3real flow[3][a3windFieldMaxCount_batch];
+	unsigned int begin, n, c, i;
+	if (field && field->memory && velocity_inout && position)
+	{
+		for (begin = 0; begin < count; begin += n)
+		{
+			n = a3minimum(count - begin, (unsigned int)a3windFieldMaxCount_batch);
+			a3windFieldSampleBatch(field, *flow, a3windFieldMaxCount_batch, position + begin, stride, n);
+			for (c = 0; c < 3; ++c)
+				for (i = 0; i < n; ++i)
+					velocity_inout[begin + i + stride * c] += (flow[c][i] - velocity_inout[begin + i + stride * c]) * rate;
+		}
+		return count;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
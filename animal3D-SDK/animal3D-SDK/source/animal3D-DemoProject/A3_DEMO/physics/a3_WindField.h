@@ -0,0 +1,126 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+	
+	a3_WindField.h
+	Gridded wind velocity field sampled by drag.
+*/
+
+#ifndef __ANIMAL3D_WINDFIELD_H
+#define __ANIMAL3D_WINDFIELD_H
+
+
+//-----------------------------------------------------------------------------
+
+#include "animal3D/a3math/A3DM.h"
+
+
+//-----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+extern "C"
+{
+#else	// !__cplusplus
+	typedef struct a3_WindField					a3_WindField;
+#endif	// __cplusplus
+
+
+//-----------------------------------------------------------------------------
+
+	// constants
+	enum a3_WindFieldLimits
+	{
+		// points sampled at a time when applying drag
+		a3windFieldMaxCount_batch = 256,
+
+		// turbulence octaves
+		a3windFieldMaxCount_octave = 2,
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// wind field
+	//	- velocities live on a grid of nodes and are sampled 
+	//		trilinearly (clamped to the grid), so drag varies in space 
+	//		at the cost of a lookup instead of evaluating noise per 
+	//		body or particle
+	//	- each update rewrites the nodes: a mean wind plus octaves of 
+	//		ABC flow (Arnold-Beltrami-Childress), which is divergence 
+	//		free and whose terms each depend on one axis, so an update 
+	//		only takes sines and cosines per node row and sums them 
+	//		per node; phases drift with time so the gusts move
+	struct a3_WindField
+	{
+		// nodes per axis, first node's position and node spacing
+		unsigned int size[3], nodeCount;
+		a3vec3 origin;
+		a3real spacing, spacingInv;
+
+		// node velocities, one block per axis, x varying fastest
+		a3real *velocity[3];
+
+		// per axis and octave: sine and cosine of each row's phase
+		a3real *wave[3];
+
+		// flow: mean wind, turbulence amplitude, its wavelength and 
+		//	the rate its phases drift (radians per second), and time
+		a3vec3 mean;
+		a3real turbulence, wavelength, rate;
+		a3real time;
+
+		// allocation holding node velocities and waves
+		void *memory;
+	};
+
+
+//-----------------------------------------------------------------------------
+
+	// create field of nodes (at least 2 per axis) from an origin 
+	//	with a spacing (allocates; call once at startup)
+	inline int a3windFieldCreate(a3_WindField *field_out, const unsigned int sizeX, const unsigned int sizeY, const unsigned int sizeZ, const a3real3p origin, const a3real spacing);
+
+	// release field memory
+	inline int a3windFieldRelease(a3_WindField *field);
+
+	// advance time and rewrite node velocities
+	inline int a3windFieldUpdate(a3_WindField *field, const a3real dt);
+
+	// sample velocity at one point
+	inline a3real3r a3windFieldSample(const a3_WindField *field, a3real3p velocity_out, const a3real3p position);
+
+	// sample velocities at count points in one pass; positions and 
+	//	velocities are three blocks each at their strides
+	inline int a3windFieldSampleBatch(const a3_WindField *field, a3real *velocity_out, const unsigned int strideOut, const a3real *position, const unsigned int strideIn, const unsigned int count);
+
+	// pull velocities toward the wind: v += (u - v) * rate for count 
+	//	points (three blocks each at stride), sampled in batches
+	inline int a3windFieldApplyDrag(const a3_WindField *field, a3real *velocity_inout, const a3real *position, const unsigned int stride, const unsigned int count, const a3real rate);
+
+
+//-----------------------------------------------------------------------------
+
+
+#ifdef __cplusplus
+}
+#endif	// __cplusplus
+
+
+#endif	// !__ANIMAL3D_WINDFIELD_H
@@ -0,0 +1,410 @@
+/*
+	Copyright 2011-2018 Daniel S. Buckstein
+
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+		http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+*/
+
+/*
+	animal3D SDK: Minimal 3D Animation Framework
+	By Daniel S. Buckstein
+
+	a3_PhysicsCheck.c
+	Standalone checks of the physics utilities that are easy to get
+		subtly wrong, each against an independent computation.
+		(built by the animal3D-PhysicsCheck console project in the
+		solution with the .c files in A3_DEMO/physics, linked against
+		the animal3D math and utility libraries; its post-build step
+		runs it, so a failed check fails the build; elsewhere, build
+		the same files and on POSIX link the realtime library for
+		shared memory; it prints each failure and returns nonzero if
+		there were any)
+*/
+
+#include "../a3_BarnesHut.h"
+#include "../a3_PhysicsWorld.h"
+#include "../a3_PhysicsSnapshot.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------
+// utilities
+
+// failures so far
+unsigned int a3checkFailures;
+
+// internal utility: record a check, reporting it if it failed
+int a3check_internal(const int passed, const char *name, const unsigned int index)
+{
+	if (!passed)
+	{
+		if (a3checkFailures++ < 32)
+			printf(" FAILED: %s (%u)\n", name, index);
+	}
+	return passed;
+}
+
+// internal utility: random real in [lo, hi) (independent of the
+//	library's generator so the checks do not share its state)
+a3real a3checkRandom_internal(const a3real lo, const a3real hi)
+{
+	return lo + (hi - lo) * (a3real)rand() / (a3real)RAND_MAX;
+}
+
+// internal utility: compare reals with a relative tolerance
+int a3checkClose_internal(const a3real a, const a3real b, const a3real tolerance)
+{
+	const a3real d = a - b, m = a3maximum(a3maximum(a, -a), a3maximum(b, -b));
+	return d <= tolerance * (m + a3realOne) && -d <= tolerance * (m + a3realOne);
+}
+
+
+//-----------------------------------------------------------------------------
+// Barnes-Hut: Morton keys, radix sort and exact solve
+
+// internal utility: Morton key one bit at a time
+unsigned int a3checkMorton_internal(const unsigned int q[3])
+{
+	unsigned int key = 0, b, c;
+	for (b = 0; b < a3barnesHutMaxCount_level; ++b)
+		for (c = 0; c < 3; ++c)
+			key |= (q[c] >> b & 1u) << (3 * b + c);
+	return key;
+}
+
+void a3checkBarnesHut()
+{
+	enum { count = 4000, stride = 4096, exactCount = 300 };
+	a3_BarnesHutTree tree[1];
+	a3real *position = (a3real *)malloc(sizeof(a3real) * stride * 3);
+	a3real *acceleration = (a3real *)malloc(sizeof(a3real) * stride * 3);
+	a3real mass[count], quantize, d[3], distanceSq, scale, expect[3];
+	unsigned char *seen = (unsigned char *)calloc(count, 1);
+	unsigned int i, j, c, q[3];
+
+	printf("Barnes-Hut\n");
+	srand(1);
+	a3barnesHutCreate(tree, count, 0);
+
+	// clustered points, with duplicates, so keys repeat and share
+	//	most of their bytes
+	for (i = 0; i < count; ++i)
+	{
+		for (c = 0; c < 3; ++c)
+			position[i + stride * c] = (i % 7 == 6) ? position[i - 1 + stride * c]
+				: (i & 1) ? a3checkRandom_internal(-100.0f, 100.0f) : a3checkRandom_internal(3.0f, 3.5f);
+		mass[i] = a3checkRandom_internal(0.5f, 2.0f);
+	}
+	a3barnesHutBuild(tree, position, mass, count, stride);
+
+	// sorted, a permutation, and each key the one its point quantizes to
+	quantize = (a3real)(1023.99) / tree->boundsSize;
+	for (i = 0; i < count; ++i)
+	{
+		if (i > 0)
+			a3check_internal(tree->key[i - 1] <= tree->key[i], "keys sorted", i);
+		if (!a3check_internal(tree->order[i] < count && !seen[tree->order[i]], "order is a permutation", i))
+			continue;
+		seen[tree->order[i]] = 1;
+		for (c = 0; c < 3; ++c)
+		{
+			q[c] = (unsigned int)((position[tree->order[i] + stride * c] - tree->boundsMin[c]) * quantize);
+			a3check_internal(q[c] < 1024, "point inside bounds", i);
+			a3check_internal(tree->sorted[c][i] == position[tree->order[i] + stride * c], "position gathered", i);
+		}
+		a3check_internal(tree->key[i] == a3checkMorton_internal(q), "key matches point", i);
+		a3check_internal(tree->sorted[3][i] == mass[tree->order[i]], "mass gathered", i);
+	}
+
+	// with no opening angle every leaf is summed exactly, so the
+	//	result is the direct sum up to rounding
+	tree->theta = a3realZero;
+	a3barnesHutBuild(tree, position, mass, exactCount, stride);
+	a3barnesHutSolve(tree, acceleration);
+	for (i = 0; i < exactCount; ++i)
+	{
+		expect[0] = expect[1] = expect[2] = a3realZero;
+		for (j = 0; j < exactCount; ++j)
+		{
+			for (c = 0; c < 3; ++c)
+				d[c] = position[j + stride * c] - position[i + stride * c];
+			distanceSq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + tree->softening * tree->softening;
+			scale = tree->gravitationalConstant * mass[j] / (distanceSq * a3sqrtf(distanceSq));
+			for (c = 0; c < 3; ++c)
+				expect[c] += d[c] * scale;
+		}
+		for (c = 0; c < 3; ++c)
+			a3check_internal(a3checkClose_internal(acceleration[i + stride * c], expect[c], 1.0e-3f), "exact solve matches direct sum", i);
+	}
+
+	a3barnesHutRelease(tree);
+	free(seen);
+	free(acceleration);
+	free(position);
+}
+
+
+//-----------------------------------------------------------------------------
+// published states: diff, apply and sync
+
+// internal utility: random unit quaternion
+void a3checkRandomRotation_internal(a3vec4 *rotation_out)
+{
+	a3real lengthSq;
+	do
+	{
+		rotation_out->x = a3checkRandom_internal(-1.0f, 1.0f);
+		rotation_out->y = a3checkRandom_internal(-1.0f, 1.0f);
+		rotation_out->z = a3checkRandom_internal(-1.0f, 1.0f);
+		rotation_out->w = a3checkRandom_internal(-1.0f, 1.0f);
+		lengthSq = a3real4LengthSquared(rotation_out->v);
+	} while (lengthSq < 0.01f || lengthSq > 1.0f);
+	a3real4Normalize(rotation_out->v);
+}
+
+// internal utility: random pose
+void a3checkRandomPose_internal(a3_PhysicsPose *pose_out)
+{
+	a3checkRandomRotation_internal(&pose_out->rotation);
+	pose_out->position.x = a3checkRandom_internal(-50.0f, 50.0f);
+	pose_out->position.y = a3checkRandom_internal(-50.0f, 50.0f);
+	pose_out->position.z = a3checkRandom_internal(-50.0f, 50.0f);
+}
+
+// internal utility: whether two states publish the same thing
+int a3checkStateEqual_internal(const a3_PhysicsWorldState *a, const a3_PhysicsWorldState *b)
+{
+	return a->count_p == b->count_p && a->count_rb == b->count_rb && a->count_f == b->count_f
+		&& a->count_c == b->count_c && a->count_pb == b->count_pb && a->count_o == b->count_o
+		&& a->t == b->t && a->version == b->version
+		&& !memcmp(a->pose_rb, b->pose_rb, sizeof(a3_PhysicsPose) * a->count_rb)
+		&& !memcmp(a->version_rb, b->version_rb, sizeof(unsigned int) * a->count_rb);
+}
+
+void a3checkStateDelta()
+{
+	enum { stateCount = 40, bodyCount = 20, skip = 5 };
+	static a3_PhysicsWorldState state[stateCount + 1], playback[1], copy[1];
+	static a3_PhysicsWorldStateDelta delta[1];
+	unsigned int k, i, changed;
+
+	printf("state deltas\n");
+	srand(2);
+
+	// a run of states, each moving a few bodies (the first moves 
+	//	every one, as the first publication does)
+	for (k = 1; k <= stateCount; ++k)
+	{
+		state[k] = state[k - 1];
+		state[k].count_rb = bodyCount;
+		state[k].count_p = k * 100;
+		state[k].count_o = k % 3;
+		state[k].t = k / 60.0;
+		state[k].version = k;
+		state[k].keyframe = k == 1;
+		for (i = 0; i < bodyCount; ++i)
+			if (k == 1 || rand() % 4 == 0)
+			{
+				a3checkRandomPose_internal(state[k].pose_rb + i);
+				state[k].version_rb[i] = k;
+			}
+	}
+
+	// playback: a keyframe, then each delta in turn
+	a3check_internal(a3physicsWorldStateDiff(delta, state + 1, 0) == bodyCount, "keyframe packs every entry", 1);
+	a3check_internal(a3physicsWorldStateApply(playback, delta) == bodyCount, "keyframe applies every entry", 1);
+	a3check_internal(a3checkStateEqual_internal(playback, state + 1) && playback->keyframe, "keyframe reproduces state", 1);
+	for (k = 2; k <= stateCount; ++k)
+	{
+		for (i = changed = 0; i < bodyCount; ++i)
+			changed += state[k].version_rb[i] == k;
+		a3check_internal(a3physicsWorldStateDiff(delta, state + k, k - 1) == (int)changed, "delta packs changed entries", k);
+		a3check_internal(a3physicsWorldStateDeltaSize(delta) == offsetof(a3_PhysicsWorldStateDelta, entry) + sizeof(a3_PhysicsWorldStateEntry) * changed, "delta size", k);
+		a3check_internal(a3physicsWorldStateApply(playback, delta) == (int)changed, "delta applies changed entries", k);
+		a3check_internal(a3checkStateEqual_internal(playback, state + k) && !playback->keyframe, "delta reproduces state", k);
+	}
+
+	// a delta over several states brings any copy at its base or 
+	//	later up to date, and refuses one older than it
+	for (k = 1 + skip; k <= stateCount; ++k)
+	{
+		a3physicsWorldStateDiff(delta, state + k, k - skip);
+		*copy = state[k - skip];
+		a3physicsWorldStateApply(copy, delta);
+		a3check_internal(a3checkStateEqual_internal(copy, state + k), "delta over several states", k);
+		*copy = state[k - skip + 1];
+		a3physicsWorldStateApply(copy, delta);
+		a3check_internal(a3checkStateEqual_internal(copy, state + k), "delta to a newer copy", k);
+		*copy = state[k - skip - 1];
+		a3check_internal(a3physicsWorldStateApply(copy, delta) == 0 && a3checkStateEqual_internal(copy, state + k - skip - 1), "delta refuses an older copy", k);
+
+		// sync does the same from the state itself
+		*copy = state[k - skip - 1];
+		a3physicsWorldStateSync(copy, state + k);
+		a3check_internal(a3checkStateEqual_internal(copy, state + k), "sync", k);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// published states: expanding transforms
+
+// internal utility: column-major 4x4 times point
+void a3checkTransformPoint_internal(a3real p_out[3], const a3mat4 *m, const a3real p[3])
+{
+	unsigned int r;
+	for (r = 0; r < 3; ++r)
+		p_out[r] = m->m[0][r] * p[0] + m->m[1][r] * p[1] + m->m[2][r] * p[2] + m->m[3][r];
+}
+
+void a3checkStateExpand()
+{
+	enum { bodyCount = 24, oddMask = 0xaaaaaaaau };
+	static a3_PhysicsWorldState state[1];
+	static a3_PhysicsWorldTransforms transforms[1];
+	a3mat4 expect, expectInv;
+	a3real v[3], vMat[3], vBack[3];
+	unsigned int i, r, moved;
+
+	printf("state expand\n");
+	srand(3);
+
+	// bodies from version 1, except the last, left at 0 as a body 
+	//	that is never versioned
+	state->count_rb = bodyCount;
+	state->version = 1;
+	for (i = 0; i < bodyCount; ++i)
+	{
+		a3checkRandomPose_internal(state->pose_rb + i);
+		state->version_rb[i] = i + 1 < bodyCount;
+	}
+
+	// only the bodies in the mask (odd ones stay zero)
+	a3check_internal(a3physicsWorldStateExpand(transforms, state, ~oddMask) == bodyCount / 2, "expand masked count", 0);
+	for (i = 1; i < bodyCount; i += 2)
+		a3check_internal(transforms->version_rb[i] == 0 && transforms->transform_rb[i].m00 == a3realZero, "expand skips bodies outside mask", i);
+	a3check_internal(a3physicsWorldStateExpand(transforms, state, oddMask) == bodyCount / 2, "expand the rest", 0);
+
+	// each transform is the pose's matrix and its inverse, which 
+	//	take a point there and back (the origin lands on the pose's 
+	//	position)
+	for (i = 0; i < bodyCount; ++i)
+	{
+		a3quaternionConvertToMat4(expect.m, state->pose_rb[i].rotation.v, state->pose_rb[i].position.v);
+		a3real4x4TransformInverseIgnoreScale(expectInv.m, expect.m);
+		a3check_internal(!memcmp(transforms->transform_rb + i, &expect, sizeof(expect)), "transform matches quaternion conversion", i);
+		a3check_internal(!memcmp(transforms->transformInv_rb + i, &expectInv, sizeof(expectInv)), "inverse matches", i);
+
+		v[0] = v[1] = v[2] = a3realZero;
+		a3checkTransformPoint_internal(vMat, transforms->transform_rb + i, v);
+		for (r = 0; r < 3; ++r)
+			a3check_internal(vMat[r] == state->pose_rb[i].position.v[r], "transform moves origin to position", i);
+		v[0] = a3checkRandom_internal(-5.0f, 5.0f);
+		v[1] = a3checkRandom_internal(-5.0f, 5.0f);
+		v[2] = a3checkRandom_internal(-5.0f, 5.0f);
+		a3checkTransformPoint_internal(vMat, transforms->transform_rb + i, v);
+		a3checkTransformPoint_internal(vBack, transforms->transformInv_rb + i, vMat);
+		for (r = 0; r < 3; ++r)
+			a3check_internal(a3checkClose_internal(vBack[r], v[r], 1.0e-4f), "inverse undoes transform", i);
+	}
+
+	// expanding again redoes only the unversioned body, then the 
+	//	bodies that moved
+	a3check_internal(a3physicsWorldStateExpand(transforms, state, ~0u) == 1, "expand skips unchanged poses", 0);
+	state->version = 2;
+	for (i = moved = 0; i < bodyCount - 1; i += 3, ++moved)
+	{
+		a3checkRandomPose_internal(state->pose_rb + i);
+		state->version_rb[i] = 2;
+	}
+	a3check_internal(a3physicsWorldStateExpand(transforms, state, ~0u) == (int)moved + 1, "expand redoes moved poses", 0);
+	for (i = 0; i < bodyCount - 1; i += 3)
+	{
+		a3quaternionConvertToMat4(expect.m, state->pose_rb[i].rotation.v, state->pose_rb[i].position.v);
+		a3check_internal(!memcmp(transforms->transform_rb + i, &expect, sizeof(expect)) && transforms->version_rb[i] == 2, "moved transform matches", i);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// snapshot ring: write and read
+
+void a3checkSnapshot()
+{
+	enum { slotCount = 4, stateCount = 10, bodyCount = 12 };
+	const char *name = "/a3PhysicsCheck";
+	static a3_PhysicsWorldState state[1], read[1];
+	a3_PhysicsSnapshotRing writer[1] = { 0 }, reader[1] = { 0 };
+	a3_PhysicsSnapshotView view[1], held[1];
+	unsigned int k, i;
+
+	printf("snapshot ring\n");
+	srand(4);
+
+	// too few slots to read one while the next is written
+	a3check_internal(a3physicsSnapshotCreate(writer, name, 1) == -1, "create refuses one slot", 0);
+	a3check_internal(a3physicsSnapshotOpen(reader, name) == 0, "open before create", 0);
+	if (!a3check_internal(a3physicsSnapshotCreate(writer, name, slotCount) == slotCount, "create", 0)
+		|| !a3check_internal(a3physicsSnapshotOpen(reader, name) == 1, "open", 0))
+	{
+		a3physicsSnapshotRelease(reader);
+		a3physicsSnapshotRelease(writer);
+		return;
+	}
+	a3check_internal(a3physicsSnapshotRead(reader, read) == 0 && a3physicsSnapshotAcquire(reader, view) == 0, "nothing to read before write", 0);
+
+	// more states than slots: each read is the newest, whole
+	state->count_rb = bodyCount;
+	for (k = 1; k <= stateCount; ++k)
+	{
+		state->version = k;
+		state->t = k / 60.0;
+		for (i = 0; i < bodyCount; ++i)
+		{
+			a3checkRandomPose_internal(state->pose_rb + i);
+			state->version_rb[i] = k;
+		}
+		a3check_internal(a3physicsSnapshotWrite(writer, state) == 1, "write", k);
+		a3check_internal(a3physicsSnapshotRead(reader, read) == (int)k && a3checkStateEqual_internal(read, state), "read newest", k);
+		a3check_internal(a3physicsSnapshotAcquire(reader, view) == 1 && a3checkStateEqual_internal(view->state, state)
+			&& a3physicsSnapshotValidate(reader, view) == 1, "view newest", k);
+		if (k == 1)
+			*held = *view;
+	}
+
+	// a view held past a lap of the ring was overwritten
+	a3check_internal(a3physicsSnapshotValidate(reader, held) == 0, "overwritten view fails validation", 0);
+
+	// the name goes with the writer
+	a3physicsSnapshotRelease(reader);
+	a3physicsSnapshotRelease(writer);
+	a3check_internal(a3physicsSnapshotOpen(reader, name) == 0, "open after release", 0);
+	a3physicsSnapshotRelease(reader);
+}
+
+
+//-----------------------------------------------------------------------------
+
+int main()
+{
+	a3checkBarnesHut();
+	a3checkStateDelta();
+	a3checkStateExpand();
+	a3checkSnapshot();
+
+	printf(a3checkFailures ? "%u checks failed\n" : "all checks passed\n", a3checkFailures);
+	return a3checkFailures ? 1 : 0;
+}